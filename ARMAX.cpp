@@ -0,0 +1,122 @@
+/// \file ARMAX.h
+/// \brief Zawiera implementację klasy ARMAX.
+
+#include "ARMAX.h"
+#include "ARX.h"
+
+#include <numeric>
+#include <algorithm>
+
+/**
+ * \brief Konstruktor klasy ARMAX.
+ * \param a Mianownik modelu.
+ * \param b Licznik modelu.
+ * \param c Licznik filtru szumu.
+ * \param dly Opóźnienie.
+ * \param ns Amplituda szumu.
+ */
+ARMAX::ARMAX(std::initializer_list<double> a, std::initializer_list<double> b, std::initializer_list<double> c, unsigned dly, double ns)
+	: A(a), B(b), C(c), k(dly), ns_var(ns)
+{
+	reset();
+}
+
+/**
+ * \brief Konstruktor klasy ARMAX z gotowych wektorów współczynników.
+ * \param a Mianownik modelu.
+ * \param b Licznik modelu.
+ * \param c Licznik filtru szumu.
+ * \param dly Opóźnienie.
+ * \param ns Amplituda szumu.
+ */
+ARMAX::ARMAX(DS a, DS b, DS c, unsigned dly, double ns)
+	: A(std::move(a)), B(std::move(b)), C(std::move(c)), k(dly), ns_var(ns)
+{
+	reset();
+}
+
+/**
+ * \brief Dopasowuje rozmiary buforów do współczynników i zeruje stan.
+ */
+void ARMAX::reset()
+{
+	inBuf.resize(B.size() + k);
+	outBuf.resize(A.size());
+	eBuf.resize(C.size() + 1);
+	noiseBlk.assign(NOISE_BLOCK, 0);
+	noisePos = NOISE_BLOCK;
+}
+
+/**
+ * \brief Generuje i filtruje kolejny blok szumu.
+ *
+ * Szum równania nie zależy od wejścia, więc cały blok jest wyznaczany z wyprzedzeniem:
+ * v(t) = ns_var * (e(t) + sum C_j e(t-1-j)).
+ */
+void ARMAX::refillNoise()
+{
+	noisePos = 0;
+	if (ns_var == 0)
+	{
+		std::fill(noiseBlk.begin(), noiseBlk.end(), 0.0);
+		return;
+	}
+
+	for (double& v : noiseBlk)
+	{
+		eBuf.push(ARX::getNoise());
+		const double* e = eBuf.data();
+		v = ns_var * std::inner_product(std::begin(C), std::end(C), e + 1, e[0]);
+	}
+}
+
+/**
+ * \brief Wykonuje jeden krok symulacji.
+ * \param in Wartość wejściowa.
+ * \return Wartość wyjściowa.
+ */
+double ARMAX::sim(double in)
+{
+	if (noisePos == NOISE_BLOCK)
+		refillNoise();
+
+	inBuf.push(in);
+
+	double NUMxIN = std::inner_product(std::begin(B), std::end(B), inBuf.data() + k, 0.0); ///< iloczyn skalarny B i opóźnionych wejść
+	double DENxOUT = std::inner_product(std::begin(A), std::end(A), outBuf.data(), 0.0); ///< iloczyn skalarny A i poprzednich wyjść
+
+	double out = NUMxIN - DENxOUT + noiseBlk[noisePos++];
+
+	outBuf.push(out);
+	return out;
+}
+
+/**
+ * \brief Serializacja obiektu klasy ARMAX do formatu JSON.
+ * \param j Obiekt JSON, do którego będą zapisywane dane.
+ * \param o Obiekt ARMAX, który będzie serializowany.
+ */
+void to_json(json& j, const ARMAX& o)
+{
+	j["A"] = o.A;
+	j["B"] = o.B;
+	j["C"] = o.C;
+	j["k"] = o.k;
+	j["ns_var"] = o.ns_var;
+}
+
+/**
+ * \brief Deserializacja obiektu klasy ARMAX z formatu JSON.
+ * \param j Obiekt JSON, z którego będą odczytywane dane.
+ * \param o Obiekt ARMAX, do którego będą wczytywane dane.
+ */
+void from_json(const json& j, ARMAX& o)
+{
+	j.at("A").get_to(o.A);
+	j.at("B").get_to(o.B);
+	j.at("C").get_to(o.C);
+	j.at("k").get_to(o.k);
+	j.at("ns_var").get_to(o.ns_var);
+
+	o.reset();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "SISO.h"
+#include "DelayLine.h"
+
+#include <valarray>
+#include <vector>
+#include <initializer_list>
+
+#include "json.hpp" ///< Biblioteka obsługująca format JSON
+using json = nlohmann::json;
+
+/// \class ARMAX
+/// \brief Klasa ARMAX reprezentuje model ARMAX (ARX z kolorowanym szumem równania).
+///
+/// Klasa ARMAX dziedziczy po klasie SISO. Model ma postać
+/// y(t) = sum B_j u(t-k-j) - sum A_j y(t-1-j) + ns_var * (e(t) + sum C_j e(t-1-j)),
+/// gdzie e to biały szum gaussowski. Współczynniki A i C nie zawierają wiodącej jedynki (jak w klasie ARX).
+/// Historia sygnałów jest przechowywana w liniach opóźniających (bez alokacji w trakcie symulacji),
+/// a szum jest generowany i filtrowany blokami po NOISE_BLOCK próbek.
+class ARMAX : public SISO
+{
+	friend class Simulation; ///< Deklaracja przyjaźni z klasą Simulation
+
+	/// Definicja aliasu typu danych DS, odnosi się do typu std::valarray<double>.
+	using DS = std::valarray<double>;
+
+	DS A; ///< Wektor przechowujący mianownik modelu.
+	DS B; ///< Wektor przechowujący licznik modelu.
+	DS C; ///< Wektor przechowujący licznik filtru szumu.
+	unsigned k = 0; ///< Opóźnienie modelu. Domyślnie 0.
+	double ns_var = 1; ///< Amplituda szumu. Domyślnie 1.
+
+	DelayLine inBuf; ///< Historia wejść (k + B.size() próbek).
+	DelayLine outBuf; ///< Historia wyjść (A.size() próbek).
+	DelayLine eBuf; ///< Historia białego szumu (C.size() + 1 próbek).
+
+	/// Liczba próbek szumu generowanych i filtrowanych jednym blokiem.
+	static constexpr size_t NOISE_BLOCK = 256;
+
+	std::vector<double> noiseBlk; ///< Blok przefiltrowanego szumu.
+	size_t noisePos = NOISE_BLOCK; ///< Pozycja następnej próbki w bloku szumu.
+
+	/// \brief Dopasowuje rozmiary buforów do współczynników i zeruje stan.
+	void reset();
+
+	/// \brief Generuje i filtruje kolejny blok szumu.
+	void refillNoise();
+
+public:
+	/// \brief Konstruktor klasy ARMAX.
+	/// \param A Mianownik modelu. Domyślnie pusty.
+	/// \param B Licznik modelu. Domyślnie pusty.
+	/// \param C Licznik filtru szumu. Domyślnie pusty (szum biały).
+	/// \param k Opóźnienie. Domyślnie 0.
+	/// \param ns_var Amplituda szumu. Domyślnie 1.
+	ARMAX(std::initializer_list<double> A = {}, std::initializer_list<double> B = {}, std::initializer_list<double> C = {}, unsigned k = 0, double ns_var = 1);
+
+	/// \brief Konstruktor klasy ARMAX z gotowych wektorów współczynników (używany np. przez identyfikację).
+	/// \param A Mianownik modelu.
+	/// \param B Licznik modelu.
+	/// \param C Licznik filtru szumu.
+	/// \param k Opóźnienie.
+	/// \param ns_var Amplituda szumu.
+	ARMAX(DS A, DS B, DS C, unsigned k, double ns_var);
+
+	/// \brief Funkcja symulująca jeden krok modelu ARMAX.
+	/// \param in Wartość wejściowa.
+	/// \return Wartość wyjściowa modelu.
+	double sim(double in) override;
+
+	/// \brief Serializacja obiektu klasy ARMAX do formatu JSON.
+	/// \param j Obiekt JSON, do którego będą zapisywane dane.
+	/// \param o Obiekt ARMAX, który będzie serializowany.
+	friend void to_json(json& j, const ARMAX& o);
+
+	/// \brief Deserializacja obiektu klasy ARMAX z formatu JSON.
+	/// \param j Obiekt JSON, z którego będą odczytywane dane.
+	/// \param o Obiekt ARMAX, do którego będą wczytywane dane.
+	friend void from_json(const json& j, ARMAX& o);
+};
@@ -4,11 +4,17 @@
 #include "ARX.h"
 
 #include "settings.h"
+#include "Kernels.h"
+#include "LinAlg.h"
+#include "Parallel.h"
 //#include "helpers.h"
 
 //#include <exception>
 #include <stdexcept>
 #include <random>
+#include <algorithm>
+#include <numeric>
+#include <map>
 
 /**
  * \brief Konstruktor klasy ARX.
@@ -34,27 +40,49 @@ ARX::~ARX()
  */
 double ARX::sim(double in)
 {
-	/// przesuwa elementy inBuf o jedno miejsce i dopisuje najnowsze wyjście
-	inBuf = inBuf.shift(-1);
-	if (inBuf.size())
-		inBuf[0] = in; ///< Dopisanie najnowszego wejścia na pierwszą pozycję wektora inBuf.
+	return step(in, getNoise());
+}
 
-	/**
-	* Tworzenie podwektora inBuf
-	* Wektor inBuf przechowuje wartości wejściowe wraz z opóźnieniem "k"
-	* Przypisanie wartości elementów wektora inBuf o indeksach k, k+1, ..., k+B.size()-1 do zmiennej temp
-	*/
-	DS temp = inBuf[std::slice(k, B.size(), 1)]; 
+/**
+ * \brief Wykonuje jeden krok modelu z zadaną próbką szumu.
+ * \param in Wartość typu double reprezentująca wejście.
+ * \param e Próbka szumu.
+ * \return Wartość typu double reprezentująca wyjście.
+ */
+double ARX::step(double in, double e)
+{
+	inBuf.push(in); ///< Dopisanie najnowszego wejścia na pierwszą pozycję linii inBuf (koszt stały, niezależny od k).
+
+	double NUMxIN = 0, DENxOUT = 0;
+	switch (mode)
+	{
+	case Representation::Sparse:
+		/// Reprezentacja rzadka - tylko niezerowe współczynniki
+		for (const Tap& t : tapsB)
+			NUMxIN += t.c * inBuf[t.lag];
+		for (const Tap& t : tapsA)
+			DENxOUT += t.c * outBuf[t.lag];
+		break;
 
-	double NUMxIN = (B * temp).sum() ; ///< oblicza iloczyn skalarny wektorów B i temp
-	double DENxOUT = (A * outBuf).sum(); ///< oblicza iloczyn skalarny wektorów A i outBuf
+	case Representation::Conv:
+		/// Splot blokowy licznika z wejściem opóźnionym o k próbek
+		NUMxIN = conv.process(inBuf[k]);
+		DENxOUT = dot(Ap.data(), outBuf.data(), Ap.size());
+		break;
 
-	double out = NUMxIN - DENxOUT + ns_var * getNoise(); ///< oblicza wartość wyjścia algorytmu ARX
+	default:
+		/**
+		* Iloczyn skalarny wektora B z fragmentem inBuf o indeksach k, k+1, ..., k+Bp.size()-1
+		* Linia inBuf przechowuje wartości wejściowe wraz z opóźnieniem "k"; współczynniki dopełnienia są zerowe
+		*/
+		NUMxIN = dot(Bp.data(), inBuf.data() + k, Bp.size());
+		DENxOUT = dot(Ap.data(), outBuf.data(), Ap.size()); ///< oblicza iloczyn skalarny wektorów A i outBuf
+		break;
+	}
 
-	/// przesuwa elementy outBuf o jedno miejsce i dopisuje najnowsze wyjście
-	outBuf = outBuf.shift(-1); 
-	if (outBuf.size())
-		outBuf[0] = out; ///< Dopisanie najnowszego wyjścia na pierwszą pozycję wektora outBuf.
+	double out = NUMxIN - DENxOUT + ns_var * e; ///< oblicza wartość wyjścia algorytmu ARX
+
+	outBuf.push(out); ///< Dopisanie najnowszego wyjścia na pierwszą pozycję linii outBuf.
 
 	return out; ///< zwraca wartość wyjścia
 }
@@ -62,25 +90,262 @@ double ARX::sim(double in)
 /**
  * \brief Funkcja ustawiająca wartości licznika (B) modelu ARX.
  *
- * Ustawia wartości wektora B i przesuwa wartości wektora inBuf o odpowiednią ilość elementów.
+ * Ustawia wartości wektora B i dopasowuje długość linii inBuf.
  * \param n Lista inicjalizacyjna z wartościami typu double reprezentującymi licznik (B).
  */
 void ARX::setNum(std::initializer_list<double> n)
 {
 	B = n; ///< Przypisanie wartości z listy n do tablicy B.
-	inBuf.resize(B.size() + k); ///< zmienia rozmiar wektora inBuf
+	configure();
 }
 
 /**
  * \brief Funkcja ustawiająca wartości mianownika (A) modelu ARX.
  *
- * Ustawia wartości wektora A i zmienia rozmiar wektora outBuf.
+ * Ustawia wartości wektora A i dopasowuje długość linii outBuf.
  * \param d Lista inicjalizacyjna z wartościami typu double reprezentującymi mianownik (A).
  */
 void ARX::setDen(std::initializer_list<double> d)
 {
 	A = d; ///< Przypisanie wartości z listy d do wektora A.
-	outBuf.resize(A.size()); ///< Zmiana rozmiaru wektora outBuf na rozmiar wektora A
+	configure();
+}
+
+/**
+ * \brief Dopasowuje bufory do współczynników i wybiera reprezentację modelu.
+ *
+ * Reprezentacja rzadka jest wybierana, gdy niezerowych współczynników A i B jest nie więcej niż
+ * SPARSE_DENSITY ich łącznej liczby. Opóźnienie k jest wtedy wliczane w opóźnienia współczynników licznika.
+ * W przeciwnym razie licznik o co najmniej CONV_TAPS współczynnikach jest liczony splotem blokowym.
+ * Stan modelu (historia wejść i wyjść) jest zerowany.
+ */
+void ARX::configure()
+{
+	tapsA.clear();
+	tapsB.clear();
+	for (size_t j = 0; j < A.size(); ++j)
+		if (A[j] != 0)
+			tapsA.push_back({ unsigned(j), A[j] });
+	for (size_t j = 0; j < B.size(); ++j)
+		if (B[j] != 0)
+			tapsB.push_back({ unsigned(k + j), B[j] });
+
+	if ((tapsA.size() + tapsB.size()) <= SPARSE_DENSITY * (A.size() + B.size()))
+		mode = Representation::Sparse;
+	else
+	{
+		mode = B.size() >= CONV_TAPS ? Representation::Conv : Representation::Dense;
+		tapsA.clear();
+		tapsB.clear();
+	}
+
+	/// Reprezentacja gęsta: współczynniki dopełnione zerami, aby jądro nie obsługiwało końcówki
+	Ap.clear();
+	Bp.clear();
+	if (mode != Representation::Sparse)
+	{
+		Ap.assign(padKernel(A.size()), 0.0);
+		std::copy(std::begin(A), std::end(A), Ap.begin());
+	}
+	if (mode == Representation::Dense)
+	{
+		Bp.assign(padKernel(B.size()), 0.0);
+		std::copy(std::begin(B), std::end(B), Bp.begin());
+	}
+	conv = mode == Representation::Conv ? PartitionedConv(std::span<const double>(std::begin(B), B.size())) : PartitionedConv();
+
+	/// W trybie Conv linia inBuf opóźnia wejście splotu o k próbek i przechowuje pełną historię wejść (stan modelu)
+	inBuf.resize(std::max(B.size(), Bp.size()) + k); ///< zmienia rozmiar linii inBuf
+	outBuf.resize(std::max(A.size(), Ap.size())); ///< zmienia rozmiar linii outBuf
+}
+
+/**
+ * \brief Dopisuje wejście do historii bez wyznaczania wyjścia.
+ * \param in Wartość wejścia.
+ */
+void ARX::pushInput(double in)
+{
+	inBuf.push(in);
+	if (mode == Representation::Conv)
+		conv.process(inBuf[k]);
+}
+
+/**
+ * \brief Zwraca stan modelu.
+ * \return Historia wejść (inBuf, od najnowszej), a po niej historia wyjść (outBuf, od najnowszej).
+ */
+std::vector<double> ARX::state() const
+{
+	std::vector<double> s(inBuf.data(), inBuf.data() + inBuf.size());
+	s.insert(s.end(), outBuf.data(), outBuf.data() + outBuf.size());
+	return s;
+}
+
+/**
+ * \brief Ustawia stan modelu.
+ *
+ * Historia wejść jest odtwarzana przez pushInput(), więc w reprezentacji Conv odtwarzany jest również stan splotu
+ * (z fazą bloku wynikającą z liczby odtworzonych próbek; dokładny stan zapisuje PartitionedConv::state()).
+ * \param s Stan w formacie zwracanym przez state().
+ * \throws std::invalid_argument Gdy długość stanu nie odpowiada modelowi.
+ */
+void ARX::setState(std::span<const double> s)
+{
+	if (s.size() != stateSize())
+		throw std::invalid_argument("State size does not match the model!");
+
+	resetState();
+	for (size_t j = inBuf.size(); j-- > 0;)
+		pushInput(s[j]);
+	for (size_t j = outBuf.size(); j-- > 0;)
+		outBuf.push(s[inBuf.size() + j]);
+}
+
+/**
+ * \brief Zwraca długość wektora stanu.
+ * \return inBuf.size() + outBuf.size().
+ */
+size_t ARX::stateSize() const
+{
+	return inBuf.size() + outBuf.size();
+}
+
+/**
+ * \brief Zeruje historię wejść i wyjść.
+ */
+void ARX::resetState()
+{
+	inBuf.clear();
+	outBuf.clear();
+	conv.reset();
+}
+
+/**
+ * \brief Symulacja w układzie otwartym z podziałem na fragmenty liczone równolegle.
+ *
+ * Wyjście jest sumą odpowiedzi wymuszonej z (liczonej w każdym fragmencie od zerowego stanu wyjść)
+ * i odpowiedzi swobodnej h od stanu s_c na początku fragmentu c. Stany spełniają rekurencję
+ * s_{c+1} = zEnd_c + M^{len_c} s_c, gdzie M jest macierzą towarzyszącą mianownika, a zEnd_c - ostatnimi
+ * wartościami z we fragmencie c. Skan jest szeregowy, ale kosztuje tylko O(liczba fragmentów * na^2).
+ * \param u Przebieg wejścia.
+ * \param y Bufor na przebieg wyjścia.
+ * \param threads Liczba wątków (0 - liczba rdzeni).
+ */
+void ARX::simulate(std::span<const double> u, std::span<double> y, unsigned threads)
+{
+	if (u.size() != y.size())
+		throw std::invalid_argument("Input and output lengths do not match!");
+
+	const size_t N = u.size();
+	for (double& v : y)
+		v = getNoise(); ///< szum generowany szeregowo, tymczasowo w buforze wyjścia
+
+	/// Podział na fragmenty - każdy musi pomieścić pełną historię wejść potrzebną do odtworzenia stanu
+	const size_t nHist = inBuf.size();
+	const size_t minChunk = std::max({ nHist, outBuf.size(), MIN_CHUNK });
+	if (!threads)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	const size_t C = std::max<size_t>(1, std::min<size_t>(threads, N / minChunk));
+	if (C == 1)
+	{
+		for (size_t t = 0; t < N; ++t)
+			y[t] = step(u[t], y[t]);
+		return;
+	}
+
+	std::vector<size_t> t0(C + 1);
+	for (size_t c = 0; c <= C; ++c)
+		t0[c] = N * c / C;
+
+	/// Etap 1: odpowiedź wymuszona każdego fragmentu (fragment 0 liczony na właściwym stanie modelu)
+	std::vector<ARX> loc(C, *this);
+	parallelFor(C, unsigned(C), [&](size_t c)
+		{
+			ARX& m = c ? loc[c] : *this;
+			if (c)
+			{
+				m.resetState();
+				for (size_t t = t0[c] - nHist; t < t0[c]; ++t)
+					m.pushInput(u[t]);
+			}
+			for (size_t t = t0[c]; t < t0[c + 1]; ++t)
+				y[t] = m.step(u[t], y[t]);
+		});
+
+	/// Etap 2: skan stanów na granicach fragmentów
+	const size_t na = A.size();
+	if (na)
+	{
+		Matrix M(na, na);
+		for (size_t j = 0; j < na; ++j)
+			M(0, j) = -A[j];
+		for (size_t i = 1; i < na; ++i)
+			M(i, i - 1) = 1;
+
+		std::map<size_t, Matrix> powers; ///< M^len dla występujących długości fragmentów (najwyżej dwie)
+		auto power = [&](size_t len) -> const Matrix&
+		{
+			auto it = powers.find(len);
+			if (it != powers.end())
+				return it->second;
+			Matrix P = Matrix::identity(na), B2 = M;
+			for (size_t e = len; e; e >>= 1, B2 = B2 * B2)
+				if (e & 1)
+					P = P * B2;
+			return powers.emplace(len, std::move(P)).first->second;
+		};
+
+		std::vector<std::vector<double>> s(C, std::vector<double>(na));
+		for (size_t j = 0; j < na; ++j)
+			s[1][j] = y[t0[1] - 1 - j]; ///< fragment 0 ma już wartości prawdziwe
+		for (size_t c = 1; c + 1 < C; ++c)
+		{
+			s[c + 1] = power(t0[c + 1] - t0[c]) * s[c];
+			for (size_t j = 0; j < na; ++j)
+				s[c + 1][j] += y[t0[c + 1] - 1 - j];
+		}
+
+		/// Etap 3: dodanie odpowiedzi swobodnej od stanu początkowego każdego fragmentu
+		parallelFor(C, unsigned(C), [&](size_t c)
+			{
+				if (!c)
+					return;
+				DelayLine h(na);
+				for (size_t j = na; j-- > 0;)
+					h.push(s[c][j]);
+				for (size_t t = t0[c]; t < t0[c + 1]; ++t)
+				{
+					double v = -std::inner_product(std::begin(A), std::end(A), h.data(), 0.0);
+					h.push(v);
+					y[t] += v;
+				}
+			});
+	}
+
+	/// Stan końcowy: historia wejść z ostatniego fragmentu, historia wyjść z prawdziwych wartości
+	inBuf = loc[C - 1].inBuf;
+	conv = loc[C - 1].conv;
+	outBuf.clear();
+	for (size_t t = N - outBuf.size(); t < N; ++t)
+		outBuf.push(y[t]);
+}
+
+/**
+ * \brief Sprawdza, czy model używa reprezentacji rzadkiej.
+ * \return true, jeśli używana jest reprezentacja rzadka.
+ */
+bool ARX::isSparse() const
+{
+	return mode == Representation::Sparse;
+}
+
+/**
+ * \brief Zwraca reprezentację wybraną dla bieżących współczynników.
+ * \return Reprezentacja modelu.
+ */
+ARX::Representation ARX::representation() const
+{
+	return mode;
 }
 
 
@@ -131,6 +396,5 @@ void from_json(const json& j, ARX& o)
 	j.at("k").get_to(o.k);
 	j.at("ns_var").get_to(o.ns_var);
 
-	o.outBuf.resize(o.A.size());
-	o.inBuf.resize(o.B.size() + o.k);
+	o.configure(); ///< automatyczny wybór reprezentacji na podstawie liczby niezerowych współczynników
 }
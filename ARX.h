@@ -1,10 +1,14 @@
 #pragma once
 
 #include "SISO.h"
+#include "DelayLine.h"
+#include "Aligned.h"
+#include "PartitionedConv.h"
 
 #include <valarray>
 #include <span>
 #include <initializer_list>
+#include <vector>
 
 #include "json.hpp" ///< Biblioteka obsługująca format JSON
 using json = nlohmann::json;
@@ -14,8 +18,31 @@ using json = nlohmann::json;
 ///
 /// Klasa ARX dziedziczy po klasie SISO (Single Input Single Output), która implementuje interfejs dla regulatorów jednokanałowych.
 /// Implementuje model ARX z mianownikiem (A) i licznikiem (B).
+///
+/// Historia wejść i wyjść jest przechowywana w liniach opóźniających o stałym koszcie kroku, niezależnym od opóźnienia k.
+/// Jeśli współczynniki A i B zawierają w większości zera (np. długie opóźnienie zapisane zerami w B),
+/// model automatycznie przechodzi na reprezentację rzadką, w której koszt kroku zależy tylko od liczby niezerowych współczynników.
+/// W reprezentacji gęstej iloczyny skalarne liczy wektoryzowane jądro dot() (Kernels.h) wybrane dla procesora.
+/// Bardzo długi licznik (np. zmierzona odpowiedź impulsowa obiektu) jest liczony splotem blokowym PartitionedConv.
 class ARX : public SISO {
+public:
+	/// \enum Representation
+	/// \brief Sposób obliczania kroku modelu.
+	enum class Representation
+	{
+		Dense, ///< Iloczyny skalarne wszystkich współczynników.
+		Sparse, ///< Tylko niezerowe współczynniki.
+		Conv, ///< Licznik liczony splotem blokowym (FFT), mianownik iloczynem skalarnym.
+	};
+
+private:
 	friend class Simulation; ///< Deklaracja przyjaźni z klasą Simulation
+	friend class ARXBatch; ///< Deklaracja przyjaźni z klasą ARXBatch (współczynniki modelu)
+	friend class SimulationBank; ///< Deklaracja przyjaźni z klasą SimulationBank (współczynniki i stan modelu)
+	friend class TileScheduler; ///< Deklaracja przyjaźni z klasą TileScheduler (amplituda szumu modelu)
+	template <typename> friend class ScalarARX; ///< Deklaracja przyjaźni z szablonem ScalarARX (współczynniki modelu)
+	friend class FixedARX; ///< Deklaracja przyjaźni z klasą FixedARX (współczynniki modelu)
+	friend class ClosedLoop; ///< Deklaracja przyjaźni z klasą ClosedLoop (współczynniki modelu)
 
 	/// Definicja aliasu typu danych DS, odnosi się do typu std::valarray<double>.
 	/// Zamiast używać pełnej nazwy, można użyć skróconej nazwy DS.
@@ -26,8 +53,44 @@ class ARX : public SISO {
 	unsigned k = 0;  ///< Opóźnienie modelu ARX. Domyślnie 0.
 	double ns_var = 1; ///< Amplituda szumu modelu ARX. Domyślnie 1.
 
-	DS inBuf; ///< Wektor przechowujący wartości wejściowe wraz z opóźnieniem.
-	DS outBuf; ///< Wektor przechowujący wartości wyjściowe wraz z opóźnieniem.
+	DelayLine inBuf; ///< Linia opóźniająca przechowująca wartości wejściowe wraz z opóźnieniem (k + Bp.size() próbek).
+	DelayLine outBuf; ///< Linia opóźniająca przechowująca poprzednie wartości wyjściowe (Ap.size() próbek).
+
+	AlignedVector<double> Ap; ///< Kopia A wyrównana do 64 bajtów i dopełniona zerami do wielokrotności KERNEL_PAD (reprezentacja gęsta).
+	AlignedVector<double> Bp; ///< Kopia B wyrównana do 64 bajtów i dopełniona zerami do wielokrotności KERNEL_PAD (reprezentacja gęsta).
+
+	/// \struct Tap
+	/// \brief Niezerowy współczynnik reprezentacji rzadkiej wraz z jego opóźnieniem.
+	struct Tap
+	{
+		unsigned lag; ///< Indeks próbki w linii opóźniającej (0 - najnowsza).
+		double c; ///< Wartość współczynnika.
+	};
+
+	Representation mode = Representation::Dense; ///< Wybrana reprezentacja modelu.
+	std::vector<Tap> tapsA; ///< Niezerowe współczynniki mianownika (reprezentacja rzadka).
+	std::vector<Tap> tapsB; ///< Niezerowe współczynniki licznika z opóźnieniem k wliczonym w lag (reprezentacja rzadka).
+
+	PartitionedConv conv; ///< Splot blokowy licznika (reprezentacja Conv); wejściem jest u(t - k).
+
+	/// Największy udział niezerowych współczynników, przy którym wybierana jest reprezentacja rzadka.
+	static constexpr double SPARSE_DENSITY = 0.25;
+
+	/// Najmniejsza długość licznika, od której licznik gęsty jest liczony splotem blokowym.
+	static constexpr size_t CONV_TAPS = 2048;
+
+	/// Najmniejsza długość fragmentu w symulacji równoległej (mniejsze fragmenty nie opłacają się wątkom).
+	static constexpr size_t MIN_CHUNK = 1 << 14;
+
+	/// \brief Dopasowuje bufory do współczynników i wybiera reprezentację (gęstą, rzadką lub splot blokowy).
+	void configure();
+
+	/// \brief Dopisuje wejście do historii bez wyznaczania wyjścia (odtwarzanie stanu wejściowego).
+	/// \param in Wartość wejścia.
+	void pushInput(double in);
+
+	/// \brief Zeruje historię wejść i wyjść.
+	void resetState();
 
 public:
 	/// \brief Konstruktor klasy ARX.
@@ -49,15 +112,50 @@ public:
 	/// \return Wartość wyjściowa po zastosowaniu modelu ARX.
 	double sim(double in);
 
+	/// \brief Wykonuje jeden krok modelu z zadaną próbką szumu.
+	///
+	/// sim(in) jest równoważne step(in, getNoise()).
+	/// \param in Wartość wejścia.
+	/// \param e Próbka szumu (przed przeskalowaniem przez ns_var).
+	/// \return Wartość wyjściowa.
+	double step(double in, double e);
+
+	/// \brief Symulacja w układzie otwartym długiego przebiegu wejścia z podziałem na fragmenty liczone równolegle.
+	///
+	/// Szum jest generowany szeregowo (ta sama sekwencja co przy kolejnych wywołaniach sim()).
+	/// Każdy wątek liczy swój fragment od zerowego stanu wyjść (z poprawną historią wejść),
+	/// a następnie stany na granicach fragmentów są propagowane skanem z użyciem potęg macierzy
+	/// towarzyszącej mianownika, po czym każdy fragment dodaje odpowiedź swobodną od swojego stanu początkowego.
+	/// Stan modelu po wywołaniu jest taki sam jak po u.size() wywołaniach sim().
+	///
+	/// Dokładność: wynik różni się od szeregowego tylko błędami zaokrągleń; dla modeli stabilnych
+	/// różnica nie przekracza 1e-9 * max|y|. Dla modeli niestabilnych błędy te rosną tak jak sama odpowiedź.
+	/// \param u Przebieg wejścia.
+	/// \param y Bufor na przebieg wyjścia (tej samej długości co u).
+	/// \param threads Liczba wątków. 0 - liczba rdzeni procesora.
+	/// \throws std::invalid_argument Gdy długości u i y są różne.
+	void simulate(std::span<const double> u, std::span<double> y, unsigned threads = 0);
+
+	/// \brief Zwraca stan modelu (historię wejść i wyjść, od najnowszych próbek).
+	std::vector<double> state() const;
+
+	/// \brief Ustawia stan modelu zwrócony wcześniej przez state().
+	/// \param s Wektor stanu.
+	/// \throws std::invalid_argument Gdy długość stanu nie odpowiada modelowi.
+	void setState(std::span<const double> s);
+
+	/// \brief Zwraca długość wektora stanu.
+	size_t stateSize() const;
+
 	/// \brief Funkcja ustawiająca wartości licznika (B) modelu ARX.
 	///
-	/// Ustawia wartości wektora B i przesuwa wartości wektora inBuf o odpowiednią ilość elementów.
+	/// Ustawia wartości wektora B, dopasowuje długość linii inBuf i wybiera reprezentację modelu.
 	/// \param n Lista inicjalizacyjna z wartościami typu double reprezentującymi licznik (B).
 	void setNum(std::initializer_list<double> n);
 
 	/// \brief Funkcja ustawiająca wartości mianownika (A) modelu ARX.
 	///
-	/// Ustawia wartości wektora A i zmienia rozmiar wektora outBuf.
+	/// Ustawia wartości wektora A, dopasowuje długość linii outBuf i wybiera reprezentację modelu.
 	/// \param d Lista inicjalizacyjna z wartościami typu double reprezentującymi mianownik (A).
 	void setDen(std::initializer_list<double> d);
 
@@ -67,6 +165,13 @@ public:
 	/// \return Wygenerowana wartość szumu.
 	static double getNoise();
 
+	/// \brief Sprawdza, czy model używa reprezentacji rzadkiej.
+	/// \return true, jeśli krok symulacji przegląda tylko niezerowe współczynniki.
+	bool isSparse() const;
+
+	/// \brief Zwraca reprezentację wybraną dla bieżących współczynników.
+	Representation representation() const;
+
 	/// \brief Serializacja obiektu klasy ARX do formatu JSON.
 	/// \param j Obiekt JSON, do którego będą zapisywane dane.
 	/// \param o Obiekt ARX, który będzie serializowany.
@@ -0,0 +1,153 @@
+/// \file ARXBatch.cpp
+/// \brief Zawiera implementację jednoczesnej symulacji wielu przebiegów przez ten sam model ARX.
+
+#include "ARXBatch.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * \brief Konstruktor klasy ARXBatch.
+ * \param model Model ARX.
+ * \param m Liczba przebiegów.
+ */
+ARXBatch::ARXBatch(const ARX& model, size_t m)
+	: A(std::begin(model.A), std::end(model.A)), B(std::begin(model.B), std::end(model.B)), k(model.k), ns_var(model.ns_var), M(m)
+{
+	nIn = B.empty() ? 0 : k + B.size();
+	nOut = A.size();
+	blocks.resize((M + LANES - 1) / LANES);
+	reset();
+}
+
+/**
+ * \brief Zeruje stan wszystkich przebiegów.
+ */
+void ARXBatch::reset()
+{
+	for (Block& b : blocks)
+	{
+		b.in.assign(2 * nIn * LANES, 0.0);
+		b.out.assign(2 * nOut * LANES, 0.0);
+		b.inPos = b.outPos = 0;
+	}
+}
+
+/**
+ * \brief Krok czasowy jednego bloku.
+ *
+ * Dla każdego współczynnika jeden wiersz historii (LANES próbek) jest mnożony przez tę samą
+ * stałą - pętla wewnętrzna ma stałą długość i jest wektoryzowana.
+ * \param b Blok.
+ * \param in Wiersz wejść.
+ * \param e Wiersz próbek szumu lub nullptr.
+ * \param y Wiersz wyjść.
+ */
+void ARXBatch::stepBlock(Block& b, const double* in, const double* e, double* y) const
+{
+	if (nIn)
+	{
+		b.inPos = (b.inPos ? b.inPos : nIn) - 1;
+		std::copy(in, in + LANES, b.in.data() + b.inPos * LANES);
+		std::copy(in, in + LANES, b.in.data() + (b.inPos + nIn) * LANES);
+	}
+
+	alignas(CACHE_LINE) double acc[LANES] = {};
+	for (size_t j = 0; j < B.size(); ++j)
+	{
+		const double c = B[j];
+		const double* r = b.in.data() + (b.inPos + k + j) * LANES;
+		for (size_t l = 0; l < LANES; ++l)
+			acc[l] += c * r[l];
+	}
+	for (size_t j = 0; j < nOut; ++j)
+	{
+		const double c = A[j];
+		const double* r = b.out.data() + (b.outPos + j) * LANES;
+		for (size_t l = 0; l < LANES; ++l)
+			acc[l] -= c * r[l];
+	}
+	if (e)
+		for (size_t l = 0; l < LANES; ++l)
+			acc[l] += ns_var * e[l];
+
+	if (nOut)
+	{
+		b.outPos = (b.outPos ? b.outPos : nOut) - 1;
+		std::copy(acc, acc + LANES, b.out.data() + b.outPos * LANES);
+		std::copy(acc, acc + LANES, b.out.data() + (b.outPos + nOut) * LANES);
+	}
+	std::copy(acc, acc + LANES, y);
+}
+
+/**
+ * \brief Wykonuje jeden krok wszystkich przebiegów.
+ * \param in Wejścia przebiegów.
+ * \param out Wyjścia przebiegów.
+ */
+void ARXBatch::step(std::span<const double> in, std::span<double> out)
+{
+	if (in.size() != M || out.size() != M)
+		throw std::invalid_argument("Batch size does not match!");
+
+	alignas(CACHE_LINE) double u[LANES], e[LANES], y[LANES];
+	for (size_t bi = 0; bi < blocks.size(); ++bi)
+	{
+		const size_t m0 = bi * LANES, n = std::min(LANES, M - m0);
+		std::fill(u, u + LANES, 0.0);
+		std::fill(e, e + LANES, 0.0);
+		std::copy(in.begin() + m0, in.begin() + m0 + n, u);
+		if (ns_var != 0)
+			for (size_t l = 0; l < n; ++l)
+				e[l] = ARX::getNoise();
+		stepBlock(blocks[bi], u, ns_var != 0 ? e : nullptr, y);
+		std::copy(y, y + n, out.begin() + m0);
+	}
+}
+
+/**
+ * \brief Symuluje T kroków wszystkich przebiegów.
+ *
+ * Szum (jeśli występuje) jest najpierw losowany szeregowo do bufora wyjść, a następnie bloki są
+ * symulowane niezależnie (ewentualnie równolegle), każdy przez cały horyzont. Wejścia i wyjścia
+ * bloku są przepisywane kaflami po 64 chwile, dzięki czemu dostęp do pamięci każdego przebiegu jest ciągły.
+ * \param u Wejścia w układzie [przebieg][chwila].
+ * \param y Wyjścia w układzie [przebieg][chwila].
+ * \param T Liczba kroków.
+ * \param threads Liczba wątków.
+ */
+void ARXBatch::run(std::span<const double> u, std::span<double> y, size_t T, unsigned threads)
+{
+	if (u.size() != M * T || y.size() != M * T)
+		throw std::invalid_argument("Batch size does not match!");
+
+	const bool noisy = ns_var != 0;
+	if (noisy)
+		for (double& v : y)
+			v = ARX::getNoise();
+
+	parallelFor(blocks.size(), threads, [&](size_t bi)
+		{
+			/// Kafel TILE chwil x LANES przebiegów: odczyt i zapis każdego przebiegu są ciągłe w pamięci
+			constexpr size_t TILE = 64;
+			const size_t m0 = bi * LANES, n = std::min(LANES, M - m0);
+			AlignedVector<double> ut(TILE * LANES, 0.0), et(TILE * LANES, 0.0), yt(TILE * LANES);
+			for (size_t t0 = 0; t0 < T; t0 += TILE)
+			{
+				const size_t tn = std::min(TILE, T - t0);
+				for (size_t l = 0; l < n; ++l)
+					for (size_t t = 0; t < tn; ++t)
+					{
+						ut[t * LANES + l] = u[(m0 + l) * T + t0 + t];
+						if (noisy)
+							et[t * LANES + l] = y[(m0 + l) * T + t0 + t];
+					}
+				for (size_t t = 0; t < tn; ++t)
+					stepBlock(blocks[bi], ut.data() + t * LANES, noisy ? et.data() + t * LANES : nullptr, yt.data() + t * LANES);
+				for (size_t l = 0; l < n; ++l)
+					for (size_t t = 0; t < tn; ++t)
+						y[(m0 + l) * T + t0 + t] = yt[t * LANES + l];
+			}
+		});
+}
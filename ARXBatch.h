@@ -0,0 +1,86 @@
+#pragma once
+
+#include "ARX.h"
+#include "Aligned.h"
+
+#include <span>
+#include <vector>
+
+/// \file ARXBatch.h
+/// \brief Zawiera definicję klasy ARXBatch - jednoczesnej symulacji wielu przebiegów przez ten sam model ARX.
+
+/// \class ARXBatch
+/// \brief Symulacja M przebiegów wejścia przez jeden model ARX (wspólne współczynniki, osobne historie).
+///
+/// Przebiegi są grupowane w bloki po LANES. Historie wejść i wyjść bloku są przeplatane: wiersz linii
+/// opóźniającej zawiera próbki wszystkich LANES przebiegów z tej samej chwili, więc krok czasowy bloku
+/// jest małym iloczynem macierz-wektor, w którym każdy współczynnik jest ładowany raz i mnożony przez
+/// cały wiersz (pętla po przebiegach jest wektoryzowana przez kompilator). W run() każdy blok jest
+/// symulowany przez cały horyzont, zanim zostanie pobrany kolejny - jego historia pozostaje w pamięci L1.
+class ARXBatch
+{
+public:
+	/// Liczba przebiegów w bloku (szerokość wiersza historii).
+	static constexpr size_t LANES = 32;
+
+private:
+	/// \struct Block
+	/// \brief Stan bloku LANES przebiegów: przeplatane linie opóźniające wejść i wyjść.
+	struct Block
+	{
+		AlignedVector<double> in; ///< Historia wejść: 2 * nIn wierszy po LANES próbek (bufor lustrzany).
+		AlignedVector<double> out; ///< Historia wyjść: 2 * nOut wierszy po LANES próbek (bufor lustrzany).
+		size_t inPos = 0; ///< Wiersz najnowszego wejścia.
+		size_t outPos = 0; ///< Wiersz najnowszego wyjścia.
+	};
+
+	std::vector<double> A; ///< Mianownik modelu.
+	std::vector<double> B; ///< Licznik modelu.
+	unsigned k = 0; ///< Opóźnienie modelu.
+	double ns_var = 0; ///< Amplituda szumu modelu.
+	size_t M = 0; ///< Liczba przebiegów.
+	size_t nIn = 0; ///< Długość historii wejść (k + nb).
+	size_t nOut = 0; ///< Długość historii wyjść (na).
+	std::vector<Block> blocks; ///< Bloki przebiegów.
+
+	/// \brief Krok czasowy jednego bloku.
+	/// \param b Blok.
+	/// \param in Wiersz wejść (LANES próbek).
+	/// \param e Wiersz próbek szumu (LANES próbek) lub nullptr.
+	/// \param y Wiersz wyjść (LANES próbek).
+	void stepBlock(Block& b, const double* in, const double* e, double* y) const;
+
+public:
+	/// \brief Konstruktor klasy ARXBatch.
+	///
+	/// Kopiuje współczynniki modelu; wszystkie przebiegi zaczynają od zerowego stanu.
+	/// \param model Model ARX.
+	/// \param M Liczba przebiegów.
+	ARXBatch(const ARX& model, size_t M);
+
+	/// \brief Zwraca liczbę przebiegów.
+	size_t size() const { return M; }
+
+	/// \brief Zeruje stan wszystkich przebiegów.
+	void reset();
+
+	/// \brief Wykonuje jeden krok wszystkich przebiegów.
+	///
+	/// Szum jest losowany przez ARX::getNoise() w kolejności przebiegów (jak przy M obiektach ARX
+	/// wywoływanych po kolei w każdym kroku); przy ns_var = 0 szum nie jest losowany.
+	/// \param in Wejścia przebiegów (M wartości).
+	/// \param out Wyjścia przebiegów (M wartości).
+	/// \throws std::invalid_argument Gdy długości in lub out są różne od M.
+	void step(std::span<const double> in, std::span<double> out);
+
+	/// \brief Symuluje T kroków wszystkich przebiegów.
+	///
+	/// Szum jest losowany szeregowo w kolejności (przebieg, chwila) - jak przy symulacji M niezależnych
+	/// obiektów ARX kolejno przez cały horyzont; przy ns_var = 0 szum nie jest losowany.
+	/// \param u Wejścia: u[m * T + t] to próbka t przebiegu m.
+	/// \param y Wyjścia w tym samym układzie co u.
+	/// \param T Liczba kroków.
+	/// \param threads Liczba wątków (bloki są niezależne). Domyślnie 1; 0 - liczba rdzeni.
+	/// \throws std::invalid_argument Gdy długości u lub y są różne od M * T.
+	void run(std::span<const double> u, std::span<double> y, size_t T, unsigned threads = 1);
+};
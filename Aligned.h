@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/// \file Aligned.h
+/// \brief Zawiera alokator wyrównujący pamięć do granicy linii pamięci podręcznej.
+
+/// Wyrównanie (w bajtach) używane dla buforów przetwarzanych instrukcjami wektorowymi.
+constexpr size_t CACHE_LINE = 64;
+
+/// \class AlignedAllocator
+/// \brief Alokator zwracający pamięć wyrównaną do Align bajtów.
+/// \tparam T Typ elementów.
+/// \tparam Align Wyrównanie w bajtach. Domyślnie CACHE_LINE.
+template <typename T, size_t Align = CACHE_LINE>
+class AlignedAllocator
+{
+public:
+	using value_type = T; ///< Typ elementów.
+
+	/// \brief Struktura umożliwiająca utworzenie alokatora dla innego typu.
+	template <typename U>
+	struct rebind
+	{
+		using other = AlignedAllocator<U, Align>; ///< Alokator dla typu U.
+	};
+
+	AlignedAllocator() = default; ///< Konstruktor domyślny.
+
+	/// \brief Konstruktor konwertujący z alokatora innego typu.
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+	/// \brief Przydziela pamięć na n elementów.
+	/// \param n Liczba elementów.
+	/// \return Wskaźnik na wyrównaną pamięć.
+	T* allocate(size_t n)
+	{
+		return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+	}
+
+	/// \brief Zwalnia pamięć przydzieloną przez allocate.
+	/// \param p Wskaźnik na pamięć.
+	void deallocate(T* p, size_t)
+	{
+		::operator delete(p, std::align_val_t(Align));
+	}
+
+	/// \brief Alokatory są bezstanowe, więc zawsze równe.
+	template <typename U>
+	bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+};
+
+/// Wektor z pamięcią wyrównaną do linii pamięci podręcznej.
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
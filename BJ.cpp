@@ -0,0 +1,129 @@
+/// \file BJ.h
+/// \brief Zawiera implementację klasy BJ.
+
+#include "BJ.h"
+#include "ARX.h"
+
+#include <numeric>
+#include <algorithm>
+
+/**
+ * \brief Konstruktor klasy BJ.
+ * \param b Licznik części deterministycznej.
+ * \param f Mianownik części deterministycznej.
+ * \param c Licznik filtru szumu.
+ * \param d Mianownik filtru szumu.
+ * \param dly Opóźnienie.
+ * \param ns Amplituda szumu.
+ */
+BJ::BJ(std::initializer_list<double> b, std::initializer_list<double> f, std::initializer_list<double> c, std::initializer_list<double> d, unsigned dly, double ns)
+	: B(b), F(f), C(c), D(d), k(dly), ns_var(ns)
+{
+	reset();
+}
+
+/**
+ * \brief Konstruktor klasy BJ z gotowych wektorów współczynników.
+ * \param b Licznik części deterministycznej.
+ * \param f Mianownik części deterministycznej.
+ * \param c Licznik filtru szumu.
+ * \param d Mianownik filtru szumu.
+ * \param dly Opóźnienie.
+ * \param ns Amplituda szumu.
+ */
+BJ::BJ(DS b, DS f, DS c, DS d, unsigned dly, double ns)
+	: B(std::move(b)), F(std::move(f)), C(std::move(c)), D(std::move(d)), k(dly), ns_var(ns)
+{
+	reset();
+}
+
+/**
+ * \brief Dopasowuje rozmiary buforów do współczynników i zeruje stan.
+ */
+void BJ::reset()
+{
+	inBuf.resize(B.size() + k);
+	wBuf.resize(F.size());
+	eBuf.resize(C.size() + 1);
+	vBuf.resize(D.size());
+	noiseBlk.assign(NOISE_BLOCK, 0);
+	noisePos = NOISE_BLOCK;
+}
+
+/**
+ * \brief Generuje i filtruje kolejny blok szumu.
+ *
+ * Filtr szumu C/D nie zależy od wejścia, więc cały blok jest wyznaczany z wyprzedzeniem:
+ * v(t) = ns_var * (e(t) + sum C_j e(t-1-j)) - sum D_j v(t-1-j).
+ */
+void BJ::refillNoise()
+{
+	noisePos = 0;
+	if (ns_var == 0)
+	{
+		std::fill(noiseBlk.begin(), noiseBlk.end(), 0.0);
+		return;
+	}
+
+	for (double& v : noiseBlk)
+	{
+		eBuf.push(ARX::getNoise());
+		const double* e = eBuf.data();
+		v = ns_var * std::inner_product(std::begin(C), std::end(C), e + 1, e[0])
+			- std::inner_product(std::begin(D), std::end(D), vBuf.data(), 0.0);
+		vBuf.push(v);
+	}
+}
+
+/**
+ * \brief Wykonuje jeden krok symulacji.
+ * \param in Wartość wejściowa.
+ * \return Wartość wyjściowa.
+ */
+double BJ::sim(double in)
+{
+	if (noisePos == NOISE_BLOCK)
+		refillNoise();
+
+	inBuf.push(in);
+
+	double w = std::inner_product(std::begin(B), std::end(B), inBuf.data() + k, 0.0)
+		- std::inner_product(std::begin(F), std::end(F), wBuf.data(), 0.0); ///< część deterministyczna B/F
+	wBuf.push(w);
+
+	return w + noiseBlk[noisePos++];
+}
+
+/**
+ * \brief Serializacja obiektu klasy BJ do formatu JSON.
+ * \param j Obiekt JSON, do którego będą zapisywane dane.
+ * \param o Obiekt BJ, który będzie serializowany.
+ */
+void to_json(json& j, const BJ& o)
+{
+	j["B"] = o.B;
+	j["F"] = o.F;
+	j["C"] = o.C;
+	j["D"] = o.D;
+	j["k"] = o.k;
+	j["ns_var"] = o.ns_var;
+}
+
+/**
+ * \brief Deserializacja obiektu klasy BJ z formatu JSON.
+ *
+ * Brak pól "C" i "D" oznacza model błędu wyjścia (OE).
+ * \param j Obiekt JSON, z którego będą odczytywane dane.
+ * \param o Obiekt BJ, do którego będą wczytywane dane.
+ */
+void from_json(const json& j, BJ& o)
+{
+	j.at("B").get_to(o.B);
+	j.at("F").get_to(o.F);
+	o.C = j.value("C", std::valarray<double>());
+	o.D = j.value("D", std::valarray<double>());
+	j.at("k").get_to(o.k);
+	j.at("ns_var").get_to(o.ns_var);
+
+	o.reset();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "SISO.h"
+#include "DelayLine.h"
+
+#include <valarray>
+#include <vector>
+#include <initializer_list>
+
+#include "json.hpp" ///< Biblioteka obsługująca format JSON
+using json = nlohmann::json;
+
+/// \class BJ
+/// \brief Klasa BJ reprezentuje model Boxa-Jenkinsa (oraz jego szczególny przypadek - model błędu wyjścia OE).
+///
+/// Klasa BJ dziedziczy po klasie SISO. Model ma postać y(t) = w(t) + v(t), gdzie
+/// w(t) = sum B_j u(t-k-j) - sum F_j w(t-1-j) (część deterministyczna),
+/// v(t) = ns_var * (e(t) + sum C_j e(t-1-j)) - sum D_j v(t-1-j) (kolorowany szum).
+/// Dla pustych C i D model jest modelem błędu wyjścia (OE) z białym szumem pomiarowym.
+/// Współczynniki F, C i D nie zawierają wiodącej jedynki. Szum jest generowany i filtrowany blokami.
+class BJ : public SISO
+{
+	friend class Simulation; ///< Deklaracja przyjaźni z klasą Simulation
+
+	/// Definicja aliasu typu danych DS, odnosi się do typu std::valarray<double>.
+	using DS = std::valarray<double>;
+
+	DS B; ///< Licznik części deterministycznej.
+	DS F; ///< Mianownik części deterministycznej.
+	DS C; ///< Licznik filtru szumu.
+	DS D; ///< Mianownik filtru szumu.
+	unsigned k = 0; ///< Opóźnienie modelu. Domyślnie 0.
+	double ns_var = 1; ///< Amplituda szumu. Domyślnie 1.
+
+	DelayLine inBuf; ///< Historia wejść (k + B.size() próbek).
+	DelayLine wBuf; ///< Historia części deterministycznej (F.size() próbek).
+	DelayLine eBuf; ///< Historia białego szumu (C.size() + 1 próbek).
+	DelayLine vBuf; ///< Historia kolorowanego szumu (D.size() próbek).
+
+	/// Liczba próbek szumu generowanych i filtrowanych jednym blokiem.
+	static constexpr size_t NOISE_BLOCK = 256;
+
+	std::vector<double> noiseBlk; ///< Blok przefiltrowanego szumu.
+	size_t noisePos = NOISE_BLOCK; ///< Pozycja następnej próbki w bloku szumu.
+
+	/// \brief Dopasowuje rozmiary buforów do współczynników i zeruje stan.
+	void reset();
+
+	/// \brief Generuje i filtruje kolejny blok szumu.
+	void refillNoise();
+
+public:
+	/// \brief Konstruktor klasy BJ.
+	/// \param B Licznik części deterministycznej. Domyślnie pusty.
+	/// \param F Mianownik części deterministycznej. Domyślnie pusty.
+	/// \param C Licznik filtru szumu. Domyślnie pusty.
+	/// \param D Mianownik filtru szumu. Domyślnie pusty.
+	/// \param k Opóźnienie. Domyślnie 0.
+	/// \param ns_var Amplituda szumu. Domyślnie 1.
+	BJ(std::initializer_list<double> B = {}, std::initializer_list<double> F = {}, std::initializer_list<double> C = {}, std::initializer_list<double> D = {}, unsigned k = 0, double ns_var = 1);
+
+	/// \brief Konstruktor klasy BJ z gotowych wektorów współczynników (używany np. przez identyfikację).
+	/// \param B Licznik części deterministycznej.
+	/// \param F Mianownik części deterministycznej.
+	/// \param C Licznik filtru szumu.
+	/// \param D Mianownik filtru szumu.
+	/// \param k Opóźnienie.
+	/// \param ns_var Amplituda szumu.
+	BJ(DS B, DS F, DS C, DS D, unsigned k, double ns_var);
+
+	/// \brief Funkcja symulująca jeden krok modelu BJ.
+	/// \param in Wartość wejściowa.
+	/// \return Wartość wyjściowa modelu.
+	double sim(double in) override;
+
+	/// \brief Serializacja obiektu klasy BJ do formatu JSON.
+	/// \param j Obiekt JSON, do którego będą zapisywane dane.
+	/// \param o Obiekt BJ, który będzie serializowany.
+	friend void to_json(json& j, const BJ& o);
+
+	/// \brief Deserializacja obiektu klasy BJ z formatu JSON.
+	/// \param j Obiekt JSON, z którego będą odczytywane dane.
+	/// \param o Obiekt BJ, do którego będą wczytywane dane.
+	friend void from_json(const json& j, BJ& o);
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/// \file DelayLine.h
+/// \brief Zawiera definicję klasy DelayLineT - bufora cyklicznego przechowującego historię sygnału.
+
+/// \class DelayLineT
+/// \brief Linia opóźniająca (bufor cykliczny) o stałym koszcie dopisania próbki.
+///
+/// Każda próbka jest zapisywana dwukrotnie (w buforze o podwójnej długości), dzięki czemu
+/// ostatnie N próbek zawsze zajmuje ciągły fragment pamięci: data()[0] to próbka najnowsza,
+/// data()[j] - próbka sprzed j kroków. Pozwala to liczyć iloczyny skalarne ze współczynnikami
+/// bez przesuwania bufora i bez alokacji w trakcie symulacji.
+/// \tparam T Typ przechowywanych próbek.
+template <typename T>
+class DelayLineT
+{
+	std::vector<T> buf; ///< Bufor o długości 2N.
+	size_t n = 0; ///< Liczba przechowywanych próbek N.
+	size_t pos = 0; ///< Pozycja najnowszej próbki.
+
+public:
+	/// \brief Konstruktor klasy DelayLineT.
+	/// \param len Liczba przechowywanych próbek. Domyślnie 0.
+	DelayLineT(size_t len = 0)
+	{
+		resize(len);
+	}
+
+	/// \brief Zmienia długość linii i zeruje jej zawartość.
+	/// \param len Nowa liczba przechowywanych próbek.
+	void resize(size_t len)
+	{
+		n = len;
+		pos = 0;
+		buf.assign(2 * n, T(0));
+	}
+
+	/// \brief Zeruje zawartość linii bez zmiany jej długości.
+	void clear()
+	{
+		std::fill(buf.begin(), buf.end(), T(0));
+		pos = 0;
+	}
+
+	/// \brief Zwraca liczbę przechowywanych próbek.
+	size_t size() const
+	{
+		return n;
+	}
+
+	/// \brief Dopisuje najnowszą próbkę (najstarsza zostaje usunięta).
+	/// \param x Dopisywana próbka.
+	void push(const T& x)
+	{
+		if (!n)
+			return;
+		pos = (pos ? pos : n) - 1;
+		buf[pos] = x;
+		buf[pos + n] = x;
+	}
+
+	/// \brief Zwraca wskaźnik na ciągły fragment N próbek, od najnowszej do najstarszej.
+	const T* data() const
+	{
+		return buf.data() + pos;
+	}
+
+	/// \brief Zwraca próbkę sprzed lag kroków (0 - najnowsza).
+	/// \param lag Opóźnienie próbki.
+	const T& operator[](size_t lag) const
+	{
+		return buf[pos + lag];
+	}
+};
+
+using DelayLine = DelayLineT<double>; ///< Linia opóźniająca dla próbek typu double.
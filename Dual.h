@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+/// \file Dual.h
+/// \brief Zawiera definicję liczby dualnej Dual - różniczkowania w przód względem N parametrów.
+
+/// \struct Dual
+/// \brief Liczba dualna: wartość v i pochodne d[i] względem N parametrów.
+///
+/// Działania arytmetyczne przenoszą pochodne zgodnie z regułami różniczkowania, więc obliczenie
+/// wykonane w typie Dual<N> (np. ScalarARX<Dual<3>>, ScalarPID<Dual<3>>) daje jednocześnie wynik
+/// i jego dokładny gradient. Parametr i oznacza się, ustawiając d[i] = 1.
+/// \tparam N Liczba parametrów.
+template <size_t N>
+struct Dual
+{
+	double v = 0; ///< Wartość.
+	std::array<double, N> d{}; ///< Pochodne względem parametrów.
+
+	/// \brief Konstruktor liczby dualnej o zerowych pochodnych (stała).
+	/// \param x Wartość.
+	Dual(double x = 0) : v(x) {}
+
+	/// \brief Konstruktor zmiennej - pochodna względem parametru i równa 1.
+	/// \param x Wartość.
+	/// \param i Indeks parametru.
+	static Dual variable(double x, size_t i)
+	{
+		Dual r(x);
+		r.d[i] = 1;
+		return r;
+	}
+
+	/// \brief Rzutowanie na double (wartość bez pochodnych).
+	explicit operator double() const { return v; }
+
+	Dual& operator+=(const Dual& b)
+	{
+		v += b.v;
+		for (size_t i = 0; i < N; ++i)
+			d[i] += b.d[i];
+		return *this;
+	}
+
+	Dual& operator-=(const Dual& b)
+	{
+		v -= b.v;
+		for (size_t i = 0; i < N; ++i)
+			d[i] -= b.d[i];
+		return *this;
+	}
+
+	Dual& operator*=(const Dual& b)
+	{
+		for (size_t i = 0; i < N; ++i)
+			d[i] = d[i] * b.v + v * b.d[i];
+		v *= b.v;
+		return *this;
+	}
+
+	friend Dual operator+(Dual a, const Dual& b) { return a += b; }
+	friend Dual operator-(Dual a, const Dual& b) { return a -= b; }
+	friend Dual operator*(Dual a, const Dual& b) { return a *= b; }
+
+	friend Dual operator-(Dual a)
+	{
+		a.v = -a.v;
+		for (double& x : a.d)
+			x = -x;
+		return a;
+	}
+
+	/// \brief Moduł: pochodna sign(v) * d (w zerze przyjmowana jako 0).
+	friend Dual abs(Dual a)
+	{
+		if (a.v < 0)
+			return -a;
+		if (a.v == 0)
+			a.d.fill(0);
+		return a;
+	}
+};
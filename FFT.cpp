@@ -0,0 +1,147 @@
+/// \file FFT.cpp
+/// \brief Zawiera implementację szybkiej transformaty Fouriera.
+
+#include "FFT.h"
+
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+namespace
+{
+	/**
+	 * \brief Iteracyjna transformata radix-2 w miejscu.
+	 * \param x Wektor próbek o długości będącej potęgą dwójki.
+	 * \param sign Znak wykładnika (-1 dla transformaty prostej, +1 dla odwrotnej).
+	 */
+	void fftRadix2(std::vector<Complex>& x, double sign)
+	{
+		const size_t n = x.size();
+
+		/// Permutacja odwracająca kolejność bitów indeksów
+		for (size_t i = 1, j = 0; i < n; ++i)
+		{
+			size_t bit = n >> 1;
+			for (; j & bit; bit >>= 1)
+				j ^= bit;
+			j ^= bit;
+			if (i < j)
+				std::swap(x[i], x[j]);
+		}
+
+		/// Tablica pierwiastków z jedności - dokładniejsza niż kolejne mnożenie przez czynnik obrotu.
+		/// Zapamiętywana osobno dla każdego kierunku dla największej dotąd długości N: pierwiastki rzędu
+		/// n | N to co (N / n)-ty element (bitowo te same wartości, bo N / n jest potęgą dwójki), więc
+		/// przeplatane transformaty różnych długości (sploty o różnych blokach) nie przebudowują tablicy.
+		thread_local std::vector<Complex> tables[2];
+		std::vector<Complex>& roots = tables[sign > 0];
+		if (2 * roots.size() < n)
+		{
+			roots.resize(n / 2);
+			for (size_t i = 0; i < n / 2; ++i)
+				roots[i] = std::polar(1.0, sign * 2 * std::numbers::pi * i / n);
+		}
+		const size_t N = 2 * roots.size();
+
+		/// Kolejne etapy motylków
+		for (size_t len = 2; len <= n; len <<= 1)
+		{
+			const size_t half = len / 2;
+			const size_t step = N / len;
+
+			for (size_t i = 0; i < n; i += len)
+			{
+				for (size_t j = 0; j < half; ++j)
+				{
+					Complex u = x[i + j];
+					Complex v = x[i + j + half] * roots[j * step];
+					x[i + j] = u + v;
+					x[i + j + half] = u - v;
+				}
+			}
+		}
+	}
+
+	/**
+	 * \brief Zwraca najmniejszy czynnik pierwszy liczby.
+	 * \param n Rozkładana liczba (n > 1).
+	 * \return Najmniejszy dzielnik pierwszy n.
+	 */
+	size_t smallestFactor(size_t n)
+	{
+		if (n % 4 == 0)
+			return 4; ///< radix-4 zmniejsza liczbę etapów
+		for (size_t p = 2; p * p <= n; ++p)
+			if (n % p == 0)
+				return p;
+		return n;
+	}
+
+	/**
+	 * \brief Rekurencyjna transformata mixed-radix (decymacja w czasie).
+	 *
+	 * Oblicza transformatę n próbek in[0], in[stride], ... i zapisuje wynik do out[0..n).
+	 * \param in Wskaźnik na pierwszą próbkę wejściową.
+	 * \param out Wskaźnik na bufor wyjściowy.
+	 * \param n Długość transformaty.
+	 * \param stride Odstęp między kolejnymi próbkami wejściowymi.
+	 * \param roots Tablica pierwiastków z jedności dla pełnej długości N.
+	 * \param N Pełna długość transformaty.
+	 */
+	void fftMixed(const Complex* in, Complex* out, size_t n, size_t stride, const std::vector<Complex>& roots, size_t N)
+	{
+		if (n == 1)
+		{
+			out[0] = in[0];
+			return;
+		}
+
+		const size_t p = smallestFactor(n);
+		const size_t m = n / p;
+
+		/// Transformaty p podciągów o długości m
+		for (size_t r = 0; r < p; ++r)
+			fftMixed(in + r * stride, out + r * m, m, stride * p, roots, N);
+
+		/// Łączenie wyników motylkiem rzędu p
+		const size_t step = N / n;
+		std::vector<Complex> tmp(p);
+		for (size_t k = 0; k < m; ++k)
+		{
+			for (size_t q = 0; q < p; ++q)
+			{
+				Complex sum = 0;
+				for (size_t r = 0; r < p; ++r)
+					sum += out[r * m + k] * roots[(r * (q * m + k) * step) % N];
+				tmp[q] = sum;
+			}
+			for (size_t q = 0; q < p; ++q)
+				out[q * m + k] = tmp[q];
+		}
+	}
+}
+
+/**
+ * \brief Szybka transformata Fouriera wykonywana w miejscu.
+ * \param x Wektor próbek, nadpisywany wynikiem transformaty.
+ * \param inverse Jeśli true, wykonywana jest transformata odwrotna.
+ */
+void fft(std::vector<Complex>& x, bool inverse)
+{
+	const size_t n = x.size();
+	const double sign = inverse ? 1 : -1;
+	if (n < 2)
+		return;
+
+	if (isPow2(n))
+		return fftRadix2(x, sign);
+
+	/// Tablica pierwiastków z jedności wspólna dla wszystkich etapów
+	std::vector<Complex> roots(n);
+	for (size_t i = 0; i < n; ++i)
+		roots[i] = std::polar(1.0, sign * 2 * std::numbers::pi * i / n);
+
+	std::vector<Complex> out(n);
+	fftMixed(x.data(), out.data(), n, 1, roots, n);
+	x = std::move(out);
+}
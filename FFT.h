@@ -0,0 +1,29 @@
+#pragma once
+
+#include <complex>
+#include <vector>
+
+/// \file FFT.h
+/// \brief Zawiera deklaracje funkcji szybkiej transformaty Fouriera (FFT).
+///
+/// Dla długości będących potęgą dwójki używany jest iteracyjny algorytm radix-2,
+/// dla pozostałych długości rekurencyjny algorytm mixed-radix (rozkład na czynniki pierwsze).
+/// Motylek rzędu p kosztuje O(p) na próbkę, więc dla długości pierwszej transformata jest zwykłą
+/// DFT o koszcie O(n^2) (brak algorytmu Bluesteina/Radera).
+
+using Complex = std::complex<double>; ///< Typ liczby zespolonej używany przez FFT.
+
+/// \brief Szybka transformata Fouriera wykonywana w miejscu.
+///
+/// Transformata nie jest normalizowana - transformata odwrotna wymaga podzielenia wyniku przez x.size().
+/// \param x Wektor próbek, nadpisywany wynikiem transformaty.
+/// \param inverse Jeśli true, wykonywana jest transformata odwrotna (wykładnik dodatni).
+void fft(std::vector<Complex>& x, bool inverse = false);
+
+/// \brief Sprawdza, czy liczba jest potęgą dwójki.
+/// \param n Sprawdzana liczba.
+/// \return true, jeśli n jest potęgą dwójki większą od zera.
+constexpr bool isPow2(size_t n)
+{
+	return n && !(n & (n - 1));
+}
@@ -0,0 +1,305 @@
+/// \file FixedPoint.cpp
+/// \brief Zawiera implementację stałoprzecinkowych regulatora PID i modelu ARX.
+
+#include "FixedPoint.h"
+#include "Simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+	/**
+	 * @brief Dodawanie w akumulatorze 64-bitowym z nasyceniem.
+	 * @param a Składnik.
+	 * @param b Składnik.
+	 * @param sat Licznik nasyceń.
+	 * @return Suma ograniczona do zakresu int64_t.
+	 */
+	int64_t addAcc(int64_t a, int64_t b, size_t& sat)
+	{
+		constexpr int64_t MAX = std::numeric_limits<int64_t>::max(), MIN = std::numeric_limits<int64_t>::min();
+		if (b > 0 && a > MAX - b)
+		{
+			sat++;
+			return MAX;
+		}
+		if (b < 0 && a < MIN - b)
+		{
+			sat++;
+			return MIN;
+		}
+		return a + b;
+	}
+}
+
+/**
+ * @brief Sprawdza poprawność formatu.
+ */
+void QFormat::check() const
+{
+	if (bits < 2 || bits > 32 || frac >= bits)
+		throw std::invalid_argument("Invalid Q format (2 <= bits <= 32, frac < bits)!");
+}
+
+/**
+ * @brief Dopasowuje liczbę całkowitą do długości słowa.
+ * @param v Wartość.
+ * @param sat Licznik nasyceń lub nullptr.
+ * @return Słowo formatu.
+ */
+int64_t QFormat::fit(int64_t v, size_t* sat) const
+{
+	if (v >= minRaw() && v <= maxRaw())
+		return v;
+	if (sat)
+		(*sat)++;
+	if (overflow == Overflow::Saturate)
+		return v < 0 ? minRaw() : maxRaw();
+
+	/// Zawinięcie: bits najmłodszych bitów z rozszerzeniem znaku
+	const uint64_t mask = (uint64_t(1) << bits) - 1;
+	const uint64_t u = uint64_t(v) & mask;
+	return (u >> (bits - 1)) ? int64_t(u) - (int64_t(1) << bits) : int64_t(u);
+}
+
+/**
+ * @brief Przesuwa wartość o s bitów w prawo z zaokrągleniem formatu.
+ * @param v Wartość.
+ * @param s Liczba bitów.
+ * @return Wartość po przesunięciu.
+ */
+int64_t QFormat::shift(int64_t v, unsigned s) const
+{
+	if (!s)
+		return v;
+	const int64_t q = v >> s; ///< podłoga (przesunięcie arytmetyczne)
+	if (round == Rounding::Truncate)
+		return q;
+
+	const int64_t rem = v - (q << s), half = int64_t(1) << (s - 1);
+	if (rem > half || (rem == half && (round == Rounding::Nearest || (q & 1))))
+		return q + 1;
+	return q;
+}
+
+/**
+ * @brief Kwantyzuje liczbę zmiennoprzecinkową.
+ * @param x Wartość.
+ * @param sat Licznik nasyceń lub nullptr.
+ * @return Słowo formatu.
+ */
+int64_t QFormat::quantize(double x, size_t* sat) const
+{
+	double v = std::ldexp(x, int(frac));
+	switch (round)
+	{
+	case Rounding::Truncate:
+		v = std::floor(v);
+		break;
+	case Rounding::Nearest:
+		v = std::floor(v + 0.5);
+		break;
+	default:
+		v = v - std::floor(v) == 0.5 ? 2 * std::floor(v / 2 + 0.5) : std::round(v);
+		break;
+	}
+
+	/// Wartości poza zakresem int64_t (i NaN) są nasycane przed rzutowaniem
+	constexpr double LIM = 9.2e18;
+	if (!(v > -LIM && v < LIM))
+		v = v > 0 ? LIM : -LIM;
+	return fit(int64_t(v), sat);
+}
+
+/**
+ * @brief Serializacja formatu do JSON.
+ * @param j Obiekt JSON.
+ * @param q Format.
+ */
+void to_json(json& j, const QFormat& q)
+{
+	j["bits"] = q.bits;
+	j["frac"] = q.frac;
+	j["round"] = q.round;
+	j["overflow"] = q.overflow;
+}
+
+/**
+ * @brief Deserializacja formatu z JSON.
+ * @param j Obiekt JSON.
+ * @param q Format.
+ */
+void from_json(const json& j, QFormat& q)
+{
+	if (j.contains("bits"))
+		j.at("bits").get_to(q.bits);
+	if (j.contains("frac"))
+		j.at("frac").get_to(q.frac);
+	if (j.contains("round"))
+		j.at("round").get_to(q.round);
+	if (j.contains("overflow"))
+		j.at("overflow").get_to(q.overflow);
+	q.check();
+}
+
+/**
+ * @brief Konstruktor klasy FixedPID.
+ * @param pid Regulator zmiennoprzecinkowy.
+ * @param s Format sygnałów.
+ * @param c Format nastaw.
+ */
+FixedPID::FixedPID(const PID& pid, QFormat s, QFormat c) : sig(s), coef(c)
+{
+	sig.check();
+	coef.check();
+	P = coef.quantize(pid.P, &saturations);
+	I = coef.quantize(pid.I, &saturations);
+	D = coef.quantize(pid.D, &saturations);
+	sumerr = sig.quantize(pid.sumerr, &saturations);
+	lasterr = sig.quantize(pid.lasterr, &saturations);
+}
+
+/**
+ * @brief Krok regulatora na słowach formatu sygnałów.
+ * @param err Błąd regulacji (słowo).
+ * @return Sterowanie (słowo).
+ */
+int64_t FixedPID::step(int64_t err)
+{
+	sumerr = sig.fit(sumerr + err, &saturations);
+	const int64_t differr = sig.fit(err - lasterr, &saturations);
+	lasterr = err;
+
+	int64_t acc = P * err;
+	acc = addAcc(acc, I * sumerr, saturations);
+	acc = addAcc(acc, D * differr, saturations);
+	return sig.fit(sig.shift(acc, coef.frac), &saturations);
+}
+
+/**
+ * @brief Krok regulatora.
+ * @param err Błąd regulacji.
+ * @return Sterowanie.
+ */
+double FixedPID::sim(double err)
+{
+	return sig.value(step(sig.quantize(err, &saturations)));
+}
+
+/**
+ * @brief Konstruktor klasy FixedARX.
+ * @param arx Model zmiennoprzecinkowy.
+ * @param s Format sygnałów.
+ * @param c Format współczynników.
+ */
+FixedARX::FixedARX(const ARX& arx, QFormat s, QFormat c) : sig(s), coef(c), k(arx.k), ns_var(arx.ns_var)
+{
+	sig.check();
+	coef.check();
+	for (double a : arx.A)
+		A.push_back(coef.quantize(a, &saturations));
+	for (double b : arx.B)
+		B.push_back(coef.quantize(b, &saturations));
+	inBuf.resize(B.empty() ? 0 : k + B.size());
+	outBuf.resize(A.size());
+}
+
+/**
+ * @brief Krok modelu na słowach formatu sygnałów.
+ * @param in Wejście (słowo).
+ * @param e Próbka szumu.
+ * @return Wyjście (słowo).
+ */
+int64_t FixedARX::step(int64_t in, double e)
+{
+	inBuf.push(in);
+
+	int64_t acc = 0;
+	for (size_t j = 0; j < B.size(); ++j)
+		acc = addAcc(acc, B[j] * inBuf[k + j], saturations);
+	for (size_t j = 0; j < A.size(); ++j)
+		acc = addAcc(acc, -A[j] * outBuf[j], saturations);
+
+	int64_t out = sig.fit(sig.shift(acc, coef.frac), &saturations);
+	if (ns_var != 0)
+		out = sig.fit(out + sig.quantize(ns_var * e, &saturations), &saturations);
+
+	outBuf.push(out);
+	return out;
+}
+
+/**
+ * @brief Krok modelu z szumem losowanym przez ARX::getNoise().
+ * @param in Wejście.
+ * @return Wyjście.
+ */
+double FixedARX::sim(double in)
+{
+	return sig.value(step(sig.quantize(in, &saturations), ARX::getNoise()));
+}
+
+/**
+ * @brief Wypisuje raport.
+ * @param os Strumień.
+ * @param r Raport.
+ * @return Strumień.
+ */
+std::ostream& operator<<(std::ostream& os, const FixedReport& r)
+{
+	return os << "Q vs double, " << r.steps << " krokow: max |dy| = " << r.maxAbsY << ", RMS dy = " << r.rmsY
+		<< ", max |du| = " << r.maxAbsU << ", RMS du = " << r.rmsU << ", max |y| = " << r.maxY
+		<< ", nasycenia: " << r.saturations;
+}
+
+/**
+ * @brief Symuluje pętlę stałoprzecinkową i pętlę double krok po kroku.
+ *
+ * Pętla double jest liczona przez Simulation::forEachStep; w każdej chwili pętla stałoprzecinkowa wykonuje
+ * krok z tą samą wartością zadaną, zakłóceniem, szumem pomiarowym i próbką szumu ARX. Pomiędzy regulatorem
+ * a modelem wartości są przekazywane jako double (jak przez interfejs SISO), więc formaty sygnałów
+ * regulatora i modelu mogą się różnić.
+ * @param s Symulacja.
+ * @param plant Model stałoprzecinkowy.
+ * @param controller Regulator stałoprzecinkowy.
+ * @return Statystyki odchylenia.
+ */
+FixedReport validateFixed(Simulation& s, const FixedARX& plant, const FixedPID& controller)
+{
+	ARX arx = s.arx;
+	PID pid = s.pid;
+	FixedARX qarx = plant;
+	FixedPID qpid = controller;
+	const size_t sat0 = qarx.saturations + qpid.saturations;
+
+	FixedReport r;
+	double e = 0, qy = 0, sqY = 0, sqU = 0; ///< e - próbka szumu ARX wspólna dla obu pętli
+	auto step = [&](double in, size_t)
+	{
+		e = ARX::getNoise();
+		return arx.step(in, e);
+	};
+	s.forEachStep<double>(pid, step, [&](const LoopSample<double>& p)
+	{
+		const QFormat& ps = qpid.signalFormat();
+		const double qu = ps.value(qpid.step(ps.quantize(p.r - (qy + p.v), &qpid.saturations)));
+		const QFormat& as = qarx.signalFormat();
+		qy = as.value(qarx.step(as.quantize(qu + p.d, &qarx.saturations), e));
+
+		const double dy = std::abs(qy - p.y), du = std::abs(qu - p.u);
+		r.maxAbsY = std::max(r.maxAbsY, dy);
+		r.maxAbsU = std::max(r.maxAbsU, du);
+		r.maxY = std::max(r.maxY, std::abs(p.y));
+		sqY += dy * dy;
+		sqU += du * du;
+		return true;
+	});
+
+	r.steps = s.len + 1;
+	r.rmsY = std::sqrt(sqY / r.steps);
+	r.rmsU = std::sqrt(sqU / r.steps);
+	r.saturations = qarx.saturations + qpid.saturations - sat0;
+	return r;
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "SISO.h"
+#include "ARX.h"
+#include "PID.h"
+#include "DelayLine.h"
+
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "json.hpp"
+using json = nlohmann::json;
+
+class Simulation;
+
+/// \file FixedPoint.h
+/// \brief Zawiera stałoprzecinkowe (format Q) implementacje regulatora PID i modelu ARX.
+
+/// \enum Rounding
+/// \brief Sposób zaokrąglania przy zmniejszaniu liczby bitów ułamkowych.
+enum class Rounding
+{
+	Truncate, ///< Obcięcie w dół (przesunięcie arytmetyczne) - najtańsze na mikrokontrolerze.
+	Nearest, ///< Do najbliższej, połówki w górę.
+	Even ///< Do najbliższej, połówki do parzystej (zaokrąglanie zbieżne).
+};
+
+/// \enum Overflow
+/// \brief Zachowanie przy przekroczeniu zakresu formatu.
+enum class Overflow
+{
+	Saturate, ///< Nasycenie do wartości granicznej.
+	Wrap ///< Zawinięcie (arytmetyka modulo 2^bits, jak w zwykłych typach całkowitych).
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(Rounding, {
+	{ Rounding::Truncate, "truncate" },
+	{ Rounding::Nearest, "nearest" },
+	{ Rounding::Even, "even" },
+})
+
+NLOHMANN_JSON_SERIALIZE_ENUM(Overflow, {
+	{ Overflow::Saturate, "saturate" },
+	{ Overflow::Wrap, "wrap" },
+})
+
+/// \struct QFormat
+/// \brief Format stałoprzecinkowy Q: liczba ze znakiem o bits bitach, w tym frac bitach ułamkowych.
+///
+/// Wartość x jest przechowywana jako liczba całkowita round(x * 2^frac). Słowa mają co najwyżej 32 bity,
+/// więc iloczyn dwóch słów mieści się w 64-bitowym akumulatorze.
+struct QFormat
+{
+	unsigned bits = 32; ///< Długość słowa (2..32).
+	unsigned frac = 16; ///< Liczba bitów ułamkowych (mniejsza niż bits).
+	Rounding round = Rounding::Nearest; ///< Sposób zaokrąglania.
+	Overflow overflow = Overflow::Saturate; ///< Zachowanie przy przepełnieniu.
+
+	/// \brief Sprawdza poprawność formatu.
+	/// \throws std::invalid_argument Gdy bits lub frac są poza zakresem.
+	void check() const;
+
+	/// \brief Największa wartość słowa.
+	int64_t maxRaw() const { return (int64_t(1) << (bits - 1)) - 1; }
+
+	/// \brief Najmniejsza wartość słowa.
+	int64_t minRaw() const { return -(int64_t(1) << (bits - 1)); }
+
+	/// \brief Dopasowuje liczbę całkowitą do długości słowa (nasycenie lub zawinięcie).
+	/// \param v Wartość.
+	/// \param sat Licznik nasyceń (zwiększany, gdy wartość była poza zakresem) lub nullptr.
+	int64_t fit(int64_t v, size_t* sat = nullptr) const;
+
+	/// \brief Przesuwa wartość o s bitów w prawo z zaokrągleniem formatu.
+	/// \param v Wartość.
+	/// \param s Liczba bitów.
+	int64_t shift(int64_t v, unsigned s) const;
+
+	/// \brief Kwantyzuje liczbę zmiennoprzecinkową.
+	/// \param x Wartość.
+	/// \param sat Licznik nasyceń lub nullptr.
+	int64_t quantize(double x, size_t* sat = nullptr) const;
+
+	/// \brief Zwraca wartość słowa jako liczbę zmiennoprzecinkową.
+	/// \param v Słowo.
+	double value(int64_t v) const { return std::ldexp(double(v), -int(frac)); }
+
+	/// \brief Serializacja formatu do JSON.
+	friend void to_json(json& j, const QFormat& q);
+
+	/// \brief Deserializacja formatu z JSON (brakujące pola pozostają domyślne).
+	friend void from_json(const json& j, QFormat& q);
+};
+
+/// \class FixedPID
+/// \brief Regulator PID w arytmetyce stałoprzecinkowej.
+///
+/// Działania są takie same jak w PID::sim: błąd, suma błędów i różnica błędu są słowami formatu sygnałów,
+/// nastawy - słowami formatu współczynników. Trzy iloczyny są sumowane w akumulatorze 64-bitowym
+/// i dopiero wynik jest zaokrąglany do formatu sygnałów. Nasycenie sumy błędów działa jak prosta
+/// ochrona przed nasyceniem całki (anti-windup).
+class FixedPID : public SISO
+{
+	QFormat sig; ///< Format sygnałów.
+	QFormat coef; ///< Format nastaw.
+	int64_t P = 0, I = 0, D = 0; ///< Nastawy.
+	int64_t sumerr = 0, lasterr = 0; ///< Suma błędów i ostatni błąd.
+
+public:
+	size_t saturations = 0; ///< Liczba nasyceń (lub zawinięć) od utworzenia regulatora.
+
+	/// \brief Konstruktor klasy FixedPID.
+	/// \param pid Regulator zmiennoprzecinkowy (nastawy i stan są kwantyzowane).
+	/// \param sig Format sygnałów.
+	/// \param coef Format nastaw.
+	/// \throws std::invalid_argument Gdy format jest niepoprawny.
+	FixedPID(const PID& pid, QFormat sig = {}, QFormat coef = {});
+
+	/// \brief Krok regulatora na słowach formatu sygnałów.
+	/// \param err Błąd regulacji (słowo).
+	/// \return Sterowanie (słowo).
+	int64_t step(int64_t err);
+
+	/// \brief Krok regulatora (wejście jest kwantyzowane, wyjście zamieniane na double).
+	/// \param err Błąd regulacji.
+	/// \return Sterowanie.
+	double sim(double err) override;
+
+	/// \brief Zwraca format sygnałów.
+	const QFormat& signalFormat() const { return sig; }
+};
+
+/// \class FixedARX
+/// \brief Model ARX w arytmetyce stałoprzecinkowej.
+///
+/// Historie wejść i wyjść są słowami formatu sygnałów, współczynniki - słowami formatu współczynników.
+/// Iloczyny licznika i mianownika są sumowane w akumulatorze 64-bitowym z nasyceniem, a wynik
+/// jest zaokrąglany do formatu sygnałów; szum ns_var * e jest kwantyzowany do formatu sygnałów.
+class FixedARX : public SISO
+{
+	QFormat sig; ///< Format sygnałów.
+	QFormat coef; ///< Format współczynników.
+	std::vector<int64_t> A; ///< Mianownik modelu.
+	std::vector<int64_t> B; ///< Licznik modelu.
+	unsigned k = 0; ///< Opóźnienie modelu.
+	double ns_var = 0; ///< Amplituda szumu modelu.
+	DelayLineT<int64_t> inBuf; ///< Historia wejść (k + nb słów).
+	DelayLineT<int64_t> outBuf; ///< Historia wyjść (na słów).
+
+public:
+	size_t saturations = 0; ///< Liczba nasyceń (lub zawinięć) od utworzenia modelu.
+
+	/// \brief Konstruktor klasy FixedARX.
+	/// \param arx Model zmiennoprzecinkowy (współczynniki są kwantyzowane, stan początkowy jest zerowy).
+	/// \param sig Format sygnałów.
+	/// \param coef Format współczynników.
+	/// \throws std::invalid_argument Gdy format jest niepoprawny.
+	FixedARX(const ARX& arx, QFormat sig = {}, QFormat coef = {});
+
+	/// \brief Krok modelu na słowach formatu sygnałów.
+	/// \param in Wejście (słowo).
+	/// \param e Próbka szumu (przed skalowaniem przez ns_var).
+	/// \return Wyjście (słowo).
+	int64_t step(int64_t in, double e);
+
+	/// \brief Krok modelu z szumem losowanym przez ARX::getNoise() (jak ARX::sim).
+	/// \param in Wejście.
+	/// \return Wyjście.
+	double sim(double in) override;
+
+	/// \brief Zwraca format sygnałów.
+	const QFormat& signalFormat() const { return sig; }
+};
+
+/// \struct FixedReport
+/// \brief Statystyki odchylenia pętli stałoprzecinkowej od pętli double.
+struct FixedReport
+{
+	size_t steps = 0; ///< Liczba kroków.
+	double maxAbsY = 0; ///< Największe odchylenie wyjścia obiektu.
+	double rmsY = 0; ///< Odchylenie średniokwadratowe wyjścia obiektu.
+	double maxAbsU = 0; ///< Największe odchylenie sterowania.
+	double rmsU = 0; ///< Odchylenie średniokwadratowe sterowania.
+	double maxY = 0; ///< Największy moduł wyjścia pętli double (skala odchyleń).
+	size_t saturations = 0; ///< Liczba nasyceń w regulatorze i modelu.
+
+	/// \brief Wypisuje raport.
+	friend std::ostream& operator<<(std::ostream& os, const FixedReport& r);
+};
+
+/// \brief Symuluje pętlę stałoprzecinkową i pętlę double krok po kroku, bez zapisu przebiegów.
+///
+/// Obie pętle zaczynają od zerowego wyjścia obiektu (jak Simulation::run) i dostają te same sygnały
+/// generatorów oraz próbki szumu ARX. Pętla double jest liczona na kopiach s.arx i s.pid; obiekty
+/// symulacji nie są zmieniane.
+/// \param s Symulacja (model, regulator, generatory i długość).
+/// \param plant Model stałoprzecinkowy (kopiowany).
+/// \param controller Regulator stałoprzecinkowy (kopiowany).
+/// \return Statystyki odchylenia.
+FixedReport validateFixed(Simulation& s, const FixedARX& plant, const FixedPID& controller);
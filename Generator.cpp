@@ -7,6 +7,7 @@
 #include <numbers>
 
 #include <utility>
+#include <algorithm>
 
 #include "json.hpp" ///< Wczytanie biblioteki "json.hpp", która umożliwia serializację i deserializację obiektów JSON.
 using json = nlohmann::json;
@@ -37,6 +38,40 @@ double Generator::get(size_t i)
     return sum;
 }
 
+/**
+ * @brief Wypełnia blok kolejnych próbek wygenerowanego sygnału.
+ *
+ * Każdy sygnał wypełnia blok własną metodą fill (np. rekurencyjną), a wyniki są sumowane z wagami.
+ * Bufor pomocniczy jest powiększany tylko wtedy, gdy blok jest dłuższy niż poprzednie.
+ *
+ * @param i0 Indeks pierwszej próbki bloku.
+ * @param out Bufor wyjściowy.
+ */
+void Generator::fill(size_t i0, std::span<double> out)
+{
+    std::fill(out.begin(), out.end(), 0.0);
+    if (tmp.size() < out.size())
+        tmp.resize(out.size());
+
+    std::span<double> t(tmp.data(), out.size());
+    for (const auto& s : signals) ///< Przechodzi przez każdy sygnał w wektorze sygnałów.
+    {
+        s.second->fill(i0, t);
+        for (size_t n = 0; n < out.size(); ++n)
+            out[n] += s.first * t[n];
+    }
+}
+
+/**
+ * @brief Sprawdza, czy generator nie zawiera żadnych sygnałów.
+ *
+ * @return true, jeśli generator jest pusty.
+ */
+bool Generator::empty() const
+{
+    return signals.empty();
+}
+
 /**
  * @brief Serializacja obiektu klasy Generator do formatu JSON.
  *
@@ -7,6 +7,7 @@
 #include <numbers>
 
 #include <utility>
+#include <span>
 
 #include "json.hpp" ///< Wczytanie biblioteki "json.hpp", która umożliwia serializację i deserializację obiektów JSON.
 using json = nlohmann::json;
@@ -20,6 +21,7 @@ class Generator
 	using Signals = std::vector<std::pair<double, SignalHdl>>; ///< Typ reprezentujący kolekcję sygnałów.
 
 	Signals signals; ///< Kolekcja sygnałów.
+	std::vector<double> tmp; ///< Bufor pomocniczy dla generowania blokowego.
 
 public:
 	/// \brief Konstruktor domyślny klasy Generator.
@@ -28,6 +30,15 @@ public:
 	/// \brief Wirtualny destruktor klasy Generator.
 	~Generator() = default;
 
+	/// \brief Konstruktor kopiujący klasy Generator (kopia współdzieli niezmienne sygnały).
+	/// \param other Obiekt Generator, który ma zostać skopiowany.
+	Generator(const Generator&) = default;
+
+	/// \brief Operator przypisania kopiującego dla klasy Generator (kopia współdzieli niezmienne sygnały).
+	/// \param other Obiekt Generator, który ma zostać skopiowany.
+	/// \return Referencja do obiektu Generator po przypisaniu.
+	Generator& operator=(const Generator&) = default;
+
 	/// \brief Konstruktor przenoszący klasy Generator.
 	/// \param other Obiekt Generator, który ma zostać przeniesiony.
 	Generator(Generator&&) = default;
@@ -47,6 +58,15 @@ public:
 	/// \return Wartość wygenerowanego sygnału dla podanego indeksu.
 	double get(size_t);
 
+	/// \brief Wypełnia blok kolejnych próbek wygenerowanego sygnału.
+	/// \param i0 Indeks pierwszej próbki bloku.
+	/// \param out Bufor, do którego zostaną zapisane próbki o indeksach i0, i0 + 1, ...
+	void fill(size_t, std::span<double>);
+
+	/// \brief Sprawdza, czy generator nie zawiera żadnych sygnałów.
+	/// \return true, jeśli generator jest pusty (generuje same zera).
+	bool empty() const;
+
 	/// \brief Serializacja obiektu klasy Generator do formatu JSON.
 	/// \param j Obiekt JSON, do którego będą zapisywane dane.
 	/// \param g Obiekt Generator, który będzie serializowany.
@@ -0,0 +1,615 @@
+/// \file Identification.h
+/// \brief Zawiera implementację funkcji identyfikacji modeli.
+
+#include "Identification.h"
+#include "LinAlg.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	using Vec = std::vector<double>;
+
+	/// Względna zmiana parametrów, poniżej której iteracje regresji pseudoliniowej są przerywane.
+	constexpr double PLR_TOL = 1e-9;
+
+	/**
+	 * @brief Próbka sygnału z zerami przed początkiem rekordu.
+	 * @param x Sygnał.
+	 * @param t Indeks (może być ujemny).
+	 * @return x[t] lub 0 dla t < 0.
+	 */
+	double at(std::span<const double> x, ptrdiff_t t)
+	{
+		return t < 0 ? 0 : x[t];
+	}
+
+	/**
+	 * @brief Rozwiązuje zadanie najmniejszych kwadratów dla regresorów budowanych funkcją phi.
+	 * @tparam Phi Typ funkcji wypełniającej regresor dla chwili t.
+	 * @param y Sygnał wyjściowy.
+	 * @param t0 Pierwsza chwila użyta w regresji.
+	 * @param n Liczba parametrów.
+	 * @param phi Funkcja wypełniająca regresor.
+	 * @return Wektor parametrów.
+	 */
+	template <typename Phi>
+	Vec leastSquares(std::span<const double> y, size_t t0, size_t n, Phi phi)
+	{
+		Matrix R(n, n);
+		Vec r(n), f(n);
+		for (size_t t = t0; t < y.size(); ++t)
+		{
+			phi(t, f);
+			for (size_t i = 0; i < n; ++i)
+			{
+				r[i] += f[i] * y[t];
+				double* Ri = R.row(i);
+				for (size_t j = 0; j <= i; ++j)
+					Ri[j] += f[i] * f[j];
+			}
+		}
+		for (size_t i = 0; i < n; ++i)
+			for (size_t j = 0; j < i; ++j)
+				R(j, i) = R(i, j);
+
+		return solveSPD(R, r);
+	}
+
+	/**
+	 * @brief Względna zmiana wektora parametrów między iteracjami.
+	 * @param a Poprzednia estymata.
+	 * @param b Bieżąca estymata.
+	 * @return ||a - b|| / (||b|| + 1e-300).
+	 */
+	double relChange(const Vec& a, const Vec& b)
+	{
+		double d = 0, n = 0;
+		for (size_t i = 0; i < b.size(); ++i)
+		{
+			d += (a[i] - b[i]) * (a[i] - b[i]);
+			n += b[i] * b[i];
+		}
+		return std::sqrt(d / (n + 1e-300));
+	}
+
+	/**
+	 * @brief Odchylenie standardowe sygnału od chwili t0.
+	 * @param e Sygnał.
+	 * @param t0 Pierwsza uwzględniana chwila.
+	 * @return Pierwiastek ze średniej kwadratów.
+	 */
+	double rms(const Vec& e, size_t t0)
+	{
+		double s = 0;
+		for (size_t t = t0; t < e.size(); ++t)
+			s += e[t] * e[t];
+		return e.size() > t0 ? std::sqrt(s / (e.size() - t0)) : 0;
+	}
+
+	/**
+	 * @brief Wycina fragment wektora parametrów jako valarray.
+	 * @param th Wektor parametrów.
+	 * @param off Początek fragmentu.
+	 * @param n Długość fragmentu.
+	 * @return Fragment wektora.
+	 */
+	std::valarray<double> part(const Vec& th, size_t off, size_t n)
+	{
+		return std::valarray<double>(th.data() + off, n);
+	}
+
+	/**
+	 * @brief Sprawdza zgodność długości danych.
+	 * @param u Sygnał wejściowy.
+	 * @param y Sygnał wyjściowy.
+	 */
+	void checkData(std::span<const double> u, std::span<const double> y)
+	{
+		if (u.size() != y.size())
+			throw std::invalid_argument("Input and output records differ in length!");
+	}
+}
+
+/**
+ * @brief Identyfikuje model ARX metodą najmniejszych kwadratów.
+ * @param u Sygnał wejściowy.
+ * @param y Sygnał wyjściowy.
+ * @param na Rząd mianownika A.
+ * @param nb Liczba współczynników licznika B.
+ * @param k Opóźnienie.
+ * @return Zidentyfikowany model.
+ */
+ARX identifyARX(std::span<const double> u, std::span<const double> y, size_t na, size_t nb, unsigned k)
+{
+	checkData(u, y);
+	const size_t t0 = std::max(na, nb + k);
+	const size_t n = na + nb;
+
+	auto phi = [&](size_t t, Vec& f)
+	{
+		for (size_t j = 0; j < na; ++j)
+			f[j] = -at(y, t - 1 - j);
+		for (size_t j = 0; j < nb; ++j)
+			f[na + j] = at(u, t - k - j);
+	};
+	Vec th = leastSquares(y, t0, n, phi);
+
+	Vec e(y.size());
+	Vec f(n);
+	for (size_t t = t0; t < y.size(); ++t)
+	{
+		phi(t, f);
+		e[t] = y[t];
+		for (size_t i = 0; i < n; ++i)
+			e[t] -= f[i] * th[i];
+	}
+
+	/// Model jest budowany przez format JSON, tak samo jak przy wczytywaniu z pliku
+	json j;
+	j["A"] = part(th, 0, na);
+	j["B"] = part(th, na, nb);
+	j["k"] = k;
+	j["ns_var"] = rms(e, t0);
+	return j.get<ARX>();
+}
+
+/**
+ * @brief Identyfikuje model ARMAX iteracyjną regresją pseudoliniową.
+ *
+ * Regresor ma postać [-y(t-1..na), u(t-k..), eps(t-1..nc)], gdzie eps to residua z poprzedniej iteracji.
+ * Pierwsza iteracja (eps = 0) jest zwykłą estymatą ARX.
+ * @param u Sygnał wejściowy.
+ * @param y Sygnał wyjściowy.
+ * @param na Rząd mianownika A.
+ * @param nb Liczba współczynników licznika B.
+ * @param nc Rząd filtru szumu C.
+ * @param k Opóźnienie.
+ * @param iters Maksymalna liczba iteracji.
+ * @return Zidentyfikowany model.
+ */
+ARMAX identifyARMAX(std::span<const double> u, std::span<const double> y, size_t na, size_t nb, size_t nc, unsigned k, size_t iters)
+{
+	checkData(u, y);
+	const size_t t0 = std::max({ na, nb + k, nc });
+	const size_t n = na + nb + nc;
+
+	Vec eps(y.size()), th(n), prev;
+	std::span<const double> es(eps);
+
+	auto phi = [&](size_t t, Vec& f)
+	{
+		for (size_t j = 0; j < na; ++j)
+			f[j] = -at(y, t - 1 - j);
+		for (size_t j = 0; j < nb; ++j)
+			f[na + j] = at(u, t - k - j);
+		for (size_t j = 0; j < nc; ++j)
+			f[na + nb + j] = at(es, t - 1 - j);
+	};
+
+	Vec f(n);
+	for (size_t it = 0; it < iters; ++it)
+	{
+		prev = th;
+		th = leastSquares(y, t0, n, phi);
+
+		/// Odtworzenie residuów z nową estymatą (rekurencyjnie - eps(t) zależy od eps(t-1..))
+		for (size_t t = t0; t < y.size(); ++t)
+		{
+			phi(t, f);
+			double p = 0;
+			for (size_t i = 0; i < n; ++i)
+				p += f[i] * th[i];
+			eps[t] = y[t] - p;
+		}
+
+		if (it && relChange(prev, th) < PLR_TOL)
+			break;
+	}
+
+	return ARMAX(part(th, 0, na), part(th, na, nb), part(th, na + nb, nc), k, rms(eps, t0));
+}
+
+namespace
+{
+	/**
+	 * @brief Identyfikuje model błędu wyjścia (OE) metodą Steiglitza-McBride'a.
+	 *
+	 * W każdej iteracji wejście i wyjście są filtrowane przez 1/F z poprzedniej estymaty, a parametry B i F
+	 * wyznaczane są regresją liniową jak dla modelu ARX. W przeciwieństwie do prostej regresji pseudoliniowej
+	 * dla OE metoda ta nie wymaga warunku ścisłej dodatniej rzeczywistości 1/F i stabilnie zbiega.
+	 * @param u Sygnał wejściowy.
+	 * @param y Sygnał wyjściowy.
+	 * @param nb Liczba współczynników licznika B.
+	 * @param nf Rząd mianownika F.
+	 * @param k Opóźnienie.
+	 * @param iters Maksymalna liczba iteracji.
+	 * @return Zidentyfikowany model.
+	 */
+	BJ identifyOE(std::span<const double> u, std::span<const double> y, size_t nb, size_t nf, unsigned k, size_t iters)
+	{
+		const size_t N = y.size();
+		const size_t t0 = std::max(nb + k, nf);
+		const size_t n = nb + nf;
+
+		Vec uf(u.begin(), u.end()), yf(y.begin(), y.end()), th(n), prev;
+		std::span<const double> us(uf), ys(yf);
+
+		auto phi = [&](size_t t, Vec& f)
+		{
+			for (size_t j = 0; j < nb; ++j)
+				f[j] = at(us, t - k - j);
+			for (size_t j = 0; j < nf; ++j)
+				f[nb + j] = -at(ys, t - 1 - j);
+		};
+
+		for (size_t it = 0; it < iters; ++it)
+		{
+			prev = th;
+			th = leastSquares(ys, t0, n, phi);
+
+			/// Filtracja danych przez 1/F z nowej estymaty
+			const double* F = th.data() + nb;
+			for (size_t t = 0; t < N; ++t)
+			{
+				double a = u[t], b = y[t];
+				for (size_t j = 0; j < nf; ++j)
+				{
+					a -= F[j] * at(us, t - 1 - j);
+					b -= F[j] * at(ys, t - 1 - j);
+				}
+				uf[t] = a;
+				yf[t] = b;
+			}
+
+			if (it && relChange(prev, th) < PLR_TOL)
+				break;
+		}
+
+		/// Residua modelu OE: e = y - B/F u
+		Vec w(N);
+		std::span<const double> wsp(w);
+		for (size_t t = 0; t < N; ++t)
+		{
+			double wt = 0;
+			for (size_t j = 0; j < nb; ++j)
+				wt += th[j] * at(u, t - k - j);
+			for (size_t j = 0; j < nf; ++j)
+				wt -= th[nb + j] * at(wsp, t - 1 - j);
+			w[t] = wt;
+		}
+		for (size_t t = 0; t < N; ++t)
+			w[t] = y[t] - w[t];
+
+		return BJ(part(th, 0, nb), part(th, nb, nf), {}, {}, k, rms(w, t0));
+	}
+}
+
+/**
+ * @brief Identyfikuje model Boxa-Jenkinsa iteracyjną regresją pseudoliniową (dla nc = nd = 0 - model OE metodą Steiglitza-McBride'a).
+ *
+ * Regresor ma postać [u(t-k..), -w(t-1..nf), eps(t-1..nc), -v(t-1..nd)], gdzie w = B/F u to symulowana
+ * część deterministyczna, v = y - w to szum, a eps = D/C v to odtworzone innowacje.
+ * W pierwszej iteracji w = y (estymata typu ARX), v = eps = 0.
+ * @param u Sygnał wejściowy.
+ * @param y Sygnał wyjściowy.
+ * @param nb Liczba współczynników licznika B.
+ * @param nf Rząd mianownika F.
+ * @param nc Rząd licznika filtru szumu C.
+ * @param nd Rząd mianownika filtru szumu D.
+ * @param k Opóźnienie.
+ * @param iters Maksymalna liczba iteracji.
+ * @return Zidentyfikowany model.
+ */
+BJ identifyBJ(std::span<const double> u, std::span<const double> y, size_t nb, size_t nf, size_t nc, size_t nd, unsigned k, size_t iters)
+{
+	checkData(u, y);
+	if (nc == 0 && nd == 0)
+		return identifyOE(u, y, nb, nf, k, iters);
+
+	const size_t N = y.size();
+	const size_t t0 = std::max({ nb + k, nf, nc, nd });
+	const size_t n = nb + nf + nc + nd;
+
+	Vec w(y.begin(), y.end()), v(N), eps(N), th(n), prev;
+	std::span<const double> ws(w), vs(v), es(eps);
+
+	auto phi = [&](size_t t, Vec& f)
+	{
+		for (size_t j = 0; j < nb; ++j)
+			f[j] = at(u, t - k - j);
+		for (size_t j = 0; j < nf; ++j)
+			f[nb + j] = -at(ws, t - 1 - j);
+		for (size_t j = 0; j < nc; ++j)
+			f[nb + nf + j] = at(es, t - 1 - j);
+		for (size_t j = 0; j < nd; ++j)
+			f[nb + nf + nc + j] = -at(vs, t - 1 - j);
+	};
+
+	for (size_t it = 0; it < iters; ++it)
+	{
+		prev = th;
+		th = leastSquares(y, t0, n, phi);
+
+		const double* B = th.data();
+		const double* F = B + nb;
+		const double* C = F + nf;
+		const double* D = C + nc;
+
+		/// Symulacja części deterministycznej, szumu i innowacji z nową estymatą
+		for (size_t t = 0; t < N; ++t)
+		{
+			double wt = 0;
+			for (size_t j = 0; j < nb; ++j)
+				wt += B[j] * at(u, t - k - j);
+			for (size_t j = 0; j < nf; ++j)
+				wt -= F[j] * at(ws, t - 1 - j);
+			w[t] = wt;
+			v[t] = y[t] - wt;
+
+			double et = v[t];
+			for (size_t j = 0; j < nd; ++j)
+				et += D[j] * at(vs, t - 1 - j);
+			for (size_t j = 0; j < nc; ++j)
+				et -= C[j] * at(es, t - 1 - j);
+			eps[t] = et;
+		}
+
+		if (!std::isfinite(rms(eps, t0)))
+			throw std::runtime_error("Pseudo-linear regression diverged (unstable F or C estimate)!");
+		if (it && relChange(prev, th) < PLR_TOL)
+			break;
+	}
+
+	return BJ(part(th, 0, nb), part(th, nb, nf), part(th, nb + nf, nc), part(th, nb + nf + nc, nd), k, rms(eps, t0));
+}
+
+/**
+ * @brief Strata błędu wyjścia modelu w postaci ARX i jej gradient metodą sprzężoną.
+ *
+ * Przejście w przód zapisuje na początku każdego segmentu (checkpoint chwil) na ostatnich predykcji.
+ * Przejście wstecz przetwarza segmenty od końca: odtwarza predykcje segmentu z punktu kontrolnego
+ * do bufora, a następnie liczy zmienne sprzężone i akumuluje gradient
+ * dV/dB_j = sum lambda(t) u(t-k-j), dV/dA_j = -sum lambda(t) yh(t-1-j).
+ * @param u Sygnał wejściowy.
+ * @param y Sygnał wyjściowy.
+ * @param A Mianownik modelu.
+ * @param B Licznik modelu.
+ * @param k Opóźnienie.
+ * @param grad Gradient lub pusty zakres.
+ * @param checkpoint Odstęp punktów kontrolnych.
+ * @return Strata.
+ */
+double pemLoss(std::span<const double> u, std::span<const double> y, std::span<const double> A, std::span<const double> B, unsigned k, std::span<double> grad, size_t checkpoint)
+{
+	checkData(u, y);
+	const size_t N = y.size(), na = A.size(), nb = B.size();
+	if (!grad.empty() && grad.size() != na + nb)
+		throw std::invalid_argument("Gradient size does not match the model!");
+	if (!N)
+		return 0;
+
+	const size_t C = checkpoint ? checkpoint : size_t(std::ceil(std::sqrt(double(N))));
+	const size_t S = (N + C - 1) / C;
+
+	/// Predykcja w chwili t z historii hist (hist[j] = yh(t-1-j))
+	auto predict = [&](size_t t, const double* hist)
+	{
+		double v = 0;
+		for (size_t j = 0; j < nb; ++j)
+			v += B[j] * at(u, t - k - j);
+		for (size_t j = 0; j < na; ++j)
+			v -= A[j] * hist[j];
+		return v;
+	};
+
+	/// Przejście w przód: strata i punkty kontrolne
+	Vec ckpt(grad.empty() ? 0 : S * na);
+	DelayLine hist(na);
+	double V = 0;
+	for (size_t t = 0; t < N; ++t)
+	{
+		if (!grad.empty() && t % C == 0)
+			std::copy(hist.data(), hist.data() + na, ckpt.begin() + (t / C) * na);
+		const double yh = predict(t, hist.data());
+		hist.push(yh);
+		V += (y[t] - yh) * (y[t] - yh);
+	}
+	V /= 2 * N;
+	if (!std::isfinite(V))
+		return std::numeric_limits<double>::infinity();
+	if (grad.empty())
+		return V;
+
+	/// Przejście wstecz po segmentach od końca
+	std::fill(grad.begin(), grad.end(), 0.0);
+	Vec seg(na + C); ///< [historia segmentu od najstarszej, predykcje segmentu]
+	DelayLine lam(na); ///< lam[j] = lambda(t+1+j)
+	for (size_t s = S; s-- > 0;)
+	{
+		const size_t t0 = s * C, len = std::min(C, N - t0);
+		DelayLine h(na);
+		for (size_t j = na; j-- > 0;)
+			h.push(ckpt[s * na + j]);
+		for (size_t j = 0; j < na; ++j)
+			seg[j] = ckpt[s * na + na - 1 - j];
+		for (size_t i = 0; i < len; ++i)
+		{
+			seg[na + i] = predict(t0 + i, h.data());
+			h.push(seg[na + i]);
+		}
+
+		for (size_t i = len; i-- > 0;)
+		{
+			const size_t t = t0 + i;
+			double l = -(y[t] - seg[na + i]) / N;
+			for (size_t j = 0; j < na; ++j)
+				l -= A[j] * lam[j];
+			for (size_t j = 0; j < na; ++j)
+				grad[j] -= l * seg[na + i - 1 - j];
+			for (size_t j = 0; j < nb; ++j)
+				grad[na + j] += l * at(u, t - k - j);
+			lam.push(l);
+		}
+	}
+	return V;
+}
+
+namespace
+{
+	/**
+	 * @brief Minimalizuje funkcję metodą BFGS z cofaniem (warunek Armijo).
+	 * @tparam F Typ funkcji f(x, grad) zwracającej wartość i wypełniającej gradient.
+	 * @param x Punkt startowy (zastępowany punktem końcowym).
+	 * @param f Minimalizowana funkcja.
+	 * @param iters Maksymalna liczba iteracji.
+	 * @param gtol Próg zbieżności gradientu.
+	 * @param st Statystyki (V0, V, iterations).
+	 */
+	template <typename F>
+	void bfgs(Vec& x, F f, size_t iters, double gtol, PEMStats& st)
+	{
+		constexpr double ARMIJO = 1e-4;
+		constexpr size_t MAX_BACKTRACK = 40;
+		const size_t n = x.size();
+
+		Vec g(n), gn(n), xn(n), p(n), sv(n), yv(n), Hy(n);
+		double V = f(x, g);
+		st.V0 = V;
+		if (!std::isfinite(V))
+			throw std::invalid_argument("Initial model gives an unstable predictor!");
+
+		auto normInf = [](const Vec& v)
+		{
+			double m = 0;
+			for (double a : v)
+				m = std::max(m, std::abs(a));
+			return m;
+		};
+
+		Matrix H = Matrix::identity(n);
+		for (; st.iterations < iters && normInf(g) > gtol * (1 + V); st.iterations++)
+		{
+			p = H * g;
+			double slope = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				p[i] = -p[i];
+				slope += g[i] * p[i];
+			}
+			if (!st.iterations)
+			{
+				const double scale = 0.01 * std::max(1.0, normInf(x)) / normInf(p);
+				for (double& v : p)
+					v *= scale;
+				slope *= scale;
+			}
+			if (slope >= 0)
+			{
+				H = Matrix::identity(n);
+				slope = 0;
+				for (size_t i = 0; i < n; ++i)
+				{
+					p[i] = -g[i];
+					slope -= g[i] * g[i];
+				}
+			}
+
+			double alpha = 1, Vn = 0;
+			size_t bt = 0;
+			for (; bt < MAX_BACKTRACK; ++bt, alpha *= 0.5)
+			{
+				for (size_t i = 0; i < n; ++i)
+					xn[i] = x[i] + alpha * p[i];
+				Vn = f(xn, gn);
+				if (std::isfinite(Vn) && Vn <= V + ARMIJO * alpha * slope)
+					break;
+			}
+			if (bt == MAX_BACKTRACK)
+				break;
+
+			double ys = 0, yy = 0, ss = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				sv[i] = xn[i] - x[i];
+				yv[i] = gn[i] - g[i];
+				ys += yv[i] * sv[i];
+				yy += yv[i] * yv[i];
+				ss += sv[i] * sv[i];
+			}
+			if (ys > 1e-12 * std::sqrt(yy * ss))
+			{
+				if (!st.iterations)
+					for (size_t i = 0; i < n; ++i)
+						H(i, i) = ys / yy;
+				const double rho = 1 / ys;
+				Hy = H * yv;
+				double yHy = 0;
+				for (size_t i = 0; i < n; ++i)
+					yHy += yv[i] * Hy[i];
+				for (size_t i = 0; i < n; ++i)
+					for (size_t j = 0; j < n; ++j)
+						H(i, j) += (1 + rho * yHy) * rho * sv[i] * sv[j] - rho * (Hy[i] * sv[j] + sv[i] * Hy[j]);
+			}
+
+			const bool stalled = V - Vn <= 1e-15 * std::abs(V);
+			x.swap(xn);
+			g.swap(gn);
+			V = Vn;
+			if (stalled)
+			{
+				st.iterations++;
+				break;
+			}
+		}
+		st.V = V;
+	}
+}
+
+/**
+ * @brief Identyfikuje model błędu wyjścia w postaci ARX metodą błędu predykcji.
+ * @param u Sygnał wejściowy.
+ * @param y Sygnał wyjściowy.
+ * @param na Rząd mianownika A.
+ * @param nb Liczba współczynników licznika B.
+ * @param k Opóźnienie.
+ * @param opt Parametry identyfikacji.
+ * @param stats Opcjonalne statystyki.
+ * @return Zidentyfikowany model.
+ */
+ARX identifyPEM(std::span<const double> u, std::span<const double> y, size_t na, size_t nb, unsigned k, const PEMOptions& opt, PEMStats* stats)
+{
+	checkData(u, y);
+	const size_t N = y.size();
+
+	/// Punkt startowy - estymata Steiglitza-McBride'a
+	const json start = identifyOE(u, y, nb, na, k, 20);
+	Vec th;
+	for (double a : start["F"])
+		th.push_back(a);
+	for (double b : start["B"])
+		th.push_back(b);
+
+	PEMStats st;
+	const size_t C = opt.checkpoint ? opt.checkpoint : size_t(std::ceil(std::sqrt(double(std::max<size_t>(N, 1)))));
+	st.memory = ((N + C - 1) / C) * na + C + 2 * na;
+	auto f = [&](const Vec& x, Vec& g)
+	{
+		st.evaluations++;
+		return pemLoss(u, y, std::span(x).first(na), std::span(x).subspan(na), k, g, C);
+	};
+	bfgs(th, f, opt.iters, opt.gtol, st);
+	if (stats)
+		*stats = st;
+
+	json j;
+	j["A"] = part(th, 0, na);
+	j["B"] = part(th, na, nb);
+	j["k"] = k;
+	j["ns_var"] = std::sqrt(2 * st.V);
+	return j.get<ARX>();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "ARX.h"
+#include "ARMAX.h"
+#include "BJ.h"
+
+#include <span>
+
+/// \file Identification.h
+/// \brief Zawiera funkcje identyfikacji modeli ARX, ARMAX, BJ (OE) i OE metodą błędu predykcji na podstawie danych pomiarowych.
+///
+/// Model ARX jest wyznaczany metodą najmniejszych kwadratów. Modele ARMAX i BJ są wyznaczane
+/// iteracyjną regresją pseudoliniową: nieznane sygnały pomocnicze (residua, część deterministyczna,
+/// kolorowany szum) są odtwarzane na podstawie bieżącej estymaty i ponownie wstawiane do regresora,
+/// aż do ustalenia się parametrów. Każda iteracja to jedno przejście po danych i rozwiązanie
+/// równań normalnych, dzięki czemu identyfikacja jest szybka również dla długich rekordów.
+
+/// \brief Identyfikuje model ARX metodą najmniejszych kwadratów.
+/// \param u Sygnał wejściowy.
+/// \param y Sygnał wyjściowy.
+/// \param na Rząd mianownika A.
+/// \param nb Liczba współczynników licznika B.
+/// \param k Opóźnienie.
+/// \return Zidentyfikowany model (ns_var to odchylenie standardowe residuów).
+ARX identifyARX(std::span<const double> u, std::span<const double> y, size_t na, size_t nb, unsigned k);
+
+/// \brief Identyfikuje model ARMAX iteracyjną regresją pseudoliniową (rozszerzona metoda najmniejszych kwadratów).
+/// \param u Sygnał wejściowy.
+/// \param y Sygnał wyjściowy.
+/// \param na Rząd mianownika A.
+/// \param nb Liczba współczynników licznika B.
+/// \param nc Rząd filtru szumu C.
+/// \param k Opóźnienie.
+/// \param iters Maksymalna liczba iteracji. Domyślnie 20.
+/// \return Zidentyfikowany model.
+ARMAX identifyARMAX(std::span<const double> u, std::span<const double> y, size_t na, size_t nb, size_t nc, unsigned k, size_t iters = 20);
+
+/// \brief Identyfikuje model Boxa-Jenkinsa iteracyjną regresją pseudoliniową.
+///
+/// Dla nc = nd = 0 identyfikowany jest model błędu wyjścia (OE) metodą Steiglitza-McBride'a (iteracyjne filtrowanie danych przez 1/F).
+/// \param u Sygnał wejściowy.
+/// \param y Sygnał wyjściowy.
+/// \param nb Liczba współczynników licznika B.
+/// \param nf Rząd mianownika F.
+/// \param nc Rząd licznika filtru szumu C.
+/// \param nd Rząd mianownika filtru szumu D.
+/// \param k Opóźnienie.
+/// \param iters Maksymalna liczba iteracji. Domyślnie 20.
+/// \return Zidentyfikowany model.
+BJ identifyBJ(std::span<const double> u, std::span<const double> y, size_t nb, size_t nf, size_t nc, size_t nd, unsigned k, size_t iters = 20);
+
+/// \struct PEMOptions
+/// \brief Parametry identyfikacji metodą błędu predykcji (PEM).
+struct PEMOptions
+{
+	size_t iters = 200; ///< Maksymalna liczba iteracji BFGS.
+	size_t checkpoint = 0; ///< Odstęp punktów kontrolnych przejścia wstecznego (0 - ceil(sqrt(N))).
+	double gtol = 1e-10; ///< Próg zbieżności: max |dV/dtheta| <= gtol * (1 + V).
+};
+
+/// \struct PEMStats
+/// \brief Statystyki identyfikacji metodą błędu predykcji.
+struct PEMStats
+{
+	double V0 = 0; ///< Strata modelu początkowego.
+	double V = 0; ///< Strata modelu końcowego.
+	size_t iterations = 0; ///< Liczba iteracji BFGS.
+	size_t evaluations = 0; ///< Liczba wyznaczeń straty i gradientu (przejście w przód i wstecz).
+	size_t memory = 0; ///< Liczba liczb przechowywanych przez przejście wsteczne (punkty kontrolne i bufor segmentu).
+};
+
+/// \brief Strata błędu wyjścia modelu w postaci ARX i jej gradient metodą sprzężoną (adjoint).
+///
+/// Predykcja jest symulacją modelu: yh(t) = sum B_j u(t-k-j) - sum A_j yh(t-1-j) (od zerowego stanu),
+/// a strata V = sum (y(t) - yh(t))^2 / (2N). Gradient względem wszystkich współczynników wymaga jednego
+/// przejścia w przód (strata i punkty kontrolne stanu co checkpoint chwil) i jednego przejścia wstecz
+/// (zmienne sprzężone lambda(t) = -e(t)/N - sum A_j lambda(t+1+j)); segmenty między punktami
+/// kontrolnymi są odtwarzane z punktów, więc pamięć rośnie jak N / checkpoint + checkpoint zamiast N.
+/// \param u Sygnał wejściowy.
+/// \param y Sygnał wyjściowy.
+/// \param A Mianownik modelu.
+/// \param B Licznik modelu.
+/// \param k Opóźnienie.
+/// \param grad Gradient [dV/dA, dV/dB] (na + nb wartości) lub pusty zakres - tylko strata.
+/// \param checkpoint Odstęp punktów kontrolnych (0 - ceil(sqrt(N))).
+/// \return Strata (+inf, gdy predykcja przestaje być skończona; gradient nie jest wtedy wyznaczany).
+/// \throws std::invalid_argument Gdy długości danych lub gradientu są niepoprawne.
+double pemLoss(std::span<const double> u, std::span<const double> y, std::span<const double> A, std::span<const double> B, unsigned k, std::span<double> grad = {}, size_t checkpoint = 0);
+
+/// \brief Identyfikuje model błędu wyjścia w postaci ARX metodą błędu predykcji.
+///
+/// Punktem startowym jest estymata Steiglitza-McBride'a (identifyBJ z nc = nd = 0), a strata pemLoss
+/// jest minimalizowana metodą BFGS z gradientem sprzężonym. Model jest zwracany w formacie klasy ARX
+/// (A = F, ns_var to odchylenie standardowe błędu wyjścia) i zapisuje się do JSON tak jak każdy obiekt ARX.
+/// \param u Sygnał wejściowy.
+/// \param y Sygnał wyjściowy.
+/// \param na Rząd mianownika A.
+/// \param nb Liczba współczynników licznika B.
+/// \param k Opóźnienie.
+/// \param opt Parametry identyfikacji.
+/// \param stats Opcjonalne statystyki.
+/// \return Zidentyfikowany model.
+ARX identifyPEM(std::span<const double> u, std::span<const double> y, size_t na, size_t nb, unsigned k, const PEMOptions& opt = {}, PEMStats* stats = nullptr);
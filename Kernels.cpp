@@ -0,0 +1,362 @@
+/// \file Kernels.cpp
+/// \brief Zawiera implementację wektoryzowanych jąder obliczeniowych i wyboru zestawu instrukcji.
+
+#include "Kernels.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define KERNEL_TARGET(isa) __attribute__((target(isa)))
+/// Bariera uniemożliwiająca kompilatorowi scalenie iloczynu z następnym dodawaniem w FMA (tryb deterministyczny).
+#define KERNEL_NO_CONTRACT(v) __asm__("" : "+v"(v))
+#else
+#define KERNEL_TARGET(isa)
+#define KERNEL_NO_CONTRACT(v) (void)(v)
+#endif
+
+namespace
+{
+	using DotFn = double (*)(const double*, const double*, size_t);
+
+	/// \brief Redukcja 8 akumulatorów w stałej kolejności (wspólna dla wszystkich jąder deterministycznych).
+	double reduce8(const double* s)
+	{
+		double t0 = s[0] + s[4], t1 = s[1] + s[5], t2 = s[2] + s[6], t3 = s[3] + s[7];
+		return (t0 + t2) + (t1 + t3);
+	}
+
+	/// \brief Przepisuje końcówkę (n < 8 elementów) do bufora dopełnionego zerami.
+	void tail8(const double* a, const double* b, size_t n, double* ta, double* tb)
+	{
+		std::fill(ta, ta + KERNEL_PAD, 0.0);
+		std::fill(tb, tb + KERNEL_PAD, 0.0);
+		std::copy(a, a + n, ta);
+		std::copy(b, b + n, tb);
+	}
+
+	double dotScalar(const double* a, const double* b, size_t n)
+	{
+		double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+		{
+			s0 += a[i] * b[i];
+			s1 += a[i + 1] * b[i + 1];
+			s2 += a[i + 2] * b[i + 2];
+			s3 += a[i + 3] * b[i + 3];
+		}
+		for (; i < n; ++i)
+			s0 += a[i] * b[i];
+		return (s0 + s2) + (s1 + s3);
+	}
+
+	/// Na procesorach bez SSE2 kompilator mógłby scalić mnożenie i dodawanie (FMA), dlatego
+	/// iloczyn jest zapisywany do zmiennej volatile przed dodaniem.
+	double dotScalarDet(const double* a, const double* b, size_t n)
+	{
+		double s[KERNEL_PAD] = {};
+		for (size_t i = 0; i < n; ++i)
+		{
+			volatile double p = a[i] * b[i];
+			s[i % KERNEL_PAD] += p;
+		}
+		return reduce8(s);
+	}
+
+#ifdef KERNELS_X86
+	KERNEL_TARGET("sse2")
+	double dotSSE2(const double* a, const double* b, size_t n)
+	{
+		__m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+			s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+			s2 = _mm_add_pd(s2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+			s3 = _mm_add_pd(s3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6)));
+		}
+		alignas(16) double s[2];
+		_mm_store_pd(s, _mm_add_pd(_mm_add_pd(s0, s2), _mm_add_pd(s1, s3)));
+		double r = s[0] + s[1];
+		for (; i < n; ++i)
+			r += a[i] * b[i];
+		return r;
+	}
+
+	KERNEL_TARGET("sse2")
+	double dotSSE2Det(const double* a, const double* b, size_t n)
+	{
+		__m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+		alignas(16) double ta[KERNEL_PAD], tb[KERNEL_PAD];
+		for (size_t i = 0; i < n; i += KERNEL_PAD)
+		{
+			const double* pa = a + i;
+			const double* pb = b + i;
+			if (i + KERNEL_PAD > n)
+			{
+				tail8(pa, pb, n - i, ta, tb);
+				pa = ta;
+				pb = tb;
+			}
+			__m128d p0 = _mm_mul_pd(_mm_loadu_pd(pa), _mm_loadu_pd(pb));
+			__m128d p1 = _mm_mul_pd(_mm_loadu_pd(pa + 2), _mm_loadu_pd(pb + 2));
+			__m128d p2 = _mm_mul_pd(_mm_loadu_pd(pa + 4), _mm_loadu_pd(pb + 4));
+			__m128d p3 = _mm_mul_pd(_mm_loadu_pd(pa + 6), _mm_loadu_pd(pb + 6));
+			KERNEL_NO_CONTRACT(p0);
+			KERNEL_NO_CONTRACT(p1);
+			KERNEL_NO_CONTRACT(p2);
+			KERNEL_NO_CONTRACT(p3);
+			s0 = _mm_add_pd(s0, p0);
+			s1 = _mm_add_pd(s1, p1);
+			s2 = _mm_add_pd(s2, p2);
+			s3 = _mm_add_pd(s3, p3);
+		}
+		alignas(16) double s[KERNEL_PAD];
+		_mm_store_pd(s, s0);
+		_mm_store_pd(s + 2, s1);
+		_mm_store_pd(s + 4, s2);
+		_mm_store_pd(s + 6, s3);
+		return reduce8(s);
+	}
+
+	KERNEL_TARGET("avx2,fma")
+	double dotAVX2(const double* a, const double* b, size_t n)
+	{
+		__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+		{
+			s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+			s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), s1);
+			s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8), s2);
+			s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12), s3);
+		}
+		for (; i + 4 <= n; i += 4)
+			s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+		__m256d s = _mm256_add_pd(_mm256_add_pd(s0, s2), _mm256_add_pd(s1, s3));
+		__m128d h = _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+		double r = _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+		for (; i < n; ++i)
+			r += a[i] * b[i];
+		return r;
+	}
+
+	KERNEL_TARGET("avx2")
+	double dotAVX2Det(const double* a, const double* b, size_t n)
+	{
+		__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+		alignas(32) double ta[KERNEL_PAD], tb[KERNEL_PAD];
+		for (size_t i = 0; i < n; i += KERNEL_PAD)
+		{
+			const double* pa = a + i;
+			const double* pb = b + i;
+			if (i + KERNEL_PAD > n)
+			{
+				tail8(pa, pb, n - i, ta, tb);
+				pa = ta;
+				pb = tb;
+			}
+			__m256d p0 = _mm256_mul_pd(_mm256_loadu_pd(pa), _mm256_loadu_pd(pb));
+			__m256d p1 = _mm256_mul_pd(_mm256_loadu_pd(pa + 4), _mm256_loadu_pd(pb + 4));
+			KERNEL_NO_CONTRACT(p0);
+			KERNEL_NO_CONTRACT(p1);
+			s0 = _mm256_add_pd(s0, p0);
+			s1 = _mm256_add_pd(s1, p1);
+		}
+		alignas(32) double s[KERNEL_PAD];
+		_mm256_store_pd(s, s0);
+		_mm256_store_pd(s + 4, s1);
+		return reduce8(s);
+	}
+
+	KERNEL_TARGET("avx512f")
+	double dotAVX512(const double* a, const double* b, size_t n)
+	{
+		__m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+		{
+			s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), s0);
+			s1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), s1);
+		}
+		if (i + 8 <= n)
+		{
+			s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), s0);
+			i += 8;
+		}
+		if (i < n)
+		{
+			__mmask8 m = static_cast<__mmask8>((1u << (n - i)) - 1);
+			s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a + i), _mm512_maskz_loadu_pd(m, b + i), s1);
+		}
+		alignas(64) double r[KERNEL_PAD];
+		_mm512_store_pd(r, _mm512_add_pd(s0, s1));
+		return reduce8(r);
+	}
+
+	KERNEL_TARGET("avx512f")
+	double dotAVX512Det(const double* a, const double* b, size_t n)
+	{
+		__m512d s = _mm512_setzero_pd();
+		for (size_t i = 0; i < n; i += KERNEL_PAD)
+		{
+			__mmask8 m = i + KERNEL_PAD <= n ? __mmask8(0xFF) : static_cast<__mmask8>((1u << (n - i)) - 1);
+			__m512d p = _mm512_mul_pd(_mm512_maskz_loadu_pd(m, a + i), _mm512_maskz_loadu_pd(m, b + i));
+			KERNEL_NO_CONTRACT(p);
+			s = _mm512_add_pd(s, p);
+		}
+		alignas(64) double r[KERNEL_PAD];
+		_mm512_store_pd(r, s);
+		return reduce8(r);
+	}
+
+#ifdef _MSC_VER
+	/// \brief Sprawdza bity cpuid oraz obsługę rejestrów przez system (xgetbv) w MSVC.
+	KernelIsa detectMSVC()
+	{
+		int r[4];
+		__cpuid(r, 0);
+		const int maxLeaf = r[0];
+		__cpuid(r, 1);
+		const bool sse2 = (r[3] >> 26) & 1;
+		const bool fma = (r[2] >> 12) & 1;
+		const bool osxsave = (r[2] >> 27) & 1;
+		if (!sse2)
+			return KernelIsa::Scalar;
+		if (!osxsave || maxLeaf < 7)
+			return KernelIsa::SSE2;
+		const unsigned long long xcr0 = _xgetbv(0);
+		__cpuidex(r, 7, 0);
+		const bool avx2 = (r[1] >> 5) & 1;
+		const bool avx512 = (r[1] >> 16) & 1;
+		if (avx512 && (xcr0 & 0xE6) == 0xE6)
+			return KernelIsa::AVX512;
+		if (avx2 && fma && (xcr0 & 0x6) == 0x6)
+			return KernelIsa::AVX2;
+		return KernelIsa::SSE2;
+	}
+#endif
+#endif
+
+	/// \brief Wybiera jądro dla danego zestawu instrukcji i kolejności sumowania.
+	DotFn selectDot(KernelIsa isa, SumOrder o)
+	{
+		const bool det = o == SumOrder::Deterministic;
+		switch (isa)
+		{
+#ifdef KERNELS_X86
+		case KernelIsa::AVX512:
+			return det ? dotAVX512Det : dotAVX512;
+		case KernelIsa::AVX2:
+			return det ? dotAVX2Det : dotAVX2;
+		case KernelIsa::SSE2:
+			return det ? dotSSE2Det : dotSSE2;
+#endif
+		default:
+			return det ? dotScalarDet : dotScalar;
+		}
+	}
+
+	/// \brief Stan wyboru jądra (inicjalizowany przy pierwszym użyciu).
+	struct Dispatch
+	{
+		std::atomic<KernelIsa> isa;
+		std::atomic<SumOrder> order{ SumOrder::Fast };
+		std::atomic<DotFn> fn;
+
+		Dispatch() : isa(detectKernelIsa()), fn(selectDot(isa, SumOrder::Fast)) {}
+	};
+
+	Dispatch& dispatch()
+	{
+		static Dispatch d;
+		return d;
+	}
+}
+
+/**
+ * \brief Zwraca najlepszy zestaw instrukcji obsługiwany przez procesor.
+ * \return Zestaw instrukcji.
+ */
+KernelIsa detectKernelIsa()
+{
+#if defined(KERNELS_X86) && defined(_MSC_VER)
+	return detectMSVC();
+#elif defined(KERNELS_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return KernelIsa::AVX512;
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return KernelIsa::AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return KernelIsa::SSE2;
+	return KernelIsa::Scalar;
+#else
+	return KernelIsa::Scalar;
+#endif
+}
+
+/**
+ * \brief Iloczyn skalarny dwóch wektorów (wywołuje jądro wybrane dla procesora).
+ * \param a Pierwszy wektor.
+ * \param b Drugi wektor.
+ * \param n Liczba elementów.
+ * \return Suma a[i] * b[i].
+ */
+double dot(const double* a, const double* b, size_t n)
+{
+	return dispatch().fn.load(std::memory_order_relaxed)(a, b, n);
+}
+
+/**
+ * \brief Ustawia kolejność sumowania używaną przez dot().
+ * \param o Kolejność sumowania.
+ */
+void setSumOrder(SumOrder o)
+{
+	Dispatch& d = dispatch();
+	d.order = o;
+	d.fn = selectDot(d.isa, o);
+}
+
+/**
+ * \brief Zwraca bieżącą kolejność sumowania.
+ * \return Kolejność sumowania.
+ */
+SumOrder sumOrder()
+{
+	return dispatch().order;
+}
+
+/**
+ * \brief Wymusza zestaw instrukcji, ograniczając żądanie do możliwości procesora.
+ * \param isa Żądany zestaw instrukcji.
+ * \return Faktycznie ustawiony zestaw instrukcji.
+ */
+KernelIsa setKernelIsa(KernelIsa isa)
+{
+	Dispatch& d = dispatch();
+	isa = std::min(isa, detectKernelIsa());
+	d.isa = isa;
+	d.fn = selectDot(isa, d.order);
+	return isa;
+}
+
+/**
+ * \brief Zwraca zestaw instrukcji używany przez jądra.
+ * \return Zestaw instrukcji.
+ */
+KernelIsa kernelIsa()
+{
+	return dispatch().isa;
+}
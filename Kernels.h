@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+
+/// \file Kernels.h
+/// \brief Zawiera wektoryzowane jądra obliczeniowe (iloczyn skalarny) z wyborem zestawu instrukcji w czasie działania.
+///
+/// Przy pierwszym użyciu wykrywane są możliwości procesora (cpuid) i wybierane jest najszybsze
+/// dostępne jądro: AVX-512, AVX2+FMA, SSE2 lub wersja skalarna.
+
+/// Liczba elementów, do której wielokrotności należy dopełniać zerami wektory współczynników.
+constexpr size_t KERNEL_PAD = 8;
+
+/// \enum KernelIsa
+/// \brief Zestaw instrukcji używany przez jądra.
+enum class KernelIsa
+{
+	Scalar, ///< Kod skalarny (bez instrukcji wektorowych).
+	SSE2, ///< 128-bitowe instrukcje SSE2.
+	AVX2, ///< 256-bitowe instrukcje AVX2 z FMA.
+	AVX512, ///< 512-bitowe instrukcje AVX-512F.
+};
+
+/// \enum SumOrder
+/// \brief Kolejność sumowania w iloczynie skalarnym.
+enum class SumOrder
+{
+	/// Najszybsza: wiele niezależnych akumulatorów i FMA. Wynik może się różnić w ostatnich bitach między procesorami.
+	Fast,
+	/// Deterministyczna: zawsze 8 akumulatorów (element i trafia do akumulatora i mod 8), mnożenie i dodawanie
+	/// bez FMA oraz stała kolejność redukcji. Wynik jest identyczny bitowo dla każdego zestawu instrukcji.
+	Deterministic,
+};
+
+/// \brief Iloczyn skalarny dwóch wektorów.
+/// \param a Pierwszy wektor (najlepiej wyrównany do 64 bajtów).
+/// \param b Drugi wektor (dowolne wyrównanie).
+/// \param n Liczba elementów.
+/// \return Suma a[i] * b[i].
+double dot(const double* a, const double* b, size_t n);
+
+/// \brief Ustawia kolejność sumowania używaną przez dot().
+/// \param o Kolejność sumowania.
+void setSumOrder(SumOrder o);
+
+/// \brief Zwraca bieżącą kolejność sumowania.
+SumOrder sumOrder();
+
+/// \brief Wymusza zestaw instrukcji (np. do porównań); żądanie jest ograniczane do możliwości procesora.
+/// \param isa Żądany zestaw instrukcji.
+/// \return Faktycznie ustawiony zestaw instrukcji.
+KernelIsa setKernelIsa(KernelIsa isa);
+
+/// \brief Zwraca zestaw instrukcji używany przez jądra.
+KernelIsa kernelIsa();
+
+/// \brief Zwraca najlepszy zestaw instrukcji obsługiwany przez procesor.
+KernelIsa detectKernelIsa();
+
+/// \brief Zaokrągla liczbę elementów w górę do wielokrotności KERNEL_PAD.
+/// \param n Liczba elementów.
+/// \return Najmniejsza wielokrotność KERNEL_PAD nie mniejsza niż n.
+constexpr size_t padKernel(size_t n)
+{
+	return (n + KERNEL_PAD - 1) / KERNEL_PAD * KERNEL_PAD;
+}
@@ -0,0 +1,200 @@
+/// \file LinAlg.cpp
+/// \brief Zawiera implementację narzędzi algebry liniowej.
+
+#include "LinAlg.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * \brief Tworzy macierz jednostkową.
+ * \param n Wymiar macierzy.
+ * \return Macierz jednostkowa n x n.
+ */
+Matrix Matrix::identity(size_t n)
+{
+	Matrix I(n, n);
+	for (size_t i = 0; i < n; ++i)
+		I(i, i) = 1;
+	return I;
+}
+
+/**
+ * \brief Iloczyn macierzy (kolejność pętli i-k-j sprzyja dostępowi sekwencyjnemu).
+ * \param x Lewy czynnik.
+ * \param y Prawy czynnik.
+ * \return Iloczyn x * y.
+ */
+Matrix operator*(const Matrix& x, const Matrix& y)
+{
+	if (x.c != y.r)
+		throw std::invalid_argument("Matrix dimensions do not match!");
+
+	Matrix z(x.r, y.c);
+	for (size_t i = 0; i < x.r; ++i)
+		for (size_t k = 0; k < x.c; ++k)
+		{
+			double v = x(i, k);
+			if (v == 0)
+				continue;
+			const double* yr = y.row(k);
+			double* zr = z.row(i);
+			for (size_t j = 0; j < y.c; ++j)
+				zr[j] += v * yr[j];
+		}
+	return z;
+}
+
+/**
+ * \brief Iloczyn macierzy i wektora.
+ * \param x Macierz.
+ * \param v Wektor.
+ * \return Iloczyn x * v.
+ */
+std::vector<double> operator*(const Matrix& x, const std::vector<double>& v)
+{
+	if (x.c != v.size())
+		throw std::invalid_argument("Matrix dimensions do not match!");
+
+	std::vector<double> z(x.r);
+	for (size_t i = 0; i < x.r; ++i)
+	{
+		const double* xr = x.row(i);
+		for (size_t j = 0; j < x.c; ++j)
+			z[i] += xr[j] * v[j];
+	}
+	return z;
+}
+
+/**
+ * \brief Suma macierzy.
+ * \param x Pierwszy składnik.
+ * \param y Drugi składnik.
+ * \return Suma x + y.
+ */
+Matrix operator+(const Matrix& x, const Matrix& y)
+{
+	if (x.r != y.r || x.c != y.c)
+		throw std::invalid_argument("Matrix dimensions do not match!");
+
+	Matrix z = x;
+	for (size_t i = 0; i < z.a.size(); ++i)
+		z.a[i] += y.a[i];
+	return z;
+}
+
+/**
+ * \brief Transpozycja macierzy.
+ * \return Macierz transponowana.
+ */
+Matrix Matrix::transposed() const
+{
+	Matrix t(c, r);
+	for (size_t i = 0; i < r; ++i)
+		for (size_t j = 0; j < c; ++j)
+			t(j, i) = (*this)(i, j);
+	return t;
+}
+
+/**
+ * \brief Największy moduł elementu macierzy.
+ * \return max |a_ij|.
+ */
+double Matrix::maxAbs() const
+{
+	double m = 0;
+	for (double v : a)
+		m = std::max(m, std::abs(v));
+	return m;
+}
+
+/**
+ * \brief Rozwiązuje układ równań z macierzą symetryczną dodatnio określoną.
+ * \param M Macierz układu.
+ * \param b Prawa strona układu.
+ * \return Rozwiązanie układu.
+ */
+std::vector<double> solveSPD(Matrix M, std::vector<double> b)
+{
+	const size_t n = M.rows();
+	if (M.cols() != n || b.size() != n)
+		throw std::invalid_argument("Matrix dimensions do not match!");
+
+	/// Względna regularyzacja przekątnej
+	double tr = 0;
+	for (size_t i = 0; i < n; ++i)
+		tr += M(i, i);
+	const double eps = 1e-12 * (tr > 0 ? tr / n : 1);
+	for (size_t i = 0; i < n; ++i)
+		M(i, i) += eps;
+
+	/// Rozkład M = L * L^T (L zapisywane w dolnym trójkącie M)
+	for (size_t j = 0; j < n; ++j)
+	{
+		double d = M(j, j);
+		for (size_t k = 0; k < j; ++k)
+			d -= M(j, k) * M(j, k);
+		if (d <= 0)
+			throw std::runtime_error("Matrix is not positive definite!");
+		d = std::sqrt(d);
+		M(j, j) = d;
+
+		for (size_t i = j + 1; i < n; ++i)
+		{
+			double s = M(i, j);
+			for (size_t k = 0; k < j; ++k)
+				s -= M(i, k) * M(j, k);
+			M(i, j) = s / d;
+		}
+	}
+
+	/// Podstawienie w przód (L * z = b) i wstecz (L^T * x = z)
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t k = 0; k < i; ++k)
+			b[i] -= M(i, k) * b[k];
+		b[i] /= M(i, i);
+	}
+	for (size_t i = n; i-- > 0;)
+	{
+		for (size_t k = i + 1; k < n; ++k)
+			b[i] -= M(k, i) * b[k];
+		b[i] /= M(i, i);
+	}
+	return b;
+}
+
+/**
+ * \brief Rozwiązuje dyskretne równanie Lapunowa algorytmem podwajania.
+ * \param F Macierz stanu.
+ * \param Q Macierz symetryczna.
+ * \param maxIter Największa liczba podwojeń.
+ * \param iterations Liczba wykonanych podwojeń (opcjonalnie).
+ * \return Rozwiązanie P = F P F' + Q.
+ */
+Matrix dlyap(Matrix F, Matrix Q, size_t maxIter, size_t* iterations)
+{
+	constexpr double TOL = 1e-15; ///< Względny próg pomijalnego przyrostu
+	constexpr double DIVERGED = 1e150; ///< Moduł elementu F^(2^k) świadczący o niestabilności
+
+	const size_t n = F.rows();
+	if (F.cols() != n || Q.rows() != n || Q.cols() != n)
+		throw std::invalid_argument("Matrix dimensions do not match!");
+
+	for (size_t k = 0; k < maxIter; ++k)
+	{
+		const Matrix inc = F * Q * F.transposed();
+		Q = Q + inc;
+		F = F * F;
+		if (iterations)
+			*iterations = k + 1;
+
+		const double f = F.maxAbs(), q = Q.maxAbs();
+		if (!std::isfinite(q) || !std::isfinite(f) || f > DIVERGED)
+			break;
+		if (inc.maxAbs() <= TOL * q && f <= TOL)
+			return Q;
+	}
+	throw std::runtime_error("Discrete Lyapunov iteration does not converge (unstable system)!");
+}
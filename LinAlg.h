@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/// \file LinAlg.h
+/// \brief Zawiera podstawowe narzędzia algebry liniowej (macierz gęsta, rozwiązywanie układów równań).
+
+/// \class Matrix
+/// \brief Gęsta macierz liczb typu double przechowywana wierszami.
+class Matrix
+{
+	size_t r = 0; ///< Liczba wierszy.
+	size_t c = 0; ///< Liczba kolumn.
+	std::vector<double> a; ///< Elementy macierzy (wierszami).
+
+public:
+	/// \brief Konstruktor macierzy zerowej.
+	/// \param rows Liczba wierszy. Domyślnie 0.
+	/// \param cols Liczba kolumn. Domyślnie 0.
+	Matrix(size_t rows = 0, size_t cols = 0) : r(rows), c(cols), a(rows * cols) {}
+
+	/// \brief Tworzy macierz jednostkową.
+	/// \param n Wymiar macierzy.
+	/// \return Macierz jednostkowa n x n.
+	static Matrix identity(size_t n);
+
+	size_t rows() const { return r; } ///< Zwraca liczbę wierszy.
+	size_t cols() const { return c; } ///< Zwraca liczbę kolumn.
+
+	double& operator()(size_t i, size_t j) { return a[i * c + j]; } ///< Dostęp do elementu (i, j).
+	double operator()(size_t i, size_t j) const { return a[i * c + j]; } ///< Dostęp do elementu (i, j).
+
+	double* row(size_t i) { return a.data() + i * c; } ///< Wskaźnik na początek wiersza i.
+	const double* row(size_t i) const { return a.data() + i * c; } ///< Wskaźnik na początek wiersza i.
+
+	/// \brief Iloczyn macierzy.
+	friend Matrix operator*(const Matrix&, const Matrix&);
+
+	/// \brief Iloczyn macierzy i wektora.
+	friend std::vector<double> operator*(const Matrix&, const std::vector<double>&);
+
+	/// \brief Suma macierzy.
+	friend Matrix operator+(const Matrix&, const Matrix&);
+
+	/// \brief Transpozycja macierzy.
+	Matrix transposed() const;
+
+	/// \brief Największy moduł elementu macierzy.
+	double maxAbs() const;
+};
+
+/// \brief Rozwiązuje układ równań z macierzą symetryczną dodatnio określoną (rozkład Cholesky'ego).
+///
+/// Do przekątnej dodawana jest względna regularyzacja, co zabezpiecza przed źle uwarunkowanymi
+/// równaniami normalnymi przy słabym pobudzeniu.
+/// \param M Macierz układu (symetryczna, dodatnio półokreślona).
+/// \param b Prawa strona układu.
+/// \return Rozwiązanie układu.
+/// \throws std::runtime_error Gdy macierz nie jest dodatnio określona.
+std::vector<double> solveSPD(Matrix M, std::vector<double> b);
+
+/// \brief Rozwiązuje dyskretne równanie Lapunowa P = F P F' + Q algorytmem podwajania.
+///
+/// Iteracja P(k+1) = P(k) + F(k) P(k) F(k)', F(k+1) = F(k)^2 (P(0) = Q, F(0) = F) po k krokach
+/// sumuje 2^k wyrazów szeregu sum F^i Q F'^i, więc dla promienia spektralnego F mniejszego od 1
+/// zbiega kwadratowo. Koszt kroku to O(n^3).
+/// \param F Macierz stanu (kwadratowa).
+/// \param Q Macierz symetryczna o wymiarze F.
+/// \param maxIter Największa liczba podwojeń. Domyślnie 64.
+/// \param iterations Opcjonalnie - liczba wykonanych podwojeń.
+/// \return Rozwiązanie P.
+/// \throws std::invalid_argument Gdy wymiary macierzy są niezgodne.
+/// \throws std::runtime_error Gdy iteracja nie jest zbieżna (promień spektralny F nie mniejszy od 1).
+Matrix dlyap(Matrix F, Matrix Q, size_t maxIter = 64, size_t* iterations = nullptr);
@@ -0,0 +1,139 @@
+/// \file MappedFile.cpp
+/// \brief Zawiera implementację klasy MappedFile.
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \brief Konstruktor odwzorowujący plik w pamięci.
+ * \param path Ścieżka do pliku.
+ */
+MappedFile::MappedFile(const std::string& path)
+{
+#ifdef _WIN32
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Cannot open file " + path);
+
+	LARGE_INTEGER sz;
+	GetFileSizeEx(file, &sz);
+	len = size_t(sz.QuadPart);
+	if (len == 0)
+		return;
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		throw std::runtime_error("Cannot map file " + path);
+	}
+	ptr = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!ptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		throw std::runtime_error("Cannot map file " + path);
+	}
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error("Cannot open file " + path);
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		throw std::runtime_error("Cannot stat file " + path);
+	}
+	len = size_t(st.st_size);
+	if (len == 0)
+	{
+		close(fd);
+		return;
+	}
+
+	void* p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); ///< Odwzorowanie pozostaje ważne po zamknięciu deskryptora
+	if (p == MAP_FAILED)
+		throw std::runtime_error("Cannot map file " + path);
+	ptr = static_cast<const std::byte*>(p);
+#endif
+}
+
+/**
+ * \brief Destruktor zwalniający odwzorowanie.
+ */
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+	if (ptr)
+		UnmapViewOfFile(ptr);
+	if (mapping)
+		CloseHandle(mapping);
+	if (file && file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+#else
+	if (ptr)
+		munmap(const_cast<std::byte*>(ptr), len);
+#endif
+}
+
+/**
+ * \brief Informuje system, że plik będzie czytany sekwencyjnie.
+ *
+ * Na systemach Windows tryb sekwencyjny jest ustawiany flagą FILE_FLAG_SEQUENTIAL_SCAN przy otwieraniu pliku.
+ */
+void MappedFile::adviseSequential() const
+{
+#ifndef _WIN32
+	if (ptr)
+		madvise(const_cast<std::byte*>(ptr), len, MADV_SEQUENTIAL);
+#endif
+}
+
+/**
+ * \brief Oblicza 64-bitowy skrót FNV-1a bloku danych.
+ * \param data Wskaźnik na dane.
+ * \param n Liczba bajtów.
+ * \param h Skrót poprzednich danych.
+ * \return Skrót danych.
+ */
+uint64_t hashFNV1a(const std::byte* data, size_t n, uint64_t h)
+{
+	for (size_t i = 0; i < n; ++i)
+	{
+		h ^= uint64_t(data[i]);
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+/**
+ * \brief Oblicza tani odcisk bloku danych z jego rozmiaru i próbkowanych bloków.
+ * \param data Wskaźnik na dane.
+ * \param n Liczba bajtów.
+ * \return Odcisk danych.
+ */
+uint64_t fingerprintFNV1a(const std::byte* data, size_t n)
+{
+	const uint64_t size = n;
+	uint64_t h = hashFNV1a(reinterpret_cast<const std::byte*>(&size), sizeof(size));
+	if (n <= FINGERPRINT_BLOCKS * FINGERPRINT_BLOCK)
+		return hashFNV1a(data, n, h);
+
+	for (size_t b = 0; b < FINGERPRINT_BLOCKS; ++b)
+		h = hashFNV1a(data + (n - FINGERPRINT_BLOCK) * b / (FINGERPRINT_BLOCKS - 1), FINGERPRINT_BLOCK, h);
+	return h;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+/// \file MappedFile.h
+/// \brief Zawiera definicję klasy MappedFile - pliku odwzorowanego w pamięci (tylko do odczytu).
+
+/// \class MappedFile
+/// \brief Plik odwzorowany w pamięci w trybie tylko do odczytu.
+///
+/// Zawartość pliku jest dostępna bez kopiowania - strony są wczytywane przez system operacyjny na żądanie.
+/// Na systemach Windows używane jest CreateFileMapping/MapViewOfFile, na pozostałych mmap.
+class MappedFile
+{
+	const std::byte* ptr = nullptr; ///< Początek odwzorowania.
+	size_t len = 0; ///< Rozmiar pliku w bajtach.
+
+#ifdef _WIN32
+	void* file = nullptr; ///< Uchwyt pliku.
+	void* mapping = nullptr; ///< Uchwyt odwzorowania.
+#endif
+
+public:
+	/// \brief Konstruktor odwzorowujący plik w pamięci.
+	/// \param path Ścieżka do pliku.
+	/// \throws std::runtime_error Gdy pliku nie da się otworzyć lub odwzorować.
+	MappedFile(const std::string& path);
+
+	/// \brief Destruktor zwalniający odwzorowanie.
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete; ///< Odwzorowania nie można kopiować.
+	MappedFile& operator=(const MappedFile&) = delete; ///< Odwzorowania nie można kopiować.
+
+	/// \brief Zwraca wskaźnik na początek odwzorowanego pliku.
+	const std::byte* data() const { return ptr; }
+
+	/// \brief Zwraca rozmiar pliku w bajtach.
+	size_t size() const { return len; }
+
+	/// \brief Informuje system, że plik będzie czytany sekwencyjnie (agresywniejsze wczytywanie z wyprzedzeniem).
+	void adviseSequential() const;
+};
+
+/// \brief Podpowiedź dla procesora, aby wczytał linię pamięci podręcznej z wyprzedzeniem.
+/// \param p Adres, który wkrótce zostanie odczytany.
+inline void prefetchRead(const void* p)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(p, 0, 0);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_prefetch(static_cast<const char*>(p), _MM_HINT_NTA);
+#endif
+}
+
+/// Wartość początkowa skrótu FNV-1a.
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+
+/// \brief Oblicza 64-bitowy skrót FNV-1a bloku danych.
+/// \param data Wskaźnik na dane.
+/// \param n Liczba bajtów.
+/// \param h Skrót poprzednich danych (kontynuacja). Domyślnie wartość początkowa.
+/// \return Skrót danych.
+uint64_t hashFNV1a(const std::byte* data, size_t n, uint64_t h = FNV_OFFSET);
+
+/// Liczba bloków pliku próbkowanych przez fingerprintFNV1a().
+constexpr size_t FINGERPRINT_BLOCKS = 8;
+
+/// Rozmiar bloku próbkowanego przez fingerprintFNV1a() w bajtach.
+constexpr size_t FINGERPRINT_BLOCK = 4096;
+
+/// \brief Oblicza tani odcisk dużego bloku danych - skrót FNV-1a rozmiaru i FINGERPRINT_BLOCKS równomiernie
+/// rozłożonych bloków (w tym pierwszego i ostatniego).
+///
+/// W odróżnieniu od hashFNV1a() nie odczytuje całych danych, więc nie wczytuje wszystkich stron
+/// odwzorowanego pliku. Dane nie dłuższe niż FINGERPRINT_BLOCKS * FINGERPRINT_BLOCK bajtów są skracane w całości.
+/// \param data Wskaźnik na dane.
+/// \param n Liczba bajtów.
+/// \return Odcisk danych.
+uint64_t fingerprintFNV1a(const std::byte* data, size_t n);
@@ -0,0 +1,485 @@
+/// \file MonteCarlo.cpp
+/// \brief Zawiera implementację estymatora Monte Carlo z trybami redukcji wariancji.
+
+#include "MonteCarlo.h"
+#include "TraceCache.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <limits>
+#include <mutex>
+#include <numbers>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	/// \struct Realization
+	/// \brief Wskaźnik jakości jednej realizacji i jej zmienne kontrolne.
+	struct Realization
+	{
+		double J = 0; ///< Wskaźnik jakości.
+		double c1 = 0; ///< sum err0 (err - err0).
+		double c2 = 0; ///< sum (err - err0)^2.
+	};
+
+	/// \brief Przebieg pętli z zadanymi próbkami szumu ARX (krok TraceCache::step).
+	/// \param s Symulacja (stan początkowy arx i pid).
+	/// \param tr Sygnały deterministyczne.
+	/// \param cost Wskaźnik jakości.
+	/// \param e Próbki szumu ARX.
+	/// \param err0 Przebieg błędu bez szumu (nullptr - bez zmiennych kontrolnych).
+	/// \param errOut Bufor błędu regulacji (nullptr - bez zapisu).
+	Realization realize(const Simulation& s, const TraceCache& tr, Cost cost, std::span<const double> e,
+		const std::vector<double>* err0 = nullptr, std::vector<double>* errOut = nullptr)
+	{
+		ARX arx = s.arx;
+		PID pid = s.pid;
+
+		Realization res;
+		LoopSample<double> x;
+		for (; x.i < tr.size(); ++x.i)
+		{
+			tr.step(x, pid, [&](double in, size_t t) { return arx.step(in, e[t]); });
+			const double err = x.err;
+			res.J += cost == Cost::IAE ? std::abs(err) : err * err;
+			if (err0)
+			{
+				const double de = err - (*err0)[x.i];
+				res.c1 += (*err0)[x.i] * de;
+				res.c2 += de * de;
+			}
+			if (errOut)
+				(*errOut)[x.i] = err;
+		}
+		return res;
+	}
+
+	/// \brief Średnia i wariancja nieobciążona próbki.
+	std::pair<double, double> meanVar(const std::vector<double>& x)
+	{
+		double m = 0, q = 0;
+		for (double v : x)
+			m += v;
+		m /= double(x.size());
+		for (double v : x)
+			q += (v - m) * (v - m);
+		return { m, x.size() > 1 ? q / double(x.size() - 1) : 0 };
+	}
+
+	/// \brief Iloczyn wielomianów nad GF(2) modulo wielomian p stopnia deg.
+	uint64_t mulMod(uint64_t a, uint64_t b, uint64_t p, unsigned deg)
+	{
+		uint64_t r = 0;
+		for (; b; b >>= 1)
+		{
+			if (b & 1)
+				r ^= a;
+			a <<= 1;
+			if (a >> deg & 1)
+				a ^= p;
+		}
+		return r;
+	}
+
+	/// \brief Potęga x^n modulo wielomian p stopnia deg nad GF(2).
+	uint64_t powX(uint64_t n, uint64_t p, unsigned deg)
+	{
+		uint64_t base = 2, r = 1;
+		if (base >> deg & 1)
+			base ^= p;
+		for (; n; n >>= 1)
+		{
+			if (n & 1)
+				r = mulMod(r, base, p, deg);
+			base = mulMod(base, base, p, deg);
+		}
+		return r;
+	}
+
+	/// \brief Wielomiany pierwotne nad GF(2) w kolejności stopni (bit i - współczynnik przy x^i).
+	/// \param count Liczba wielomianów.
+	/// \return Pary (stopień, wielomian).
+	std::vector<std::pair<unsigned, uint64_t>> primitivePolynomials(size_t count)
+	{
+		std::vector<std::pair<unsigned, uint64_t>> polys;
+		for (unsigned deg = 1; polys.size() < count && deg < 32; ++deg)
+		{
+			/// Dzielniki pierwsze rzędu grupy 2^deg - 1
+			const uint64_t M = (uint64_t(1) << deg) - 1;
+			std::vector<uint64_t> primes;
+			uint64_t m = M;
+			for (uint64_t q = 2; q * q <= m; ++q)
+				if (m % q == 0)
+				{
+					primes.push_back(q);
+					while (m % q == 0)
+						m /= q;
+				}
+			if (m > 1)
+				primes.push_back(m);
+
+			for (uint64_t a = 0; a < (uint64_t(1) << (deg - 1)) && polys.size() < count; ++a)
+			{
+				const uint64_t p = uint64_t(1) << deg | a << 1 | 1;
+				bool primitive = powX(M, p, deg) == 1;
+				for (size_t i = 0; i < primes.size() && primitive; ++i)
+					primitive = powX(M / primes[i], p, deg) != 1;
+				if (primitive)
+					polys.emplace_back(deg, p);
+			}
+		}
+		return polys;
+	}
+
+	/// \class SobolNet
+	/// \brief Ciąg Sobola o dowolnym wymiarze (kolejność kodu Graya, 32 bity).
+	///
+	/// Wymiar 0 to ciąg van der Corputa, kolejne wymiary używają kolejnych wielomianów pierwotnych
+	/// z losowymi nieparzystymi początkowymi liczbami kierunkowymi m_k < 2^k.
+	class SobolNet
+	{
+		static constexpr unsigned BITS = 32; ///< Liczba bitów współrzędnych.
+		size_t d; ///< Wymiar.
+		std::vector<uint32_t> v; ///< Liczby kierunkowe: v[j * BITS + k].
+		std::vector<uint32_t> x; ///< Bieżący punkt.
+		uint32_t n = 0; ///< Indeks następnego punktu.
+
+	public:
+		/// \brief Konstruktor - wyznacza liczby kierunkowe.
+		SobolNet(size_t dims, std::mt19937& rng) : d(dims), v(dims * BITS), x(dims)
+		{
+			const auto polys = primitivePolynomials(d ? d - 1 : 0);
+			for (size_t j = 0; j < d; ++j)
+			{
+				std::vector<uint64_t> m(BITS + 1);
+				const unsigned s = j ? polys[j - 1].first : BITS;
+				for (unsigned k = 1; k <= std::min(s, BITS); ++k)
+					m[k] = j ? (rng() & ((uint64_t(1) << k) - 1)) | 1 : 1;
+				if (j)
+				{
+					const uint64_t p = polys[j - 1].second;
+					for (unsigned k = s + 1; k <= BITS; ++k)
+					{
+						m[k] = m[k - s] ^ (m[k - s] << s);
+						for (unsigned i = 1; i < s; ++i)
+							if (p >> (s - i) & 1)
+								m[k] ^= m[k - i] << i;
+					}
+				}
+				for (unsigned k = 1; k <= BITS; ++k)
+					v[j * BITS + k - 1] = uint32_t(m[k] << (BITS - k));
+			}
+		}
+
+		/// \brief Wraca do punktu 0.
+		void reset()
+		{
+			std::fill(x.begin(), x.end(), 0u);
+			n = 0;
+		}
+
+		/// \brief Następny punkt: x(n) = x(n - 1) xor v(c), c - pozycja najmłodszego zera n - 1.
+		const std::vector<uint32_t>& next()
+		{
+			if (n)
+			{
+				const unsigned c = unsigned(std::countr_one(n - 1));
+				for (size_t j = 0; j < d; ++j)
+					x[j] ^= v[j * BITS + c];
+			}
+			n++;
+			return x;
+		}
+	};
+}
+
+/**
+ * @brief Odwrotna dystrybuanta standardowego rozkładu normalnego.
+ * @param p Prawdopodobieństwo.
+ * @return Kwantyl rzędu p.
+ */
+double normalQuantile(double p)
+{
+	constexpr double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+	constexpr double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+	constexpr double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+	constexpr double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+	constexpr double PLOW = 0.02425;
+
+	if (!(p > 0))
+		return -std::numeric_limits<double>::infinity();
+	if (!(p < 1))
+		return std::numeric_limits<double>::infinity();
+
+	double x;
+	if (p < PLOW || p > 1 - PLOW)
+	{
+		/// Ogony
+		const double q = std::sqrt(-2 * std::log(p < PLOW ? p : 1 - p));
+		x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+		if (p > 1 - PLOW)
+			x = -x;
+	}
+	else
+	{
+		/// Część centralna
+		const double q = p - 0.5, r = q * q;
+		x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+	}
+
+	/// Krok Halleya
+	const double e = 0.5 * std::erfc(-x / std::numbers::sqrt2) - p;
+	const double u = e * std::sqrt(2 * std::numbers::pi) * std::exp(x * x / 2);
+	return x - u / (1 + x * u / 2);
+}
+
+/**
+ * @brief Estymuje wartość oczekiwaną wskaźnika jakości pętli.
+ * @param s Symulacja.
+ * @param cost Wskaźnik jakości.
+ * @param realizations Liczba realizacji.
+ * @param mode Tryb losowania.
+ * @param seed Ziarno ciągu Sobola.
+ * @return Wynik estymacji.
+ */
+MCResult monteCarlo(Simulation& s, Cost cost, size_t realizations, MCMode mode, uint32_t seed)
+{
+	if (realizations < 4)
+		throw std::invalid_argument("Monte Carlo needs at least 4 realizations!");
+
+	const TraceCache tr(s, false);
+	const size_t T = tr.size();
+	std::vector<double> e(T), J;
+
+	MCResult res;
+	res.mode = mode;
+	switch (mode)
+	{
+	case MCMode::Antithetic:
+	{
+		/// Wariancja estymatora ze średnich par
+		std::vector<double> pairs((realizations + 1) / 2);
+		for (double& pm : pairs)
+		{
+			for (double& v : e)
+				v = ARX::getNoise();
+			const double Ja = realize(s, tr, cost, e).J;
+			for (double& v : e)
+				v = -v;
+			const double Jb = realize(s, tr, cost, e).J;
+			J.push_back(Ja);
+			J.push_back(Jb);
+			pm = (Ja + Jb) / 2;
+		}
+		const auto [m, var] = meanVar(pairs);
+		res.mean = m;
+		res.variance = 2 * var;
+		break;
+	}
+
+	case MCMode::Sobol:
+	{
+		/// Repliki z niezależnym przesunięciem cyfrowym - wariancja estymatora ze średnich replik
+		const size_t n = std::bit_ceil((realizations + SOBOL_REPLICATES - 1) / SOBOL_REPLICATES);
+		std::mt19937 rng(seed);
+		SobolNet net(T, rng);
+		std::vector<uint32_t> shift(T);
+		std::vector<double> reps(SOBOL_REPLICATES);
+		for (double& rm : reps)
+		{
+			for (uint32_t& sh : shift)
+				sh = uint32_t(rng());
+			net.reset();
+			rm = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				const std::vector<uint32_t>& x = net.next();
+				for (size_t t = 0; t < T; ++t)
+					e[t] = normalQuantile((double(x[t] ^ shift[t]) + 0.5) * 0x1p-32);
+				J.push_back(realize(s, tr, cost, e).J);
+				rm += J.back() / double(n);
+			}
+		}
+		const auto [m, var] = meanVar(reps);
+		res.mean = m;
+		res.variance = var * double(n);
+		break;
+	}
+
+	case MCMode::ControlVariate:
+	{
+		/// Przebieg bez szumu i odpowiedź impulsowa błędu na szum ARX
+		std::vector<double> err0(T), errD(T);
+		std::fill(e.begin(), e.end(), 0.0);
+		realize(s, tr, cost, e, nullptr, &err0);
+		e[0] = 1;
+		realize(s, tr, cost, e, nullptr, &errD);
+		double mu2 = 0;
+		for (size_t i = 0; i < T; ++i)
+			mu2 += (errD[i] - err0[i]) * (errD[i] - err0[i]) * double(T - i);
+		res.steps += 2 * T;
+
+		std::vector<double> c1, c2;
+		for (size_t i = 0; i < realizations; ++i)
+		{
+			for (double& v : e)
+				v = ARX::getNoise();
+			const Realization r = realize(s, tr, cost, e, &err0);
+			J.push_back(r.J);
+			c1.push_back(r.c1);
+			c2.push_back(r.c2 - mu2);
+		}
+
+		/// Współczynniki regresji J względem (C1, C2) z równań normalnych 2 x 2
+		const double mJ = meanVar(J).first, m1 = meanVar(c1).first, m2 = meanVar(c2).first;
+		double s11 = 0, s12 = 0, s22 = 0, s1J = 0, s2J = 0;
+		for (size_t i = 0; i < realizations; ++i)
+		{
+			const double a = c1[i] - m1, b = c2[i] - m2, j = J[i] - mJ;
+			s11 += a * a;
+			s12 += a * b;
+			s22 += b * b;
+			s1J += a * j;
+			s2J += b * j;
+		}
+		double b1 = 0, b2 = 0;
+		const double det = s11 * s22 - s12 * s12;
+		if (det > 1e-12 * s11 * s22)
+		{
+			b1 = (s22 * s1J - s12 * s2J) / det;
+			b2 = (s11 * s2J - s12 * s1J) / det;
+		}
+		else if (s11 > 0)
+			b1 = s1J / s11;
+
+		std::vector<double> z(realizations);
+		for (size_t i = 0; i < realizations; ++i)
+			z[i] = J[i] - b1 * c1[i] - b2 * c2[i];
+		const auto [m, var] = meanVar(z);
+		res.mean = m;
+		res.variance = var * double(realizations - 1) / double(realizations - 3);
+		break;
+	}
+
+	default:
+		for (size_t i = 0; i < realizations; ++i)
+		{
+			for (double& v : e)
+				v = ARX::getNoise();
+			J.push_back(realize(s, tr, cost, e).J);
+		}
+		res.mean = meanVar(J).first;
+		res.variance = meanVar(J).second;
+		break;
+	}
+
+	res.realizations = J.size();
+	res.steps += J.size() * T;
+	res.plainVariance = meanVar(J).second;
+	res.stdError = std::sqrt(res.variance / double(res.realizations));
+	res.halfWidth = normalQuantile(0.5 + res.confidence / 2) * res.stdError;
+	res.gain = res.variance > 0 ? res.plainVariance / res.variance : res.plainVariance > 0 ? std::numeric_limits<double>::infinity() : 1;
+	return res;
+}
+
+/**
+ * @brief Wskaźnik jakości jako funkcja przebiegu.
+ * @param cost Wskaźnik jakości.
+ * @return Funkcja wskaźnika.
+ */
+TrajectoryMetric costMetric(Cost cost)
+{
+	return [cost](const Trajectory& tr)
+	{
+		double J = 0;
+		for (double e : tr.error)
+			J += cost == Cost::IAE ? std::abs(e) : e * e;
+		return J;
+	};
+}
+
+/**
+ * @brief Sekwencyjne Monte Carlo z regułą zatrzymania.
+ * @param s Symulacja.
+ * @param metric Wskaźnik.
+ * @param rule Reguła zatrzymania.
+ * @param threads Liczba wątków.
+ * @param seed Ziarno generatorów szumu.
+ * @return Wynik.
+ */
+MCResult monteCarloUntil(Simulation& s, const TrajectoryMetric& metric, const StopRule& rule, unsigned threads, uint32_t seed)
+{
+	if (!(rule.confidence > 0 && rule.confidence < 1) || rule.relHalfWidth < 0 || rule.absHalfWidth < 0 || rule.maxRealizations < 2
+		|| !(rule.relHalfWidth > 0 || rule.absHalfWidth > 0))
+		throw std::invalid_argument("Invalid Monte Carlo stopping rule!");
+	if (!threads)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+
+	const TraceCache tr(s, false);
+	const size_t T = tr.size();
+	const double z = normalQuantile(0.5 + rule.confidence / 2);
+
+	Welford total;
+	std::mutex mtx;
+	std::atomic<bool> stop = false;
+	std::atomic<size_t> started = 0;
+	bool met = false;
+
+	/// Dołączenie akumulatora wątku i sprawdzenie reguły (pod muteksem)
+	auto checkIn = [&](Welford& local)
+	{
+		std::lock_guard lock(mtx);
+		total.merge(local);
+		local = {};
+		const double hw = z * total.stdError();
+		if (total.n >= std::max<size_t>(rule.minRealizations, 2)
+			&& ((rule.relHalfWidth > 0 && hw <= rule.relHalfWidth * std::abs(total.mean)) || (rule.absHalfWidth > 0 && hw <= rule.absHalfWidth)))
+		{
+			met = true;
+			stop = true;
+		}
+	};
+
+	parallelFor(threads, threads, [&](size_t w)
+	{
+		std::mt19937 rng(seed + uint32_t(w));
+		std::normal_distribution<double> noise;
+		std::vector<double> err(T), u(T), y(T);
+		const Trajectory traj{ tr.setpoint(), err, u, y };
+
+		Welford local;
+		while (!stop && started++ < rule.maxRealizations)
+		{
+			ARX arx = s.arx;
+			PID pid = s.pid;
+			LoopSample<double> x;
+			for (; x.i < T; ++x.i)
+			{
+				tr.step(x, pid, [&](double in, size_t) { return arx.step(in, noise(rng)); });
+				err[x.i] = x.err;
+				u[x.i] = x.u;
+				y[x.i] = x.y;
+			}
+			local.push(metric(traj));
+			if (local.n == CHECK_EVERY)
+				checkIn(local);
+		}
+		checkIn(local);
+	});
+
+	MCResult res;
+	res.realizations = total.n;
+	res.steps = total.n * T;
+	res.mean = total.mean;
+	res.variance = res.plainVariance = total.variance();
+	res.stdError = total.stdError();
+	res.confidence = rule.confidence;
+	res.halfWidth = z * res.stdError;
+	res.converged = met;
+	return res;
+}
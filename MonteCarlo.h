@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Simulation.h"
+#include "Tuning.h"
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <span>
+
+#include "json.hpp"
+using json = nlohmann::json;
+
+/// \file MonteCarlo.h
+/// \brief Zawiera estymator Monte Carlo wskaźnika jakości pętli z trybami redukcji wariancji.
+
+/// \enum MCMode
+/// \brief Sposób losowania szumu ARX w kolejnych realizacjach.
+enum class MCMode
+{
+	Plain, ///< Niezależne próbki ARX::getNoise().
+	Antithetic, ///< Pary realizacji z szumem e i -e.
+	Sobol, ///< Szum gaussowski z ciągu Sobola z losowym przesunięciem cyfrowym (kilka niezależnych replik).
+	ControlVariate ///< Niezależne próbki i zmienne kontrolne o znanej wartości oczekiwanej z przebiegu bez szumu.
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(MCMode, {
+	{ MCMode::Plain, "plain" },
+	{ MCMode::Antithetic, "antithetic" },
+	{ MCMode::Sobol, "sobol" },
+	{ MCMode::ControlVariate, "control-variate" },
+})
+
+/// \brief Odwrotna dystrybuanta standardowego rozkładu normalnego.
+///
+/// Przybliżenie wymierne Acklama poprawione jednym krokiem metody Halleya (błąd względny rzędu 1e-15).
+/// \param p Prawdopodobieństwo z przedziału (0, 1).
+/// \return Kwantyl rzędu p.
+double normalQuantile(double p);
+
+/// \struct MCResult
+/// \brief Wynik estymacji Monte Carlo wartości oczekiwanej wskaźnika jakości.
+struct MCResult
+{
+	MCMode mode = MCMode::Plain; ///< Tryb losowania.
+	size_t realizations = 0; ///< Liczba realizacji (przebiegów pętli).
+	size_t steps = 0; ///< Łączna liczba zasymulowanych kroków (z przebiegami pomocniczymi).
+	double mean = 0; ///< Estymata wartości oczekiwanej wskaźnika.
+	double variance = 0; ///< Wariancja estymatora razy liczba realizacji (odpowiednik wariancji jednej próbki).
+	double plainVariance = 0; ///< Wariancja pojedynczej realizacji (wariancja zwykłego Monte Carlo).
+	double stdError = 0; ///< Błąd standardowy estymaty.
+	double confidence = 0.95; ///< Poziom ufności przedziału halfWidth.
+	double halfWidth = 0; ///< Połowa szerokości przedziału ufności na poziomie confidence.
+	double gain = 1; ///< Zysk efektywnej liczby próbek: plainVariance / variance.
+	bool converged = true; ///< Czy osiągnięto docelową szerokość przedziału ufności (monteCarloUntil).
+
+	/// \brief Liczba realizacji potrzebna do osiągnięcia połowy szerokości przedziału ufności hw.
+	/// \param hw Docelowa połowa szerokości przedziału ufności na poziomie confidence.
+	size_t required(double hw) const
+	{
+		const double z = normalQuantile(0.5 + confidence / 2);
+		return size_t(std::ceil(variance * (z / hw) * (z / hw)));
+	}
+
+	/// \brief Wypisuje raport.
+	friend std::ostream& operator<<(std::ostream& os, const MCResult& r)
+	{
+		return os << json(r.mode).get<std::string>() << ", " << r.realizations << " realizacji: J = " << r.mean << " +- " << r.halfWidth
+			<< " (" << 100 * r.confidence << "%), zysk efektywnej liczby probek " << r.gain;
+	}
+};
+
+/// \brief Estymuje wartość oczekiwaną wskaźnika jakości pętli względem szumu modelu ARX.
+///
+/// Każda realizacja to przebieg pętli (krok jak w Simulation::run, od stanu s.arx i s.pid) z tymi
+/// samymi sygnałami deterministycznymi (TraceCache) i nowymi próbkami szumu ARX. Tryby:
+/// - Plain: niezależne realizacje;
+/// - Antithetic: pary (e, -e), wariancja liczona ze średnich par (zysk, gdy przeważa nieparzysta część
+///   wskaźnika, np. przy trwałym błędzie nadążania; składowa sum err_e^2 jest w parze identyczna);
+/// - Sobol: SOBOL_REPLICATES niezależnie przesuniętych (xor) kopii ciągu Sobola o wymiarze s.len + 1,
+///   przekształconych odwrotną dystrybuantą rozkładu normalnego; wariancja ze średnich replik;
+/// - ControlVariate: pętla jest liniowa, więc błąd regulacji to err0 + err_e, gdzie err0 jest
+///   przebiegiem bez szumu, a err_e - odpowiedzią na szum o odpowiedzi impulsowej h. Zmienne kontrolne
+///   C1 = sum err0 err_e (E = 0) i C2 = sum err_e^2 (E = sum h(i)^2 (len + 1 - i)) są odejmowane
+///   ze współczynnikami regresji.
+/// Wariancja zwykłego Monte Carlo (do zysku) jest wariancją wskaźnika pojedynczych realizacji.
+/// \param s Symulacja (obiekty nie są zmieniane).
+/// \param cost Wskaźnik jakości.
+/// \param realizations Liczba realizacji (Antithetic - zaokrąglana w górę do parzystej, Sobol - do
+/// SOBOL_REPLICATES razy potęga 2).
+/// \param mode Tryb losowania.
+/// \param seed Ziarno losowych liczb kierunkowych i przesunięć ciągu Sobola.
+/// \return Wynik estymacji.
+/// \throws std::invalid_argument Gdy liczba realizacji jest mniejsza niż 4.
+MCResult monteCarlo(Simulation& s, Cost cost, size_t realizations, MCMode mode = MCMode::Plain, uint32_t seed = 1);
+
+/// Liczba niezależnie przesuniętych replik ciągu Sobola.
+constexpr size_t SOBOL_REPLICATES = 16;
+
+/// \struct Welford
+/// \brief Strumieniowa średnia i wariancja (algorytm Welforda) z łączeniem akumulatorów (wzór Chana).
+struct Welford
+{
+	size_t n = 0; ///< Liczba próbek.
+	double mean = 0; ///< Średnia.
+	double m2 = 0; ///< Suma kwadratów odchyleń od średniej.
+
+	/// \brief Dopisuje próbkę.
+	void push(double x)
+	{
+		n++;
+		const double d = x - mean;
+		mean += d / double(n);
+		m2 += d * (x - mean);
+	}
+
+	/// \brief Dołącza statystyki innego akumulatora.
+	void merge(const Welford& o)
+	{
+		if (!o.n)
+			return;
+		const size_t N = n + o.n;
+		const double d = o.mean - mean;
+		mean += d * double(o.n) / double(N);
+		m2 += o.m2 + d * d * double(n) * double(o.n) / double(N);
+		n = N;
+	}
+
+	/// \brief Wariancja nieobciążona.
+	double variance() const { return n > 1 ? m2 / double(n - 1) : 0; }
+
+	/// \brief Błąd standardowy średniej.
+	double stdError() const { return n ? std::sqrt(variance() / double(n)) : 0; }
+};
+
+/// \struct Trajectory
+/// \brief Przebiegi jednej realizacji pętli (chwile 0, ..., len).
+struct Trajectory
+{
+	std::span<const double> setpoint; ///< Wartość zadana r(t).
+	std::span<const double> error; ///< Błąd regulacji e(t).
+	std::span<const double> control; ///< Sterowanie u(t) (wyjście regulatora, bez zakłócenia).
+	std::span<const double> output; ///< Wyjście obiektu y(t).
+};
+
+/// Wskaźnik obliczany z przebiegów realizacji (wywoływany jednocześnie z wielu wątków).
+using TrajectoryMetric = std::function<double(const Trajectory&)>;
+
+/// \brief Wskaźnik jakości jako funkcja przebiegu (suma |e| lub e^2).
+/// \param cost Wskaźnik jakości.
+/// \return Funkcja wskaźnika.
+TrajectoryMetric costMetric(Cost cost);
+
+/// \struct StopRule
+/// \brief Reguła zatrzymania sekwencyjnego Monte Carlo.
+///
+/// Przebieg kończy się, gdy po co najmniej minRealizations realizacjach połowa szerokości przedziału
+/// ufności spełnia hw <= relHalfWidth |mean| lub hw <= absHalfWidth, albo gdy liczba realizacji
+/// osiągnie maxRealizations. Co najmniej jedna z docelowych szerokości musi być dodatnia.
+struct StopRule
+{
+	double relHalfWidth = 0.005; ///< Docelowa względna połowa szerokości przedziału (0 - nieużywana).
+	double absHalfWidth = 0; ///< Docelowa bezwzględna połowa szerokości przedziału (0 - nieużywana).
+	double confidence = 0.95; ///< Poziom ufności.
+	size_t minRealizations = 32; ///< Najmniejsza liczba realizacji przed pierwszym sprawdzeniem.
+	size_t maxRealizations = 1000000; ///< Największa liczba realizacji.
+};
+
+/// \brief Sekwencyjne Monte Carlo: realizacje są symulowane, aż przedział ufności średniej wskaźnika spełni regułę.
+///
+/// Każdy wątek ma własny generator szumu ARX (std::mt19937 z ziarnem seed + numer wątku, rozkład
+/// N(0, 1) - ARX::getNoise nie jest bezpieczny wątkowo) i własny akumulator Welford, który co
+/// CHECK_EVERY realizacji jest dołączany pod muteksem do akumulatora wspólnego; wtedy też jest
+/// sprawdzana reguła. Po jej spełnieniu wątki kończą bieżącą realizację i dołączają swoje statystyki
+/// (wynik obejmuje te realizacje, więc przy threads > 1 halfWidth może nieznacznie przekroczyć cel).
+/// Realizacje mają wspólne sygnały deterministyczne (TraceCache) i zaczynają od stanu s.arx i s.pid.
+/// \param s Symulacja (obiekty nie są zmieniane).
+/// \param metric Wskaźnik obliczany z przebiegów realizacji.
+/// \param rule Reguła zatrzymania.
+/// \param threads Liczba wątków. Domyślnie 1; 0 - liczba rdzeni.
+/// \param seed Ziarno generatorów szumu.
+/// \return Wynik (tryb Plain; converged - czy reguła została spełniona przed maxRealizations).
+/// \throws std::invalid_argument Gdy reguła jest niepoprawna (także gdy relHalfWidth i absHalfWidth są zerowe).
+MCResult monteCarloUntil(Simulation& s, const TrajectoryMetric& metric, const StopRule& rule = {}, unsigned threads = 1, uint32_t seed = 1);
+
+/// Liczba realizacji wątku między kolejnymi dołączeniami do akumulatora wspólnego.
+constexpr size_t CHECK_EVERY = 8;
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/// \file Parallel.h
+/// \brief Zawiera prostą pętlę równoległą opartą na std::thread.
+
+/// \brief Wykonuje fn(i) dla i = 0, ..., n-1 na co najwyżej threads wątkach.
+///
+/// Wątek w przetwarza indeksy w, w + T, w + 2T, ... (T - liczba wątków); wątek wywołujący
+/// przetwarza indeksy wątku 0. Funkcja kończy się po zakończeniu wszystkich wywołań.
+/// \param n Liczba indeksów.
+/// \param threads Liczba wątków. 0 - liczba rdzeni procesora.
+/// \param fn Funkcja wywoływana dla każdego indeksu.
+template <typename F>
+void parallelFor(size_t n, unsigned threads, F fn)
+{
+	if (!threads)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	const size_t T = std::min<size_t>(threads, n);
+
+	auto worker = [&fn, n, T](size_t w)
+	{
+		for (size_t i = w; i < n; i += T)
+			fn(i);
+	};
+
+	std::vector<std::thread> pool;
+	for (size_t w = 1; w < T; ++w)
+		pool.emplace_back(worker, w);
+	if (T)
+		worker(0);
+	for (auto& th : pool)
+		th.join();
+}
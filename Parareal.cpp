@@ -0,0 +1,286 @@
+/// \file Parareal.cpp
+/// \brief Zawiera implementację symulacji równoległej w czasie (metoda parareal).
+
+#include "Parareal.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+	/**
+	 * \brief Ustawia stan pętli z wektora [stan ARX, sumerr, lasterr, arxout].
+	 * \param x Wektor stanu.
+	 * \param arx Model obiektu.
+	 * \param pid Regulator.
+	 * \param arxout Ostatnie wyjście obiektu.
+	 */
+	void setLoop(const std::vector<double>& x, ARX& arx, PID& pid, double& arxout)
+	{
+		const size_t n = arx.stateSize();
+		arx.setState(std::span(x).first(n));
+		pid.sumerr = x[n];
+		pid.lasterr = x[n + 1];
+		arxout = x[n + 2];
+	}
+
+	/**
+	 * \brief Zwraca stan pętli w formacie [stan ARX, sumerr, lasterr, arxout].
+	 */
+	std::vector<double> getLoop(const ARX& arx, const PID& pid, double arxout)
+	{
+		std::vector<double> x = arx.state();
+		x.push_back(pid.sumerr);
+		x.push_back(pid.lasterr);
+		x.push_back(arxout);
+		return x;
+	}
+
+	/**
+	 * \brief Jeden krok pętli regulacji - te same działania co w Simulation::run.
+	 * \param arx Model obiektu.
+	 * \param pid Regulator.
+	 * \param arxout Ostatnie wyjście obiektu (aktualizowane).
+	 * \param setp Wartość zadana.
+	 * \param d Zakłócenie wejściowe.
+	 * \param nz Szum pomiarowy.
+	 * \param e Próbka szumu modelu ARX.
+	 * \param err Błąd regulacji (wynik).
+	 * \param ster Sterowanie (wynik).
+	 */
+	inline void loopStep(ARX& arx, PID& pid, double& arxout, double setp, double d, double nz, double e, double& err, double& ster)
+	{
+		err = setp - (arxout + nz);
+		ster = pid.sim(err);
+		arxout = arx.step(ster + d, e);
+	}
+
+	/// \brief Największy moduł różnicy dwóch wektorów.
+	double maxDiff(const std::vector<double>& a, const std::vector<double>& b)
+	{
+		double m = 0;
+		for (size_t i = 0; i < a.size(); ++i)
+			m = std::max(m, std::abs(a[i] - b[i]));
+		return m;
+	}
+}
+
+/**
+ * \brief Konstruktor klasy Parareal.
+ * \param s Symulowana pętla.
+ */
+Parareal::Parareal(Simulation& s) : sim(s) {}
+
+/**
+ * \brief Wyznacza macierze modelu liniowego pętli.
+ *
+ * Kolumna j macierzy Phi to stan po jednym kroku (bez szumu, zakłóceń i wartości zadanej) z wektora
+ * bazowego e_j, a Gamma - stan po jednym kroku z zerowego stanu przy jednostkowej wartości zadanej.
+ * Model jest więc zawsze zgodny z propagatorem dokładnym, niezależnie od reprezentacji ARX.
+ */
+void Parareal::linearize()
+{
+	ARX arx = sim.arx;
+	PID pid = sim.pid;
+	nArx = arx.stateSize();
+	const size_t n = nArx + 3;
+	if (n > MAX_STATE)
+		throw std::invalid_argument("Loop state is too large for the time-parallel mode!");
+
+	double arxout = 0, err = 0, ster = 0;
+	Phi = Matrix(n, n);
+	std::vector<double> x(n);
+	for (size_t j = 0; j < n; ++j)
+	{
+		std::fill(x.begin(), x.end(), 0.0);
+		x[j] = 1;
+		setLoop(x, arx, pid, arxout);
+		loopStep(arx, pid, arxout, 0, 0, 0, 0, err, ster);
+		std::vector<double> c = getLoop(arx, pid, arxout);
+		for (size_t i = 0; i < n; ++i)
+			Phi(i, j) = c[i];
+	}
+
+	std::fill(x.begin(), x.end(), 0.0);
+	setLoop(x, arx, pid, arxout);
+	loopStep(arx, pid, arxout, 1, 0, 0, 0, err, ster);
+	Gamma = getLoop(arx, pid, arxout);
+	coarse.clear();
+}
+
+/**
+ * \brief Propagator zgrubny: x(t+L) = Phi^L x + Psi_L r, Psi_L = sum_{i<L} Phi^i Gamma.
+ *
+ * Phi^L i Psi_L są liczone metodą podwajania (składanie odcinków a i b: Psi_{a+b} = Phi^b Psi_a + Psi_b)
+ * i zapamiętywane dla każdej długości segmentu.
+ * \param x Stan na początku segmentu.
+ * \param L Długość segmentu.
+ * \param r Wartość zadana na początku segmentu (przyjmowana jako stała w segmencie).
+ * \return Przewidywany stan na końcu segmentu.
+ */
+std::vector<double> Parareal::propagate(const std::vector<double>& x, size_t L, double r)
+{
+	auto it = coarse.find(L);
+	if (it == coarse.end())
+	{
+		const size_t n = Phi.rows();
+		Matrix P = Matrix::identity(n), Q = Phi;
+		std::vector<double> psi(n), q = Gamma;
+		for (size_t e = L; e; e >>= 1)
+		{
+			if (e & 1)
+			{
+				psi = Q * psi;
+				for (size_t i = 0; i < n; ++i)
+					psi[i] += q[i];
+				P = Q * P;
+			}
+			if (e > 1)
+			{
+				std::vector<double> Qq = Q * q;
+				for (size_t i = 0; i < n; ++i)
+					q[i] += Qq[i];
+				Q = Q * Q;
+			}
+		}
+		it = coarse.emplace(L, std::make_pair(std::move(P), std::move(psi))).first;
+	}
+
+	std::vector<double> y = it->second.first * x;
+	for (size_t i = 0; i < y.size(); ++i)
+		y[i] += it->second.second[i] * r;
+	return y;
+}
+
+/**
+ * \brief Wykonuje symulację metodą parareal.
+ *
+ * Sygnały zadane, zakłócenie, szum pomiarowy i szum modelu są generowane szeregowo dla całego okna,
+ * więc przebieg jest równoważny Simulation::run. Przebieg dokładny s-tego segmentu w iteracji k
+ * jest pomijany, gdy s < k (jego stan początkowy jest już dokładny od poprzedniej iteracji).
+ * \param fout Nazwa pliku CSV z wynikami.
+ * \param y Opcjonalny bufor na przebieg wyjścia obiektu.
+ * \return Statystyki wykonania.
+ */
+Parareal::Stats Parareal::run(const std::string& fout, std::vector<double>* y)
+{
+	linearize();
+
+	const bool channels = !sim.dist.empty() || !sim.noise.empty();
+	bool log = false;
+	std::ofstream out;
+	if (!fout.empty())
+	{
+		out.open(fout);
+		if (out)
+		{
+			log = true;
+			out << "Iteracja,Zadana,Blad,Sterowanie,Wyjscie";
+			if (channels)
+				out << ",Zaklocenie,Szum";
+			out << std::endl;
+		}
+	}
+
+	const unsigned T = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+	const size_t S = std::max<size_t>(1, segments ? segments : T);
+	const size_t W = S * segLen;
+	const size_t N = sim.len + 1;
+
+	std::vector<double> setp(W), dist(W), noise(W), e(W), err(W), ster(W), outv(W);
+	std::vector<double> x0 = getLoop(sim.arx, sim.pid, 0); ///< Simulation::run zaczyna od arxout = 0
+	Stats st;
+
+	for (size_t b = 0; b < N; b += W)
+	{
+		const size_t w = std::min(W, N - b);
+		sim.gen.fill(b, std::span(setp).first(w));
+		if (!sim.dist.empty())
+			sim.dist.fill(b, std::span(dist).first(w));
+		if (!sim.noise.empty())
+			sim.noise.fill(b, std::span(noise).first(w));
+		for (size_t i = 0; i < w; ++i)
+			e[i] = ARX::getNoise(); ///< ta sama kolejność losowania co w Simulation::run
+
+		const size_t Sw = std::min(S, w);
+		std::vector<size_t> t(Sw + 1);
+		for (size_t s = 0; s <= Sw; ++s)
+			t[s] = w * s / Sw;
+
+		/// Przewidywanie zgrubne stanów granicznych
+		std::vector<std::vector<double>> X(Sw + 1), G(Sw), F(Sw);
+		X[0] = x0;
+		for (size_t s = 0; s < Sw; ++s)
+			X[s + 1] = G[s] = propagate(X[s], t[s + 1] - t[s], setp[t[s]]);
+
+		std::vector<ARX> arxs(Sw, sim.arx);
+		std::vector<PID> pids(Sw, sim.pid);
+		const unsigned limit = std::min<unsigned>(maxIter ? maxIter : unsigned(Sw), unsigned(Sw));
+		unsigned k = 0;
+		while (k < limit)
+		{
+			/// Przebieg dokładny (równoległy) segmentów, których stan początkowy mógł się zmienić
+			const size_t first = k;
+			parallelFor(Sw - first, T, [&](size_t i)
+				{
+					const size_t s = first + i;
+					double arxout = 0;
+					setLoop(X[s], arxs[s], pids[s], arxout);
+					for (size_t n = t[s]; n < t[s + 1]; ++n)
+					{
+						loopStep(arxs[s], pids[s], arxout, setp[n], dist[n], noise[n], e[n], err[n], ster[n]);
+						outv[n] = arxout;
+					}
+					F[s] = getLoop(arxs[s], pids[s], arxout);
+				});
+			++k;
+
+			/// Poprawka stanów granicznych (szeregowa)
+			double change = 0, scale = 0;
+			std::vector<double> Xs = x0;
+			for (size_t s = 0; s < Sw; ++s)
+			{
+				std::vector<double> Gn = propagate(Xs, t[s + 1] - t[s], setp[t[s]]);
+				for (size_t i = 0; i < Gn.size(); ++i)
+					Xs[i] = Gn[i] + F[s][i] - G[s][i];
+				G[s] = std::move(Gn);
+				change = std::max(change, maxDiff(Xs, X[s + 1]));
+				for (double v : Xs)
+					scale = std::max(scale, std::abs(v));
+				X[s + 1] = Xs;
+			}
+			if (change <= tol * (1 + scale))
+				break;
+		}
+
+		st.windows++;
+		st.maxIterations = std::max(st.maxIterations, k);
+		st.sweeps += k;
+		x0 = F[Sw - 1];
+
+		for (size_t n = 0; n < w; ++n)
+		{
+			if (log)
+			{
+				out << b + n << "," << setp[n] << "," << err[n] << "," << ster[n] << "," << outv[n];
+				if (channels)
+					out << "," << dist[n] << "," << noise[n];
+				out << "\n";
+			}
+			if (y)
+				y->push_back(outv[n]);
+		}
+	}
+
+	/// Stan końcowy pętli przekazywany do symulacji
+	double arxout = 0;
+	setLoop(x0, sim.arx, sim.pid, arxout);
+	if (st.windows)
+		st.sweeps /= st.windows;
+	return st;
+}
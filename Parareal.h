@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Simulation.h"
+#include "LinAlg.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/// \file Parareal.h
+/// \brief Zawiera definicję klasy Parareal - eksperymentalnej symulacji równoległej w czasie.
+
+/// \class Parareal
+/// \brief Symulacja pętli regulacji równoległa w czasie (metoda parareal).
+///
+/// Horyzont symulacji jest dzielony na okna, a każde okno na segmenty. Stany pętli na granicach
+/// segmentów (historia ARX, stan PID, ostatnie wyjście) są przewidywane tanim propagatorem zgrubnym -
+/// liniowym modelem pętli bez szumu, x(t+L) = Phi^L x(t) + Psi_L r(t), gdzie r(t) to wartość zadana
+/// na początku segmentu. Następnie segmenty są liczone równolegle dokładnym propagatorem (tym samym
+/// krokiem co Simulation::run) i granice są poprawiane:
+/// X_{s+1} <- G(X_s^nowe) + F(X_s^stare) - G(X_s^stare), aż zmiana stanów granicznych spadnie poniżej tol.
+///
+/// Propagator zgrubny ma dokładną część jednorodną (Phi^L), więc dla pętli liniowej (również z szumem -
+/// jego próbki są generowane szeregowo, w tej samej kolejności co w Simulation::run) stany graniczne są
+/// dokładne po pierwszej poprawce i algorytm kończy się po dwóch przebiegach dokładnych.
+/// Po maxIter = liczba segmentów przebiegach wynik jest dokładny dla dowolnej pętli, a przy wcześniejszym
+/// zatrzymaniu błąd stanów granicznych jest ograniczony przez tol.
+class Parareal
+{
+	Simulation& sim; ///< Symulowana pętla (jej obiekty ARX i PID są aktualizowane do stanu końcowego).
+
+	size_t nArx = 0; ///< Długość stanu ARX.
+	Matrix Phi; ///< Macierz przejścia pętli zamkniętej (jeden krok).
+	std::vector<double> Gamma; ///< Wpływ wartości zadanej na stan w jednym kroku.
+	std::map<size_t, std::pair<Matrix, std::vector<double>>> coarse; ///< Phi^L i Psi_L dla występujących długości segmentów.
+
+	/// \brief Wyznacza macierze modelu liniowego pętli przez próbkowanie jednego kroku dla wektorów bazowych.
+	void linearize();
+
+	/// \brief Propagator zgrubny dla segmentu o długości L.
+	std::vector<double> propagate(const std::vector<double>& x, size_t L, double r);
+
+public:
+	unsigned threads = 0; ///< Liczba wątków. 0 - liczba rdzeni.
+	size_t segments = 0; ///< Liczba segmentów w oknie. 0 - równa liczbie wątków.
+	size_t segLen = 1 << 14; ///< Długość segmentu (długość okna to segments * segLen).
+	double tol = 1e-10; ///< Względna tolerancja zbieżności stanów granicznych.
+	unsigned maxIter = 0; ///< Największa liczba przebiegów dokładnych w oknie. 0 - liczba segmentów (wynik dokładny).
+
+	/// Największa długość wektora stanu pętli, dla której dostępny jest tryb równoległy.
+	static constexpr size_t MAX_STATE = 512;
+
+	/// \struct Stats
+	/// \brief Statystyki wykonania.
+	struct Stats
+	{
+		size_t windows = 0; ///< Liczba okien.
+		unsigned maxIterations = 0; ///< Największa liczba przebiegów dokładnych w oknie.
+		double sweeps = 0; ///< Średnia liczba przebiegów dokładnych na okno.
+	};
+
+	/// \brief Konstruktor klasy Parareal.
+	/// \param s Symulowana pętla.
+	Parareal(Simulation& s);
+
+	/// \brief Wykonuje symulację (len + 1 iteracji, jak Simulation::run).
+	/// \param fout Nazwa pliku CSV z wynikami (format jak w Simulation::run). Pusty - bez zapisu.
+	/// \param y Opcjonalny bufor na przebieg wyjścia obiektu.
+	/// \return Statystyki wykonania.
+	/// \throws std::invalid_argument Gdy stan pętli jest dłuższy niż MAX_STATE.
+	Stats run(const std::string& fout = "", std::vector<double>* y = nullptr);
+};
@@ -0,0 +1,193 @@
+/// \file PartitionedConv.cpp
+/// \brief Zawiera implementację splotu z równomiernym podziałem odpowiedzi impulsowej.
+
+#include "PartitionedConv.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * \brief Konstruktor klasy PartitionedConv.
+ *
+ * Wyznacza widma bloków odpowiedzi impulsowej (poza głową) i przygotowuje bufory,
+ * dzięki czemu process() nie alokuje pamięci.
+ * \param h Odpowiedź impulsowa.
+ * \param block Długość bloku (potęga dwójki) lub 0 dla doboru automatycznego.
+ */
+PartitionedConv::PartitionedConv(std::span<const double> h, size_t block) : nh(h.size())
+{
+	P = block ? block : autoBlock(nh);
+	if (!isPow2(P))
+		throw std::invalid_argument("Block size must be a power of two!");
+	parts = std::max<size_t>(1, (nh + P - 1) / P);
+
+	head.assign(P, 0.0);
+	std::copy(h.begin(), h.begin() + std::min(P, nh), head.begin());
+	hist.resize(P);
+
+	work.resize(2 * P);
+	H.resize((parts - 1) * (P + 1));
+	for (size_t p = 1; p < parts; ++p)
+	{
+		std::fill(work.begin(), work.end(), Complex(0));
+		for (size_t i = 0; i < P && p * P + i < nh; ++i)
+			work[i] = h[p * P + i];
+		fft(work);
+		std::copy(work.begin(), work.begin() + P + 1, H.begin() + (p - 1) * (P + 1));
+	}
+
+	fdl.assign(H.size(), Complex(0));
+	win.assign(2 * P, 0.0);
+	tail.assign(P, 0.0);
+}
+
+/**
+ * \brief Dobiera długość bloku.
+ *
+ * Koszt na próbkę to około P mnożeń głowy i 4 nh / P mnożeń w dziedzinie częstotliwości,
+ * co jest najmniejsze dla P bliskiego 2 sqrt(nh).
+ * \param taps Długość odpowiedzi impulsowej.
+ * \return Długość bloku (potęga dwójki z przedziału [16, 4096]).
+ */
+size_t PartitionedConv::autoBlock(size_t taps)
+{
+	const double target = 2 * std::sqrt(double(taps));
+	size_t P = 16;
+	while (P < 4096 && P < target)
+		P <<= 1;
+	return P;
+}
+
+/**
+ * \brief Przetwarza jedną próbkę.
+ * \param x Próbka wejściowa.
+ * \return Próbka wyjściowa.
+ */
+double PartitionedConv::process(double x)
+{
+	hist.push(x);
+	double y = dot(head.data(), hist.data(), P) + tail[n]; ///< głowa liczona bezpośrednio, ogon z ostatniego bloku FFT
+
+	win[P + n] = x;
+	if (++n == P)
+	{
+		flush();
+		n = 0;
+	}
+	return y;
+}
+
+/**
+ * \brief Przetwarza zakończony blok wejścia.
+ *
+ * Widmo okna [poprzedni blok, bieżący blok] trafia do linii opóźniającej widm. Suma iloczynów
+ * H_p * X_{b+1-p} po odwrotnej FFT daje (w drugiej połowie okna) wkład bloków 1..parts-1
+ * dla kolejnych P próbek wyjścia.
+ */
+void PartitionedConv::flush()
+{
+	const size_t L = parts - 1;
+	if (!L)
+		return;
+
+	for (size_t i = 0; i < 2 * P; ++i)
+		work[i] = win[i];
+	fft(work);
+
+	fdlPos = (fdlPos ? fdlPos : L) - 1;
+	std::copy(work.begin(), work.begin() + P + 1, fdl.begin() + fdlPos * (P + 1));
+
+	/// Iloczyny w dziedzinie częstotliwości (prążki 0..P, sygnały rzeczywiste)
+	std::fill(work.begin(), work.end(), Complex(0));
+	for (size_t q = 0; q < L; ++q)
+	{
+		const Complex* h = H.data() + q * (P + 1);
+		const Complex* X = fdl.data() + ((fdlPos + q) % L) * (P + 1);
+		for (size_t i = 0; i <= P; ++i) ///< mnożenie rozpisane ręcznie - operator* std::complex obsługuje NaN/inf wolną ścieżką
+			work[i] += Complex(h[i].real() * X[i].real() - h[i].imag() * X[i].imag(),
+				h[i].real() * X[i].imag() + h[i].imag() * X[i].real());
+	}
+	for (size_t i = 1; i < P; ++i)
+		work[2 * P - i] = std::conj(work[i]);
+	fft(work, true);
+
+	const double scale = 1.0 / (2 * P);
+	for (size_t i = 0; i < P; ++i)
+		tail[i] = work[P + i].real() * scale;
+
+	std::copy(win.begin() + P, win.end(), win.begin());
+}
+
+/**
+ * \brief Zeruje stan splotu.
+ */
+void PartitionedConv::reset()
+{
+	hist.clear();
+	std::fill(fdl.begin(), fdl.end(), Complex(0));
+	std::fill(win.begin(), win.end(), 0.0);
+	std::fill(tail.begin(), tail.end(), 0.0);
+	fdlPos = 0;
+	n = 0;
+}
+
+/**
+ * \brief Zwraca stan splotu.
+ *
+ * Widma FDL są zapisywane od najnowszego, więc stan nie zależy od pozycji fdlPos.
+ * \return Pozycja w bloku n, historia wejścia (od najnowszej), okno, ogon i widma FDL.
+ */
+std::vector<double> PartitionedConv::state() const
+{
+	std::vector<double> s;
+	s.reserve(stateSize());
+	s.push_back(double(n));
+	s.insert(s.end(), hist.data(), hist.data() + P);
+	s.insert(s.end(), win.begin(), win.end());
+	s.insert(s.end(), tail.begin(), tail.end());
+
+	const size_t L = fdl.size() / (P + 1);
+	for (size_t q = 0; q < L; ++q)
+	{
+		const Complex* X = fdl.data() + ((fdlPos + q) % L) * (P + 1);
+		for (size_t i = 0; i <= P; ++i)
+		{
+			s.push_back(X[i].real());
+			s.push_back(X[i].imag());
+		}
+	}
+	return s;
+}
+
+/**
+ * \brief Ustawia stan splotu.
+ * \param s Stan w formacie zwracanym przez state().
+ * \throws std::invalid_argument Gdy długość stanu lub pozycja w bloku nie odpowiada splotowi.
+ */
+void PartitionedConv::setState(std::span<const double> s)
+{
+	if (s.size() != stateSize())
+		throw std::invalid_argument("State size does not match the convolution!");
+	if (!(s[0] >= 0 && s[0] < double(std::max<size_t>(P, 1))) || s[0] != std::floor(s[0]))
+		throw std::invalid_argument("Invalid convolution block position!");
+
+	const double* p = s.data() + 1;
+	n = size_t(s[0]);
+	hist.clear();
+	for (size_t j = P; j-- > 0;)
+		hist.push(p[j]);
+	p += P;
+	std::copy(p, p + 2 * P, win.begin());
+	p += 2 * P;
+	std::copy(p, p + P, tail.begin());
+	p += P;
+
+	for (Complex& X : fdl)
+	{
+		X = Complex(p[0], p[1]);
+		p += 2;
+	}
+	fdlPos = 0;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "DelayLine.h"
+#include "Aligned.h"
+#include "FFT.h"
+
+#include <span>
+#include <vector>
+
+/// \file PartitionedConv.h
+/// \brief Zawiera definicję klasy PartitionedConv - splotu z równomiernym podziałem odpowiedzi impulsowej.
+
+/// \class PartitionedConv
+/// \brief Splot próbka po próbce z długą odpowiedzią impulsową metodą overlap-save z równomiernym podziałem.
+///
+/// Odpowiedź impulsowa h jest dzielona na bloki o długości P. Pierwszy blok (głowa) jest liczony
+/// bezpośrednio iloczynem skalarnym, więc wynik jest dostępny w tej samej próbce (zerowe opóźnienie).
+/// Pozostałe bloki są mnożone w dziedzinie częstotliwości przez widma poprzednich bloków wejścia
+/// przechowywane w linii opóźniającej widm (FDL); raz na P próbek wykonywana jest jedna FFT i jedna
+/// odwrotna FFT o długości 2P. Koszt na próbkę wynosi O(P + (nh / P) + log P) zamiast O(nh).
+class PartitionedConv
+{
+	size_t P = 0; ///< Długość bloku.
+	size_t parts = 0; ///< Liczba bloków odpowiedzi impulsowej (wraz z głową).
+	size_t nh = 0; ///< Długość odpowiedzi impulsowej.
+
+	AlignedVector<double> head; ///< Głowa odpowiedzi impulsowej (P współczynników, dopełnienie zerami).
+	DelayLine hist; ///< Ostatnie P próbek wejścia (do głowy).
+
+	std::vector<Complex> H; ///< Widma bloków 1..parts-1 (po P + 1 prążków, pozostałe wynikają z symetrii).
+	std::vector<Complex> fdl; ///< Linia opóźniająca widm wejścia (parts-1 widm po P + 1 prążków).
+	size_t fdlPos = 0; ///< Pozycja najnowszego widma w fdl.
+
+	std::vector<double> win; ///< Okno wejścia o długości 2P (poprzedni i bieżący blok).
+	std::vector<double> tail; ///< Wkład bloków 1..parts-1 dla bieżącego bloku wyjścia.
+	std::vector<Complex> work; ///< Bufor roboczy FFT o długości 2P.
+	size_t n = 0; ///< Pozycja w bieżącym bloku.
+
+	/// \brief Przetwarza zakończony blok wejścia i wyznacza wkład ogona dla następnego bloku wyjścia.
+	void flush();
+
+public:
+	/// \brief Konstruktor domyślny (pusty splot).
+	PartitionedConv() = default;
+
+	/// \brief Konstruktor klasy PartitionedConv.
+	/// \param h Odpowiedź impulsowa.
+	/// \param block Długość bloku (potęga dwójki). 0 - dobierana automatycznie na podstawie długości h.
+	/// \throws std::invalid_argument Gdy długość bloku nie jest potęgą dwójki.
+	PartitionedConv(std::span<const double> h, size_t block = 0);
+
+	/// \brief Dobiera długość bloku minimalizującą koszt na próbkę (potęga dwójki bliska 2 sqrt(nh)).
+	/// \param taps Długość odpowiedzi impulsowej.
+	/// \return Długość bloku.
+	static size_t autoBlock(size_t taps);
+
+	/// \brief Przetwarza jedną próbkę.
+	/// \param x Próbka wejściowa.
+	/// \return Próbka wyjściowa sum_j h[j] * x(t - j).
+	double process(double x);
+
+	/// \brief Zeruje stan splotu (historię wejścia).
+	void reset();
+
+	/// \brief Zwraca stan splotu: pozycję w bloku, historię wejścia, okno, ogon i widma FDL (od najnowszego).
+	/// \return Wektor stanu (prążki widm jako pary: część rzeczywista, urojona).
+	std::vector<double> state() const;
+
+	/// \brief Ustawia stan splotu zwrócony wcześniej przez state() (wraz z fazą bloku - dalsze wyjście jest identyczne bitowo).
+	/// \param s Stan w formacie zwracanym przez state().
+	/// \throws std::invalid_argument Gdy stan nie odpowiada splotowi.
+	void setState(std::span<const double> s);
+
+	/// \brief Zwraca długość wektora stanu.
+	size_t stateSize() const { return 1 + 4 * P + 2 * fdl.size(); }
+
+	size_t blockSize() const { return P; } ///< Zwraca długość bloku.
+	size_t partitions() const { return parts; } ///< Zwraca liczbę bloków odpowiedzi impulsowej.
+	size_t taps() const { return nh; } ///< Zwraca długość odpowiedzi impulsowej.
+};
@@ -0,0 +1,162 @@
+/// \file Relay.cpp
+/// \brief Zawiera implementację przekaźnika i eksperymentu autostrojenia metodą przekaźnikową.
+
+#include "Relay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+/**
+ * @brief Konstruktor klasy Relay.
+ * @param amp Amplituda.
+ * @param hyst Połowa szerokości pasma histerezy.
+ */
+Relay::Relay(double amp, double hyst) : out(amp), d(amp), eps(hyst)
+{
+	if (!(d > 0) || eps < 0)
+		throw std::invalid_argument("Relay amplitude must be positive and hysteresis non-negative!");
+}
+
+/**
+ * @brief Krok przekaźnika.
+ * @param err Błąd regulacji.
+ * @return Sterowanie.
+ */
+double Relay::sim(double err)
+{
+	if (err > eps)
+		out = d;
+	else if (err < -eps)
+		out = -d;
+	return out;
+}
+
+/**
+ * @brief Dopisuje próbkę do detektora cyklu granicznego.
+ * @param x Próbka sygnału.
+ * @return true, jeśli cykl jest ustalony.
+ */
+bool LimitCycleDetector::push(double x)
+{
+	if (t && prev < 0 && x >= 0)
+	{
+		/// Przejście przez zero w górę między chwilami t - 1 i t (interpolacja liniowa)
+		const double cross = double(t - 1) + prev / (prev - x);
+		if (lastCross >= 0)
+		{
+			const double p = cross - lastCross, a = (hi - lo) / 2;
+			if (periods && std::abs(p - period) <= tol * p && std::abs(a - amplitude) <= tol * a)
+				stable++;
+			else
+				stable = 0;
+			period = p;
+			amplitude = a;
+			periods++;
+		}
+		lastCross = cross;
+		lo = hi = x;
+	}
+	lo = std::min(lo, x);
+	hi = std::max(hi, x);
+	prev = x;
+	t++;
+	return converged();
+}
+
+/**
+ * @brief Wyznacza nastawy regulatora PID z Ku i Tu.
+ * @param Ku Wzmocnienie krytyczne.
+ * @param Tu Okres oscylacji.
+ * @param rule Reguła doboru nastaw.
+ * @return Regulator.
+ */
+PID tuningRule(double Ku, double Tu, TuningRule rule)
+{
+	double Kp = 0, Ti = 0, Td = 0;
+	switch (rule)
+	{
+	case TuningRule::ZieglerNicholsPI:
+		Kp = 0.45 * Ku;
+		Ti = Tu / 1.2;
+		break;
+	case TuningRule::TyreusLuyben:
+		Kp = Ku / 2.2;
+		Ti = 2.2 * Tu;
+		Td = Tu / 6.3;
+		break;
+	case TuningRule::SomeOvershoot:
+		Kp = 0.33 * Ku;
+		Ti = Tu / 2;
+		Td = Tu / 3;
+		break;
+	case TuningRule::NoOvershoot:
+		Kp = 0.2 * Ku;
+		Ti = Tu / 2;
+		Td = Tu / 3;
+		break;
+	default:
+		Kp = 0.6 * Ku;
+		Ti = Tu / 2;
+		Td = Tu / 8;
+		break;
+	}
+	return PID(Kp, Kp / Ti, Kp * Td);
+}
+
+/**
+ * @brief Eksperyment przekaźnikowy.
+ *
+ * Pętla z przekaźnikiem w miejscu regulatora jest liczona przez Simulation::forEachStep; symulacja kończy
+ * się w chwili ustalenia cyklu, więc zwykle trwa tylko kilka okresów oscylacji.
+ * @param s Symulacja.
+ * @param relay Przekaźnik.
+ * @param rule Reguła doboru nastaw.
+ * @return Wynik eksperymentu.
+ */
+RelayResult relayTune(Simulation& s, Relay relay, TuningRule rule)
+{
+	ARX arx = s.arx;
+	LimitCycleDetector det;
+	RelayResult r;
+
+	r.steps = s.forEachStep<double>(relay, [&](double in, size_t) { return arx.sim(in); }, [&](const LoopSample<double>& p)
+	{
+		r.converged = det.push(p.err);
+		return !r.converged;
+	});
+
+	r.Tu = det.period;
+	r.amplitude = det.amplitude;
+	r.periods = det.periods;
+	if (!r.converged)
+		return r;
+
+	/// Funkcja opisująca przekaźnika z histerezą
+	const double a = std::sqrt(std::max(0.0, r.amplitude * r.amplitude - relay.eps * relay.eps));
+	r.Ku = a > 0 ? 4 * relay.d / (std::numbers::pi * a) : 0;
+	r.pid = tuningRule(r.Ku, r.Tu, rule);
+	s.pid.P = r.pid.P;
+	s.pid.I = r.pid.I;
+	s.pid.D = r.pid.D;
+	return r;
+}
+
+/**
+ * @brief Eksperyment przekaźnikowy dla symulacji zapisanej w pliku.
+ *
+ * Plik jest zapisywany tylko wtedy, gdy udało się go wczytać (Simulation::load zgłasza wyjątek) i cykl się ustalił.
+ * @param file Nazwa pliku.
+ * @param relay Przekaźnik.
+ * @param rule Reguła doboru nastaw.
+ * @return Wynik eksperymentu.
+ */
+RelayResult relayTune(const std::string& file, Relay relay, TuningRule rule)
+{
+	Simulation s = Simulation::load(file);
+	RelayResult r = relayTune(s, relay, rule);
+	if (r.converged)
+		s.save(file);
+	return r;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "SISO.h"
+#include "Simulation.h"
+
+#include <string>
+
+#include "json.hpp"
+using json = nlohmann::json;
+
+/// \file Relay.h
+/// \brief Zawiera definicję przekaźnika z histerezą i eksperymentu autostrojenia metodą przekaźnikową.
+
+/// \class Relay
+/// \brief Regulator przekaźnikowy z opcjonalną histerezą.
+///
+/// Wyjście ma wartość +d lub -d: przełącza się na +d, gdy błąd przekroczy eps, i na -d, gdy spadnie
+/// poniżej -eps (wewnątrz pasma histerezy wyjście się nie zmienia).
+class Relay : public SISO
+{
+	double out; ///< Bieżące wyjście (+d lub -d).
+
+public:
+	double d; ///< Amplituda przekaźnika.
+	double eps; ///< Połowa szerokości pasma histerezy.
+
+	/// \brief Konstruktor klasy Relay.
+	/// \param d Amplituda. Domyślnie 1.
+	/// \param eps Połowa szerokości pasma histerezy. Domyślnie 0.
+	/// \throws std::invalid_argument Gdy d <= 0 lub eps < 0.
+	Relay(double d = 1, double eps = 0);
+
+	/// \brief Krok przekaźnika.
+	/// \param err Błąd regulacji.
+	/// \return Sterowanie (+d lub -d).
+	double sim(double err) override;
+};
+
+/// \class LimitCycleDetector
+/// \brief Strumieniowy detektor okresu i amplitudy cyklu granicznego.
+///
+/// Okres jest mierzony między kolejnymi przejściami sygnału przez zero w górę (z interpolacją liniową
+/// chwili przejścia), a amplituda to połowa rozpiętości sygnału w ostatnim okresie. Cykl jest uznawany
+/// za ustalony, gdy STABLE kolejnych okresów i amplitud różni się od poprzednich o mniej niż tol.
+class LimitCycleDetector
+{
+	double prev = 0; ///< Poprzednia próbka.
+	double lastCross = -1; ///< Chwila ostatniego przejścia przez zero w górę (-1 - brak).
+	double lo = 0, hi = 0; ///< Najmniejsza i największa próbka od ostatniego przejścia.
+	size_t t = 0; ///< Liczba próbek.
+	size_t stable = 0; ///< Liczba kolejnych zgodnych okresów.
+
+public:
+	/// Liczba kolejnych zgodnych okresów wymagana do uznania cyklu za ustalony.
+	static constexpr size_t STABLE = 3;
+
+	double tol = 0.01; ///< Względna tolerancja zgodności okresów i amplitud.
+	double period = 0; ///< Ostatni zmierzony okres [próbki].
+	double amplitude = 0; ///< Ostatnia zmierzona amplituda.
+	size_t periods = 0; ///< Liczba zmierzonych okresów.
+
+	/// \brief Dopisuje próbkę.
+	/// \param x Próbka sygnału (o wartości średniej bliskiej zeru).
+	/// \return true, jeśli cykl jest ustalony.
+	bool push(double x);
+
+	/// \brief Sprawdza, czy cykl jest ustalony.
+	bool converged() const { return stable >= STABLE; }
+};
+
+/// \enum TuningRule
+/// \brief Reguła doboru nastaw na podstawie wzmocnienia krytycznego Ku i okresu oscylacji Tu.
+enum class TuningRule
+{
+	ZieglerNichols, ///< PID: Kp = 0.6 Ku, Ti = Tu / 2, Td = Tu / 8.
+	ZieglerNicholsPI, ///< PI: Kp = 0.45 Ku, Ti = Tu / 1.2.
+	TyreusLuyben, ///< PID: Kp = Ku / 2.2, Ti = 2.2 Tu, Td = Tu / 6.3.
+	SomeOvershoot, ///< PID: Kp = 0.33 Ku, Ti = Tu / 2, Td = Tu / 3.
+	NoOvershoot ///< PID: Kp = 0.2 Ku, Ti = Tu / 2, Td = Tu / 3.
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(TuningRule, {
+	{ TuningRule::ZieglerNichols, "ZN" },
+	{ TuningRule::ZieglerNicholsPI, "ZN-PI" },
+	{ TuningRule::TyreusLuyben, "TL" },
+	{ TuningRule::SomeOvershoot, "some-overshoot" },
+	{ TuningRule::NoOvershoot, "no-overshoot" },
+})
+
+/// \brief Wyznacza nastawy dyskretnego regulatora PID (okres próbkowania 1) z Ku i Tu.
+///
+/// Dla nastaw ciągłych Kp, Ti, Td: P = Kp, I = Kp / Ti, D = Kp * Td (jak w PID::sim).
+/// \param Ku Wzmocnienie krytyczne.
+/// \param Tu Okres oscylacji [próbki].
+/// \param rule Reguła doboru nastaw.
+/// \return Regulator o wyznaczonych nastawach.
+PID tuningRule(double Ku, double Tu, TuningRule rule = TuningRule::ZieglerNichols);
+
+/// \struct RelayResult
+/// \brief Wynik eksperymentu przekaźnikowego.
+struct RelayResult
+{
+	bool converged = false; ///< Czy cykl graniczny się ustalił.
+	double Ku = 0; ///< Wzmocnienie krytyczne 4d / (pi sqrt(a^2 - eps^2)).
+	double Tu = 0; ///< Okres cyklu granicznego [próbki].
+	double amplitude = 0; ///< Amplituda cyklu granicznego błędu.
+	size_t periods = 0; ///< Liczba zmierzonych okresów.
+	size_t steps = 0; ///< Liczba zasymulowanych kroków.
+	PID pid; ///< Wyznaczone nastawy.
+};
+
+/// \brief Eksperyment przekaźnikowy: pętla z przekaźnikiem zamiast regulatora PID.
+///
+/// Pętla (krok jak w Simulation::run, na kopii s.arx, z wartością zadaną, zakłóceniem i szumem
+/// symulacji) jest symulowana, aż detektor cyklu granicznego uzna cykl za ustalony albo upłynie
+/// s.len + 1 kroków. Detektor dostaje błąd regulacji. Gdy cykl się ustali, nastawy wyznaczone regułą
+/// rule są zapisywane w s.pid (stan regulatora nie zmienia się). Wartość zadana powinna być stała
+/// w czasie eksperymentu.
+/// \param s Symulacja.
+/// \param relay Przekaźnik.
+/// \param rule Reguła doboru nastaw.
+/// \return Wynik eksperymentu.
+RelayResult relayTune(Simulation& s, Relay relay = {}, TuningRule rule = TuningRule::ZieglerNichols);
+
+/// \brief Wczytuje symulację z pliku JSON, wykonuje eksperyment przekaźnikowy i zapisuje nastawy do bloku "PID" pliku.
+/// \param file Nazwa pliku (format Simulation::save).
+/// \param relay Przekaźnik.
+/// \param rule Reguła doboru nastaw.
+/// \return Wynik eksperymentu (plik jest zmieniany tylko wtedy, gdy cykl się ustalił).
+/// \throws std::runtime_error Gdy pliku nie można wczytać.
+RelayResult relayTune(const std::string& file, Relay relay = {}, TuningRule rule = TuningRule::ZieglerNichols);
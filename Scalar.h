@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ARX.h"
+#include "PID.h"
+#include "DelayLine.h"
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+#include "json.hpp"
+using json = nlohmann::json;
+
+/// \file Scalar.h
+/// \brief Zawiera szablony modelu ARX i regulatora PID dla wybranego typu zmiennoprzecinkowego.
+
+/// \enum ScalarType
+/// \brief Typ liczb, w którym jest wykonywana symulacja pętli.
+enum class ScalarType
+{
+	Float, ///< float (32 bity) - dwukrotnie szersze wektory SIMD i połowa ruchu pamięci.
+	Double, ///< double - typ domyślny, symulacja obiektami ARX i PID.
+	LongDouble ///< long double - przebiegi odniesienia.
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(ScalarType, {
+	{ ScalarType::Float, "float" },
+	{ ScalarType::Double, "double" },
+	{ ScalarType::LongDouble, "long double" },
+})
+
+/// \class ScalarARX
+/// \brief Model ARX liczony w typie T.
+///
+/// Współczynniki, historie i akumulatory są typu T; iloczyny skalarne są prostymi pętlami,
+/// wektoryzowanymi przez kompilator dla szerokości typu T. Model nie wybiera reprezentacji
+/// (rzadkiej, splotu blokowego) - przeznaczony jest do modeli niskiego rzędu i banków pętli.
+/// \tparam T Typ liczb (float, double lub long double).
+template <typename T>
+class ScalarARX
+{
+	std::vector<T> A; ///< Mianownik modelu.
+	std::vector<T> B; ///< Licznik modelu.
+	unsigned k = 0; ///< Opóźnienie modelu.
+	T ns_var = 0; ///< Amplituda szumu modelu.
+	DelayLineT<T> inBuf; ///< Historia wejść (k + nb próbek).
+	DelayLineT<T> outBuf; ///< Historia wyjść (na próbek).
+
+public:
+	/// \brief Konstruktor klasy ScalarARX.
+	///
+	/// Kopiuje współczynniki i historie wejść/wyjść modelu (zaokrąglone do typu T), jak ScalarPID stan regulatora.
+	/// \param a Model ARX.
+	explicit ScalarARX(const ARX& a)
+		: A(std::begin(a.A), std::end(a.A)), B(std::begin(a.B), std::end(a.B)), k(a.k), ns_var(T(a.ns_var)),
+		inBuf(a.B.size() ? a.k + a.B.size() : 0), outBuf(a.A.size())
+	{
+		/// Historie od najstarszej próbki (push wstawia próbkę najnowszą)
+		for (size_t j = std::min(inBuf.size(), a.inBuf.size()); j-- > 0;)
+			inBuf.push(T(a.inBuf[j]));
+		for (size_t j = std::min(outBuf.size(), a.outBuf.size()); j-- > 0;)
+			outBuf.push(T(a.outBuf[j]));
+	}
+
+	/// \brief Krok symulacji z podaną próbką szumu.
+	/// \param in Wejście.
+	/// \param e Próbka szumu.
+	/// \return Wyjście modelu.
+	T step(T in, T e)
+	{
+		inBuf.push(in);
+		T num = 0, den = 0;
+		const T* u = inBuf.data() + k;
+		for (size_t j = 0; j < B.size(); ++j)
+			num += B[j] * u[j];
+		const T* y = outBuf.data();
+		for (size_t j = 0; j < A.size(); ++j)
+			den += A[j] * y[j];
+		const T out = num - den + ns_var * e;
+		outBuf.push(out);
+		return out;
+	}
+
+	/// \brief Krok symulacji z szumem losowanym przez ARX::getNoise() (jak ARX::sim).
+	/// \param in Wejście.
+	/// \return Wyjście modelu.
+	T sim(T in)
+	{
+		return step(in, T(ARX::getNoise()));
+	}
+};
+
+/// \class ScalarPID
+/// \brief Regulator PID liczony w typie T (te same działania co PID::sim).
+/// \tparam T Typ liczb (float, double lub long double).
+template <typename T>
+class ScalarPID
+{
+public:
+	T P, I, D; ///< Współczynniki P, I, D.
+	T sumerr, lasterr; ///< Suma błędów i ostatni błąd.
+
+	/// \brief Konstruktor klasy ScalarPID.
+	/// \param p Regulator (nastawy i stan są zaokrąglane do typu T).
+	explicit ScalarPID(const PID& p) : P(T(p.P)), I(T(p.I)), D(T(p.D)), sumerr(T(p.sumerr)), lasterr(T(p.lasterr)) {}
+
+	/// \brief Krok regulatora.
+	/// \param err Błąd regulacji.
+	/// \return Sterowanie.
+	T sim(T err)
+	{
+		sumerr += err;
+		const T diff = err - lasterr;
+		lasterr = err;
+		return P * err + I * sumerr + D * diff;
+	}
+};
+
+/// \struct ScalarReport
+/// \brief Raport dokładności przebiegu wyjścia pętli w typie niższej precyzji względem double.
+struct ScalarReport
+{
+	ScalarType type = ScalarType::Float; ///< Porównywany typ.
+	size_t steps = 0; ///< Liczba kroków.
+	double maxAbs = 0; ///< Największy błąd bezwzględny wyjścia.
+	double rms = 0; ///< Błąd średniokwadratowy wyjścia.
+	double maxRel = 0; ///< Największy błąd bezwzględny odniesiony do max |y| przebiegu double.
+	size_t firstBad = 0; ///< Pierwsza chwila z błędem względnym większym niż 1e-3 (steps - brak).
+
+	/// \brief Wypisuje raport.
+	friend std::ostream& operator<<(std::ostream& os, const ScalarReport& r)
+	{
+		os << json(r.type).get<std::string>() << " vs double, " << r.steps << " krokow: max |dy| = " << r.maxAbs
+			<< ", RMS = " << r.rms << ", max |dy| / max |y| = " << r.maxRel;
+		if (r.firstBad < r.steps)
+			os << ", blad > 1e-3 od chwili " << r.firstBad;
+		return os;
+	}
+};
@@ -1,5 +1,17 @@
 #include "Signal.h"
 
+#include "FFT.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
 /**
  * @brief Konstruktor klasy SignalHdl.
  *
@@ -66,6 +78,18 @@ void to_json(json& j, const SignalHdl& o)
 	case SignalType::Triangle:
 		obj = *static_cast<SignalTriangle*>(o.ptr.get());
 		break;
+	case SignalType::Multisine:
+		obj = *static_cast<SignalMultisine*>(o.ptr.get());
+		break;
+	case SignalType::ChirpLin:
+		obj = *static_cast<SignalChirpLin*>(o.ptr.get());
+		break;
+	case SignalType::ChirpExp:
+		obj = *static_cast<SignalChirpExp*>(o.ptr.get());
+		break;
+	case SignalType::Recorded:
+		obj = *static_cast<SignalRecorded*>(o.ptr.get());
+		break;
 	case SignalType::Delay:
 		obj = *static_cast<SignalDelay*>(o.ptr.get());
 		break;
@@ -103,13 +127,25 @@ void from_json(const json& j, SignalHdl& o)
 		o = SignalHdl::make<SignalImpulse>(j["p"]);
 		break;
 	case SignalType::Sine:
-		o = SignalHdl::make<SignalSine>(j["p"]);
+		o = SignalHdl::make<SignalSine>(j["p"].get<SignalSine>());
 		break;
 	case SignalType::Square:
-		o = SignalHdl::make<SignalSquare>(j["p"]);
+		o = SignalHdl::make<SignalSquare>(j["p"].get<SignalSquare>());
 		break;
 	case SignalType::Triangle:
-		o = SignalHdl::make<SignalTriangle>(j["p"]);
+		o = SignalHdl::make<SignalTriangle>(j["p"].get<SignalTriangle>());
+		break;
+	case SignalType::Multisine:
+		o = SignalHdl::make<SignalMultisine>(j["p"].get<SignalMultisine>());
+		break;
+	case SignalType::ChirpLin:
+		o = SignalHdl::make<SignalChirpLin>(j["p"].get<SignalChirpLin>());
+		break;
+	case SignalType::ChirpExp:
+		o = SignalHdl::make<SignalChirpExp>(j["p"].get<SignalChirpExp>());
+		break;
+	case SignalType::Recorded:
+		o = SignalHdl::make<SignalRecorded>(j["p"].get<SignalRecorded>());
 		break;
 	case SignalType::Delay:
 		o = SignalHdl::make<SignalDelay>(j["p"]);
@@ -119,3 +155,532 @@ void from_json(const json& j, SignalHdl& o)
 		break;
 	}
 }
+
+namespace
+{
+	/// Co ile próbek faza rekurencji jest synchronizowana z dokładnym wzorem.
+	constexpr size_t CHIRP_RESYNC = 64;
+
+	/// Dopuszczalny błąd fazy rekurencji (w cyklach) między synchronizacjami.
+	constexpr double CHIRP_TOL = 1e-9;
+
+	/**
+	 * @brief Wypełnia blok próbek rekurencją fazy trzeciego rzędu.
+	 *
+	 * Wskaz z = exp(j * fi) jest obracany o w = exp(j * dfi), w o r = exp(j * d2fi), a r o s = exp(j * d3fi),
+	 * co odpowiada przyrostom fazy dfi + n * d2fi + n * (n - 1) / 2 * d3fi.
+	 * @param out Bufor wyjściowy.
+	 * @param c0 Faza początkowa w cyklach.
+	 * @param d1 Pierwsza różnica fazy w cyklach.
+	 * @param d2 Druga różnica fazy w cyklach.
+	 * @param d3 Trzecia różnica fazy w cyklach.
+	 */
+	void chirpRecurrence(std::span<double> out, double c0, double d1, double d2, double d3)
+	{
+		constexpr double TAU = 2 * std::numbers::pi;
+		Complex z = std::polar(1.0, TAU * c0);
+		Complex w = std::polar(1.0, TAU * d1);
+		Complex r = std::polar(1.0, TAU * d2);
+		const Complex s = std::polar(1.0, TAU * d3);
+
+		for (double& v : out)
+		{
+			v = z.imag();
+			z *= w;
+			w *= r;
+			r *= s;
+		}
+	}
+}
+
+/**
+ * @brief Wypełnia blok próbek chirpu liniowego rekurencją fazy.
+ * @param i0 Indeks pierwszej próbki bloku.
+ * @param out Bufor wyjściowy.
+ */
+void SignalChirpLin::fill(size_t i0, std::span<double> out) const
+{
+	const double d2 = (F1 - F0) / L;
+	for (size_t n = 0; n < out.size();)
+	{
+		size_t t = (i0 + n) % L;
+		size_t cnt = std::min({ CHIRP_RESYNC, out.size() - n, L - t });
+		double d1 = F0 + (F1 - F0) * (2.0 * t + 1) / (2.0 * L);
+
+		chirpRecurrence(out.subspan(n, cnt), cycles(t), d1, d2, 0);
+		n += cnt;
+	}
+}
+
+/**
+ * @brief Wypełnia blok próbek chirpu wykładniczego rekurencją fazy.
+ * @param i0 Indeks pierwszej próbki bloku.
+ * @param out Bufor wyjściowy.
+ */
+void SignalChirpExp::fill(size_t i0, std::span<double> out) const
+{
+	const double lr = std::log(F1 / F0);
+	const double qm1 = std::expm1(lr / L); ///< q - 1, gdzie q = r^(1/L) to iloraz kolejnych częstotliwości
+	for (size_t n = 0; n < out.size();)
+	{
+		size_t t = (i0 + n) % L;
+		size_t cnt = std::min({ CHIRP_RESYNC, out.size() - n, L - t });
+		double d1 = (lr == 0) ? F0 : F0 * L * std::exp(lr * t / L) * qm1 / lr;
+
+		/// Skrócenie bloku tak, aby błąd fazy rzędu d1 * (q - 1)^3 * n^4 / 24 nie przekroczył tolerancji
+		if (lr != 0)
+		{
+			double nmax = std::pow(24 * CHIRP_TOL / (d1 * std::pow(std::abs(qm1), 3)), 0.25);
+			if (nmax < cnt)
+				cnt = std::max<size_t>(size_t(nmax), 1);
+		}
+
+		chirpRecurrence(out.subspan(n, cnt), cycles(t), d1, d1 * qm1, d1 * qm1 * qm1);
+		n += cnt;
+	}
+}
+
+/**
+ * @brief Sprawdza parametry chirpu liniowego.
+ */
+void SignalChirpLin::validate() const
+{
+	if (L == 0)
+		throw std::invalid_argument("Chirp sweep length must be positive!");
+}
+
+/**
+ * @brief Serializacja obiektu SignalChirpLin do formatu JSON.
+ * @param j Obiekt JSON, do którego zostanie zapisana serializacja.
+ * @param o Obiekt SignalChirpLin, który ma zostać zserializowany.
+ */
+void to_json(json& j, const SignalChirpLin& o)
+{
+	j["F0"] = o.F0;
+	j["F1"] = o.F1;
+	j["L"] = o.L;
+}
+
+/**
+ * @brief Deserializacja obiektu SignalChirpLin z formatu JSON.
+ * @param j Obiekt JSON, który ma zostać zdeserializowany.
+ * @param o Obiekt SignalChirpLin, do którego zostanie zapisana deserializacja.
+ */
+void from_json(const json& j, SignalChirpLin& o)
+{
+	j.at("F0").get_to(o.F0);
+	j.at("F1").get_to(o.F1);
+	j.at("L").get_to(o.L);
+
+	o.validate();
+}
+
+/**
+ * @brief Sprawdza parametry chirpu wykładniczego.
+ */
+void SignalChirpExp::validate() const
+{
+	if (L == 0)
+		throw std::invalid_argument("Chirp sweep length must be positive!");
+	if (!(F0 > 0 && F1 > 0))
+		throw std::invalid_argument("Exponential chirp frequencies must be positive!");
+}
+
+/**
+ * @brief Serializacja obiektu SignalChirpExp do formatu JSON.
+ * @param j Obiekt JSON, do którego zostanie zapisana serializacja.
+ * @param o Obiekt SignalChirpExp, który ma zostać zserializowany.
+ */
+void to_json(json& j, const SignalChirpExp& o)
+{
+	j["F0"] = o.F0;
+	j["F1"] = o.F1;
+	j["L"] = o.L;
+}
+
+/**
+ * @brief Deserializacja obiektu SignalChirpExp z formatu JSON.
+ * @param j Obiekt JSON, który ma zostać zdeserializowany.
+ * @param o Obiekt SignalChirpExp, do którego zostanie zapisana deserializacja.
+ */
+void from_json(const json& j, SignalChirpExp& o)
+{
+	j.at("F0").get_to(o.F0);
+	j.at("F1").get_to(o.F1);
+	j.at("L").get_to(o.L);
+
+	o.validate();
+}
+
+/**
+ * @brief Konstruktor klasy SignalMultisine.
+ *
+ * Zapamiętuje parametry sygnału i od razu syntetyzuje jeden jego okres.
+ * @param n Okres sygnału w próbkach.
+ * @param l Numery prążków.
+ * @param a Amplitudy prążków.
+ * @param ph Sposób doboru faz.
+ * @param s Ziarno generatora faz losowych.
+ */
+SignalMultisine::SignalMultisine(size_t n, std::vector<size_t> l, std::vector<double> a, MultisinePhase ph, unsigned s)
+	: N(n), lines(std::move(l)), amps(std::move(a)), phase(ph), seed(s)
+{
+	synthesize();
+}
+
+/**
+ * @brief Syntetyzuje jeden okres sygnału wielosinusoidalnego.
+ *
+ * Widmo okresu jest budowane bezpośrednio z listy prążków (z zachowaniem symetrii hermitowskiej),
+ * a próbki w dziedzinie czasu są wyznaczane jedną odwrotną transformatą FFT.
+ * Składowa o numerze l ma postać a * cos(2 * pi * l * i / N + fi).
+ */
+void SignalMultisine::synthesize()
+{
+	if (N == 0)
+		throw std::invalid_argument("Multisine period must be positive!");
+	if (lines.size() != amps.size())
+		throw std::invalid_argument("Multisine lines and amplitudes differ in size!");
+
+	std::vector<Complex> X(N);
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<double> uni(0, 2 * std::numbers::pi);
+
+	const size_t F = lines.size();
+	for (size_t f = 0; f < F; ++f)
+	{
+		const size_t l = lines[f] % N;
+
+		/// Fazy Schroedera: fi_f = -pi * f * (f + 1) / F (numeracja składowych od zera)
+		double fi = (phase == MultisinePhase::Schroeder) ? -std::numbers::pi * f * (f + 1) / F : uni(rng);
+
+		if (l == 0 || 2 * l == N)
+			X[l] += amps[f] * std::cos(fi) * double(N); ///< Składowa stała i Nyquista są rzeczywiste
+		else
+		{
+			Complex c = std::polar(amps[f] * N / 2.0, fi);
+			X[l] += c;
+			X[N - l] += std::conj(c);
+		}
+	}
+
+	fft(X, true);
+
+	table.resize(N);
+	for (size_t i = 0; i < N; ++i)
+		table[i] = X[i].real() / N;
+}
+
+/**
+ * @brief Serializacja obiektu SignalMultisine do formatu JSON.
+ *
+ * Zapisywane są wyłącznie parametry sygnału, tablica okresu jest odtwarzana przy wczytywaniu.
+ * @param j Obiekt JSON, do którego zostanie zapisana serializacja.
+ * @param o Obiekt SignalMultisine, który ma zostać zserializowany.
+ */
+void to_json(json& j, const SignalMultisine& o)
+{
+	j["N"] = o.N;
+	j["lines"] = o.lines;
+	j["amps"] = o.amps;
+	j["phase"] = o.phase;
+	j["seed"] = o.seed;
+}
+
+/**
+ * @brief Deserializacja obiektu SignalMultisine z formatu JSON.
+ *
+ * Po wczytaniu parametrów syntetyzowany jest jeden okres sygnału.
+ * @param j Obiekt JSON, który ma zostać zdeserializowany.
+ * @param o Obiekt SignalMultisine, do którego zostanie zapisana deserializacja.
+ */
+void from_json(const json& j, SignalMultisine& o)
+{
+	/// Obiekt jest zastępowany w całości dopiero po udanej syntezie (błędne dane nie zostawiają N niezgodnego z tablicą)
+	o = SignalMultisine(j.at("N").get<size_t>(), j.at("lines").get<std::vector<size_t>>(), j.at("amps").get<std::vector<double>>(),
+		j.value("phase", MultisinePhase::Schroeder), j.value("seed", 0u));
+}
+
+namespace
+{
+	/// Znacznik nagłówka binarnego pliku pomocniczego tworzonego z pliku CSV.
+	constexpr char RECORD_MAGIC[8] = { 'A', 'R', 'X', 'R', 'E', 'C', '3', '\0' };
+
+	/// \brief Nagłówek binarnego pliku pomocniczego (próbki następują bezpośrednio po nim).
+	struct RecordHeader
+	{
+		char magic[8]; ///< Znacznik RECORD_MAGIC.
+		uint64_t fingerprint; ///< Odcisk pliku CSV (fingerprintFNV1a, obejmuje rozmiar).
+		int64_t mtime; ///< Czas modyfikacji pliku CSV z chwili konwersji.
+		uint64_t hash; ///< Pełny skrót FNV-1a pliku CSV z chwili konwersji.
+		uint64_t column; ///< Numer kolumny pliku CSV.
+		uint64_t count; ///< Liczba próbek.
+	};
+
+	/**
+	 * @brief Zwraca czas modyfikacji pliku.
+	 * @param path Ścieżka pliku.
+	 * @return Czas modyfikacji w jednostkach zegara systemu plików (0, gdy nie da się go odczytać).
+	 */
+	int64_t modificationTime(const std::string& path)
+	{
+		std::error_code ec;
+		const auto t = std::filesystem::last_write_time(path, ec);
+		return ec ? 0 : int64_t(t.time_since_epoch().count());
+	}
+
+	/**
+	 * @brief Zamienia skrót na napis szesnastkowy.
+	 * @param h Skrót.
+	 * @return Napis szesnastkowy o długości 16 znaków.
+	 */
+	std::string hashToHex(uint64_t h)
+	{
+		char buf[17];
+		for (int i = 15; i >= 0; --i, h >>= 4)
+			buf[i] = "0123456789abcdef"[h & 0xF];
+		buf[16] = '\0';
+		return buf;
+	}
+
+	/**
+	 * @brief Konwertuje plik CSV do binarnego pliku pomocniczego.
+	 *
+	 * Z każdego wiersza pobierana jest kolumna column (separatory ',', ';' lub tabulacja); wiersze, w których
+	 * nie da się jej zinterpretować jako liczby (np. nagłówek) lub których jest za mało kolumn, są pomijane.
+	 * Konwersja i tak czyta cały plik, więc w nagłówku zapisywany jest też jego pełny skrót. Plik pomocniczy
+	 * jest zapisywany pod nazwą tymczasową i przemianowywany, więc przerwana konwersja nie zostawia niepełnego pliku.
+	 * @param csv Odwzorowany plik CSV.
+	 * @param fingerprint Odcisk pliku CSV zapisywany w nagłówku.
+	 * @param mtime Czas modyfikacji pliku CSV zapisywany w nagłówku.
+	 * @param column Numer kolumny.
+	 * @param out Ścieżka pliku pomocniczego.
+	 */
+	void convertCSV(const MappedFile& csv, uint64_t fingerprint, int64_t mtime, size_t column, const std::string& out)
+	{
+		std::vector<double> v;
+		const char* p = reinterpret_cast<const char*>(csv.data());
+		const char* end = p + csv.size();
+
+		while (p < end)
+		{
+			const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+			if (!eol)
+				eol = end;
+
+			/// Przejście do początku kolumny column
+			const char* b = p;
+			for (size_t c = 0; c < column && b; ++c)
+			{
+				b = std::find_if(b, eol, [](char ch) { return ch == ',' || ch == ';' || ch == '\t'; });
+				b = b < eol ? b + 1 : nullptr;
+			}
+
+			if (b)
+			{
+				while (b < eol && (*b == ' ' || *b == '\t'))
+					++b;
+				double x;
+				auto res = std::from_chars(b, eol, x);
+				if (res.ec == std::errc())
+					v.push_back(x);
+			}
+
+			p = eol + 1;
+		}
+
+		RecordHeader h{};
+		std::memcpy(h.magic, RECORD_MAGIC, sizeof(RECORD_MAGIC));
+		h.fingerprint = fingerprint;
+		h.mtime = mtime;
+		h.hash = hashFNV1a(csv.data(), csv.size());
+		h.column = column;
+		h.count = v.size();
+
+		const std::string tmp = out + ".tmp";
+		{
+			std::ofstream ofs(tmp, std::ios::binary);
+			ofs.write(reinterpret_cast<const char*>(&h), sizeof(h));
+			ofs.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(double));
+			if (!ofs)
+			{
+				ofs.close();
+				std::remove(tmp.c_str());
+				throw std::runtime_error("Cannot write record sidecar " + out);
+			}
+		}
+		std::error_code ec;
+		std::filesystem::rename(tmp, out, ec);
+		if (ec)
+		{
+			std::remove(tmp.c_str());
+			throw std::runtime_error("Cannot write record sidecar " + out);
+		}
+	}
+
+	/**
+	 * @brief Próbuje odwzorować istniejący plik pomocniczy utworzony z pliku CSV o podanym odcisku, czasie modyfikacji i kolumnie.
+	 *
+	 * Sam odcisk nie wykrywa zmian poza próbkowanymi blokami, dlatego warunkiem ponownego użycia jest też
+	 * niezmieniony czas modyfikacji pliku CSV.
+	 * @param path Ścieżka pliku pomocniczego.
+	 * @param fingerprint Oczekiwany odcisk pliku CSV.
+	 * @param mtime Oczekiwany czas modyfikacji pliku CSV.
+	 * @param column Oczekiwany numer kolumny.
+	 * @return Odwzorowanie pliku lub nullptr, gdy plik nie istnieje lub jest nieaktualny.
+	 */
+	std::shared_ptr<const MappedFile> mapSidecar(const std::string& path, uint64_t fingerprint, int64_t mtime, size_t column)
+	{
+		std::shared_ptr<const MappedFile> f;
+		try
+		{
+			f = std::make_shared<const MappedFile>(path);
+		}
+		catch (const std::runtime_error&)
+		{
+			return nullptr;
+		}
+
+		RecordHeader h;
+		if (f->size() < sizeof(h))
+			return nullptr;
+		std::memcpy(&h, f->data(), sizeof(h));
+		if (std::memcmp(h.magic, RECORD_MAGIC, sizeof(RECORD_MAGIC)) || h.fingerprint != fingerprint || h.mtime != mtime || h.column != column || f->size() != sizeof(h) + h.count * sizeof(double))
+			return nullptr;
+		return f;
+	}
+}
+
+/**
+ * @brief Konstruktor klasy SignalRecorded.
+ * @param p Ścieżka do pliku z przebiegiem.
+ * @param f Format pliku.
+ * @param in Czy stosować interpolację liniową.
+ * @param lp Czy zapętlać nagranie.
+ * @param st Liczba próbek nagrania na iterację symulacji.
+ * @param col Numer kolumny pliku CSV z próbkami.
+ */
+SignalRecorded::SignalRecorded(std::string p, RecordFormat f, bool in, bool lp, double st, size_t col)
+	: path(std::move(p)), format(f), interp(in), loop(lp), step(st), column(col)
+{
+	open();
+}
+
+/**
+ * @brief Otwiera plik z przebiegiem i weryfikuje jego odcisk oraz skrót.
+ *
+ * Plik binarny jest odwzorowywany bezpośrednio. Dla pliku CSV używany jest plik pomocniczy (ścieżka + ".bin"),
+ * tworzony tylko wtedy, gdy nie istnieje lub został utworzony z innej wersji pliku CSV (odcisk, czas modyfikacji)
+ * albo z innej kolumny. Odcisk odczytuje tylko kilka bloków pliku, więc odwzorowanie pozostaje leniwe. Pełny skrót
+ * pliku CSV pochodzi z nagłówka pliku pomocniczego; skrót pliku binarnego jest liczony (z odczytem całego pliku)
+ * tylko wtedy, gdy został zapisany w JSON.
+ */
+void SignalRecorded::open()
+{
+	auto src = std::make_shared<const MappedFile>(path);
+	const uint64_t fp = fingerprintFNV1a(src->data(), src->size());
+	if (!fingerprint.empty() && fingerprint != hashToHex(fp))
+		throw std::runtime_error("Recorded signal file " + path + " does not match the stored fingerprint!");
+	fingerprint = hashToHex(fp);
+
+	size_t offset = 0;
+	uint64_t full = 0;
+	if (format == RecordFormat::CSV)
+	{
+		const std::string side = path + ".bin";
+		const int64_t mtime = modificationTime(path);
+		file = mapSidecar(side, fp, mtime, column);
+		if (!file)
+		{
+			convertCSV(*src, fp, mtime, column, side);
+			file = mapSidecar(side, fp, mtime, column);
+			if (!file)
+				throw std::runtime_error("Cannot map record sidecar " + side);
+		}
+		offset = sizeof(RecordHeader);
+		std::memcpy(&full, file->data() + offsetof(RecordHeader, hash), sizeof(full));
+	}
+	else
+	{
+		if (!hash.empty())
+			full = hashFNV1a(src->data(), src->size());
+		file = std::move(src);
+	}
+
+	if (!hash.empty() && hash != hashToHex(full))
+		throw std::runtime_error("Recorded signal file " + path + " does not match the stored hash!");
+	if (format == RecordFormat::CSV)
+		hash = hashToHex(full);
+
+	samples = reinterpret_cast<const double*>(file->data() + offset);
+	count = (file->size() - offset) / sizeof(double);
+	file->adviseSequential();
+}
+
+/**
+ * @brief Wypełnia blok kolejnych próbek nagrania.
+ * @param i0 Indeks pierwszej próbki bloku.
+ * @param out Bufor wyjściowy.
+ */
+void SignalRecorded::fill(size_t i0, std::span<double> out) const
+{
+	if (interp || step != 1 || count == 0)
+		return Signal::fill(i0, out);
+
+	for (size_t n = 0; n < out.size();)
+	{
+		size_t idx = i0 + n;
+		if (idx >= count && !loop)
+		{
+			std::fill(out.begin() + n, out.end(), samples[count - 1]); ///< Podtrzymanie ostatniej próbki
+			return;
+		}
+		idx = wrap(idx);
+		size_t cnt = std::min(out.size() - n, count - idx);
+		std::memcpy(out.data() + n, samples + idx, cnt * sizeof(double));
+		n += cnt;
+	}
+}
+
+/**
+ * @brief Serializacja obiektu SignalRecorded do formatu JSON.
+ *
+ * Zapisywane są tylko ścieżka, odcisk, pełny skrót (jeśli jest znany), format i opcje odtwarzania (dla CSV także
+ * kolumna) - próbki pozostają w pliku.
+ * @param j Obiekt JSON, do którego zostanie zapisana serializacja.
+ * @param o Obiekt SignalRecorded, który ma zostać zserializowany.
+ */
+void to_json(json& j, const SignalRecorded& o)
+{
+	j["path"] = o.path;
+	j["fingerprint"] = o.fingerprint;
+	if (!o.hash.empty())
+		j["hash"] = o.hash;
+	j["format"] = o.format;
+	j["interp"] = o.interp;
+	j["loop"] = o.loop;
+	j["step"] = o.step;
+	if (o.format == RecordFormat::CSV)
+		j["column"] = o.column;
+}
+
+/**
+ * @brief Deserializacja obiektu SignalRecorded z formatu JSON.
+ *
+ * Po wczytaniu parametrów plik jest odwzorowywany w pamięci, a jego odcisk i skrót porównywane z zapisanymi.
+ * @param j Obiekt JSON, który ma zostać zdeserializowany.
+ * @param o Obiekt SignalRecorded, do którego zostanie zapisana deserializacja.
+ */
+void from_json(const json& j, SignalRecorded& o)
+{
+	j.at("path").get_to(o.path);
+	o.fingerprint = j.value("fingerprint", std::string());
+	o.hash = j.value("hash", std::string());
+	o.format = j.value("format", RecordFormat::Binary);
+	o.interp = j.value("interp", false);
+	o.loop = j.value("loop", false);
+	o.step = j.value("step", 1.0);
+	o.column = j.value("column", size_t(0));
+
+	o.open();
+}
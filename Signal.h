@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <vector>
+#include <span>
 
 #include <cmath>
 #include <numbers>
@@ -10,6 +11,8 @@
 #include "json.hpp" ///< Wczytanie biblioteki "json.hpp", która umożliwia serializację i deserializację obiektów JSON.
 using json = nlohmann::json;
 
+#include "MappedFile.h"
+
 
 using SignalEnumT = int8_t;
 /// \enum SignalType
@@ -22,6 +25,10 @@ enum SignalType : SignalEnumT
 	Sine, ///< Sygnał sinusoidalny.
 	Square, ///< Sygnał kwadratowy.
 	Triangle, ///< Sygnał trójkątny.
+	Multisine, ///< Sygnał wielosinusoidalny (suma harmonicznych jednego okresu).
+	ChirpLin, ///< Sygnał świergotowy o liniowo narastającej częstotliwości.
+	ChirpExp, ///< Sygnał świergotowy o wykładniczo narastającej częstotliwości.
+	Recorded, ///< Sygnał odtwarzany z zarejestrowanego przebiegu zapisanego w pliku.
 
 	Delay = std::numeric_limits<SignalEnumT>::min(),
 };
@@ -38,19 +45,52 @@ enum SignalType : SignalEnumT
 //	}
 //)
 
+/// \enum MultisinePhase
+/// \brief Sposób doboru faz składowych sygnału wielosinusoidalnego.
+enum class MultisinePhase
+{
+	Schroeder, ///< Fazy Schroedera minimalizujące współczynnik szczytu.
+	Random, ///< Fazy losowe o rozkładzie jednostajnym.
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(MultisinePhase,
+	{
+		{ MultisinePhase::Schroeder, "schroeder" },
+		{ MultisinePhase::Random, "random" },
+	}
+)
+
+/// \enum RecordFormat
+/// \brief Format pliku z zarejestrowanym przebiegiem.
+enum class RecordFormat
+{
+	Binary, ///< Surowe próbki typu double (kolejność bajtów maszyny).
+	CSV, ///< Plik tekstowy, jedna próbka w wierszu (wybrana kolumna, separatory ',', ';' lub tabulacja).
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(RecordFormat,
+	{
+		{ RecordFormat::Binary, "bin" },
+		{ RecordFormat::CSV, "csv" },
+	}
+)
+
 /// Klasa reprezentuje sygnał.
 class Signal;
 
 /// \typedef SignalHdl
 /// \brief Typ wskaźnika na obiekt klasy Signal.
+///
+/// Sygnały są niezmienne (get() i fill() są stałe), więc kopie uchwytu współdzielą ten sam obiekt sygnału
+/// (np. odwzorowanie pliku SignalRecorded) zamiast go odtwarzać.
 class SignalHdl
 {
-	using SignalPtr = std::unique_ptr<Signal>; 
+	using SignalPtr = std::shared_ptr<Signal>; 
 	SignalPtr ptr; 
 public:
 	SignalHdl() = default; ///< Konstruktor domyślny klasy SignalHdl.
-	SignalHdl(const SignalHdl&) = delete; ///< Konstruktor kopiujący klasy SignalHdl.
-	SignalHdl& operator=(const SignalHdl&) = delete; ///< Przypisanie kopii klasy SignalHdl.
+	SignalHdl(const SignalHdl&) = default; ///< Konstruktor kopiujący klasy SignalHdl (współdzieli sygnał).
+	SignalHdl& operator=(const SignalHdl&) = default; ///< Przypisanie kopii klasy SignalHdl (współdzieli sygnał).
 	SignalHdl(SignalHdl&&) = default; ///< Konstruktor przenoszący klasy SignalHdl.
 	SignalHdl& operator=(SignalHdl&&) = default; ///< Przypisanie przeniesienia klasy SignalHdl.
 
@@ -78,7 +118,7 @@ public:
 	static SignalHdl make(Args&&... args)
 	{
 		//SignalPtr sp = std::unique_ptr<T>(new T(std::forward<Args>(args)...));
-		SignalPtr sp = std::make_unique<T>(std::forward<Args>(args)...);
+		SignalPtr sp = std::make_shared<T>(std::forward<Args>(args)...);
 		return SignalHdl(std::move(sp));
 	}
 };
@@ -105,6 +145,21 @@ public:
 	*/
 	virtual double get(size_t) const = 0;
 
+	/**
+	* @brief Metoda wypełniająca blok kolejnych próbek sygnału.
+	*
+	* Domyślna implementacja wywołuje get() dla każdej próbki. Klasy pochodne mogą ją nadpisać
+	* wydajniejszym algorytmem rekurencyjnym.
+	*
+	* @param i0 Indeks pierwszej próbki bloku.
+	* @param out Bufor, do którego zostaną zapisane próbki o indeksach i0, i0 + 1, ...
+	*/
+	virtual void fill(size_t i0, std::span<double> out) const
+	{
+		for (size_t n = 0; n < out.size(); ++n)
+			out[n] = get(i0 + n);
+	}
+
 	/**
 	* @brief Metoda zwracająca typ sygnału. 
 	* @return Typ sygnału.
@@ -191,9 +246,12 @@ public:
 /// \brief Klasa reprezentująca sygnał sinusoidalny.
 class SignalSine : public Signal
 {
-	double T; ///< Okres sygnału.
+	double T = 1; ///< Okres sygnału.
 
 public:
+	/// \brief Konstruktor domyślny klasy SignalSine (używany przy wczytywaniu z formatu JSON).
+	SignalSine() = default;
+
 	/// \brief Konstruktor klasy SignalSine.
 	/// \param t Okres sygnału.
 	SignalSine(double t) : T(t) {}
@@ -228,14 +286,181 @@ public:
 	NLOHMANN_DEFINE_TYPE_INTRUSIVE(SignalSine, T); 
 };
 
+/// \class SignalChirpLin
+/// \brief Klasa reprezentująca sygnał świergotowy (chirp) o liniowo narastającej częstotliwości.
+///
+/// Częstotliwość chwilowa zmienia się liniowo od F0 do F1 (w cyklach na próbkę) w ciągu L próbek,
+/// po czym przebieg się powtarza. Faza w cyklach wynosi F0 * t + (F1 - F0) * t^2 / (2 * L), gdzie t = i mod L.
+class SignalChirpLin : public Signal
+{
+	double F0 = 0; ///< Częstotliwość początkowa w cyklach na próbkę.
+	double F1 = 0.5; ///< Częstotliwość końcowa w cyklach na próbkę.
+	size_t L = 1; ///< Długość przemiatania w próbkach.
+
+public:
+	/// \brief Konstruktor domyślny klasy SignalChirpLin.
+	SignalChirpLin() = default;
+
+	/// \brief Konstruktor klasy SignalChirpLin.
+	/// \param f0 Częstotliwość początkowa w cyklach na próbkę.
+	/// \param f1 Częstotliwość końcowa w cyklach na próbkę.
+	/// \param l Długość przemiatania w próbkach.
+	/// \throws std::invalid_argument Gdy długość przemiatania jest zerowa.
+	SignalChirpLin(double f0, double f1, size_t l) : F0(f0), F1(f1), L(l)
+	{
+		validate();
+	}
+
+	/// \brief Sprawdza parametry przemiatania.
+	/// \throws std::invalid_argument Gdy długość przemiatania jest zerowa.
+	void validate() const;
+
+	/// \brief Wirtualny destruktor klasy SignalChirpLin.
+	~SignalChirpLin() = default;
+
+	/**
+	* @brief Faza sygnału w cyklach, zredukowana do przedziału [0, 1).
+	* @param t Indeks próbki w obrębie jednego przemiatania.
+	* @return Część ułamkowa fazy.
+	*/
+	double cycles(size_t t) const
+	{
+		double trash;
+		double c = F0 * t + (F1 - F0) * (double(t) * t / (2.0 * L));
+		return std::modf(c, &trash);
+	}
+
+	/**
+	* @brief Metoda pobierająca wartość sygnału dla określonego indeksu.
+	*
+	* Wartość jest obliczana dokładnie ze wzoru na fazę: sin(2 * pi * faza(i mod L)).
+	*
+	* @param i Indeks sygnału.
+	* @return Wartość sygnału świergotowego dla podanego indeksu.
+	*/
+	double get(size_t i) const override
+	{
+		return std::sin(2 * std::numbers::pi * cycles(i % L));
+	}
+
+	/**
+	* @brief Metoda wypełniająca blok kolejnych próbek sygnału.
+	*
+	* Próbki są wyznaczane rekurencją fazy (obrót wskazu zespolonego), bez funkcji trygonometrycznych w każdej próbce.
+	* Dla chirpu liniowego druga różnica fazy jest stała, więc rekurencja jest dokładna (z dokładnością do zaokrągleń).
+	*
+	* @param i0 Indeks pierwszej próbki bloku.
+	* @param out Bufor wyjściowy.
+	*/
+	void fill(size_t i0, std::span<double> out) const override;
+
+	/**
+	 * @brief Metoda zwracająca typ sygnału.
+	 * @return Typ sygnału, który jest `SignalType::ChirpLin`.
+	 */
+	SignalType type() const override
+	{
+		return SignalType::ChirpLin;
+	}
+
+	friend void to_json(json& j, const SignalChirpLin& o); ///< Funkcja serializująca obiekt SignalChirpLin do formatu JSON.
+	friend void from_json(const json& j, SignalChirpLin& o); ///< Funkcja deserializująca obiekt SignalChirpLin z formatu JSON (z walidacją parametrów).
+};
+
+/// \class SignalChirpExp
+/// \brief Klasa reprezentująca sygnał świergotowy (chirp) o wykładniczo narastającej częstotliwości.
+///
+/// Częstotliwość chwilowa rośnie wykładniczo od F0 do F1 (w cyklach na próbkę) w ciągu L próbek,
+/// po czym przebieg się powtarza. Faza w cyklach wynosi F0 * L * (r^(t/L) - 1) / ln(r), gdzie r = F1 / F0, t = i mod L.
+class SignalChirpExp : public Signal
+{
+	double F0 = 0.001; ///< Częstotliwość początkowa w cyklach na próbkę (dodatnia).
+	double F1 = 0.5; ///< Częstotliwość końcowa w cyklach na próbkę (dodatnia).
+	size_t L = 1; ///< Długość przemiatania w próbkach.
+
+public:
+	/// \brief Konstruktor domyślny klasy SignalChirpExp.
+	SignalChirpExp() = default;
+
+	/// \brief Konstruktor klasy SignalChirpExp.
+	/// \param f0 Częstotliwość początkowa w cyklach na próbkę.
+	/// \param f1 Częstotliwość końcowa w cyklach na próbkę.
+	/// \param l Długość przemiatania w próbkach.
+	/// \throws std::invalid_argument Gdy długość przemiatania jest zerowa lub częstotliwości nie są dodatnie.
+	SignalChirpExp(double f0, double f1, size_t l) : F0(f0), F1(f1), L(l)
+	{
+		validate();
+	}
+
+	/// \brief Sprawdza parametry przemiatania.
+	/// \throws std::invalid_argument Gdy długość przemiatania jest zerowa lub częstotliwości nie są dodatnie.
+	void validate() const;
+
+	/// \brief Wirtualny destruktor klasy SignalChirpExp.
+	~SignalChirpExp() = default;
+
+	/**
+	* @brief Faza sygnału w cyklach, zredukowana do przedziału [0, 1).
+	* @param t Indeks próbki w obrębie jednego przemiatania.
+	* @return Część ułamkowa fazy.
+	*/
+	double cycles(size_t t) const
+	{
+		double trash;
+		double lr = std::log(F1 / F0);
+		double c = (lr == 0) ? F0 * t : F0 * L * std::expm1(lr * t / L) / lr;
+		return std::modf(c, &trash);
+	}
+
+	/**
+	* @brief Metoda pobierająca wartość sygnału dla określonego indeksu.
+	*
+	* Wartość jest obliczana dokładnie ze wzoru na fazę: sin(2 * pi * faza(i mod L)).
+	*
+	* @param i Indeks sygnału.
+	* @return Wartość sygnału świergotowego dla podanego indeksu.
+	*/
+	double get(size_t i) const override
+	{
+		return std::sin(2 * std::numbers::pi * cycles(i % L));
+	}
+
+	/**
+	* @brief Metoda wypełniająca blok kolejnych próbek sygnału.
+	*
+	* Próbki są wyznaczane rekurencją fazy trzeciego rzędu, a faza jest co kilkadziesiąt próbek
+	* synchronizowana z dokładnym wzorem. Błąd fazy między synchronizacjami jest rzędu F * (q - 1)^3 * n^4,
+	* gdzie q = (F1 / F0)^(1 / L), więc dla bardzo stromych przemiatań blok synchronizacji jest skracany.
+	*
+	* @param i0 Indeks pierwszej próbki bloku.
+	* @param out Bufor wyjściowy.
+	*/
+	void fill(size_t i0, std::span<double> out) const override;
+
+	/**
+	 * @brief Metoda zwracająca typ sygnału.
+	 * @return Typ sygnału, który jest `SignalType::ChirpExp`.
+	 */
+	SignalType type() const override
+	{
+		return SignalType::ChirpExp;
+	}
+
+	friend void to_json(json& j, const SignalChirpExp& o); ///< Funkcja serializująca obiekt SignalChirpExp do formatu JSON.
+	friend void from_json(const json& j, SignalChirpExp& o); ///< Funkcja deserializująca obiekt SignalChirpExp z formatu JSON (z walidacją parametrów).
+};
+
 /// \class SignalSquare
 /// \brief Klasa reprezentująca sygnał kwadratowy.
 class SignalSquare : public Signal
 {
-	double T; ///< Okres sygnału.
-	double D; ///< Współczynnik wypełnienia sygnału.
+	double T = 1; ///< Okres sygnału.
+	double D = 0.5; ///< Współczynnik wypełnienia sygnału.
 
 public:
+	/// \brief Konstruktor domyślny klasy SignalSquare (używany przy wczytywaniu z formatu JSON).
+	SignalSquare() = default;
+
 	/// \brief Konstruktor klasy SignalSquare.
 	/// \param t Okres sygnału.
 	/// \param d Współczynnik wypełnienia sygnału. Domyślnie 0.5.
@@ -278,9 +503,12 @@ public:
 /// \brief Klasa reprezentująca sygnał trójkątny.
 class SignalTriangle : public Signal
 {
-	double T; ///< Okres sygnału.
+	double T = 1; ///< Okres sygnału.
 
 public:
+	/// \brief Konstruktor domyślny klasy SignalTriangle (używany przy wczytywaniu z formatu JSON).
+	SignalTriangle() = default;
+
 	/// \brief Konstruktor klasy SignalTriangle.
 	/// \param t Okres sygnału.
 	SignalTriangle(double t) : T(t) {}
@@ -388,3 +616,174 @@ public:
 	// Makro definiujące informacje o typie SignalDelay niezbędne do serializacji/deserializacji z/do formatu JSON.
 	NLOHMANN_DEFINE_TYPE_INTRUSIVE(SignalDelay, D, S); 
 };
+
+/// \class SignalMultisine
+/// \brief Klasa reprezentująca sygnał wielosinusoidalny (multisine).
+///
+/// Sygnał jest sumą kosinusoid o częstotliwościach będących wielokrotnościami 1/N (prążki widma).
+/// Jeden okres jest syntetyzowany odwrotną transformatą FFT i przechowywany w tablicy,
+/// dzięki czemu pobranie próbki nie zależy od liczby składowych. Synteza jest jednorazowa (konstruktor,
+/// from_json), ale jej koszt zależy od rozkładu N na czynniki: dla N o małych czynnikach wynosi
+/// O(N log N), a dla N pierwszego (lub z dużym czynnikiem pierwszym p) fft() wykonuje zwykłą DFT
+/// - O(N^2) (O(N p)). Długie okresy warto więc wybierać jako potęgi dwójki lub iloczyny małych liczb.
+/// Obiekt domyślny (N = 1, bez prążków) jest sygnałem zerowym.
+class SignalMultisine : public Signal
+{
+	size_t N = 1; ///< Okres sygnału w próbkach.
+	std::vector<size_t> lines; ///< Numery prążków (częstotliwość prążka l wynosi l/N).
+	std::vector<double> amps; ///< Amplitudy kolejnych prążków.
+	MultisinePhase phase = MultisinePhase::Schroeder; ///< Sposób doboru faz.
+	unsigned seed = 0; ///< Ziarno generatora faz losowych.
+
+	std::vector<double> table = { 0.0 }; ///< Próbki jednego okresu sygnału (N próbek).
+
+	/// \brief Syntetyzuje jeden okres sygnału i zapisuje go w tablicy.
+	void synthesize();
+
+public:
+	/// \brief Konstruktor domyślny klasy SignalMultisine.
+	SignalMultisine() = default;
+
+	/// \brief Konstruktor klasy SignalMultisine.
+	/// \param n Okres sygnału w próbkach.
+	/// \param l Numery prążków.
+	/// \param a Amplitudy prążków.
+	/// \param ph Sposób doboru faz. Domyślnie fazy Schroedera.
+	/// \param s Ziarno generatora faz losowych. Domyślnie 0.
+	SignalMultisine(size_t n, std::vector<size_t> l, std::vector<double> a, MultisinePhase ph = MultisinePhase::Schroeder, unsigned s = 0);
+
+	/// \brief Wirtualny destruktor klasy SignalMultisine.
+	~SignalMultisine() = default;
+
+	/**
+	* @brief Metoda pobierająca wartość sygnału dla określonego indeksu.
+	*
+	* Ta metoda zwraca próbkę z tablicy okresu o indeksie i mod N.
+	*
+	* @param i Indeks sygnału.
+	* @return Wartość sygnału wielosinusoidalnego dla podanego indeksu.
+	*/
+	double get(size_t i) const override
+	{
+		return table[i % N];
+	}
+
+	/**
+	 * @brief Metoda zwracająca typ sygnału.
+	 * @return Typ sygnału, który jest `SignalType::Multisine`.
+	 */
+	SignalType type() const override
+	{
+		return SignalType::Multisine;
+	}
+
+	friend void to_json(json& j, const SignalMultisine& o); ///< Funkcja serializująca obiekt SignalMultisine do formatu JSON.
+	friend void from_json(const json& j, SignalMultisine& o); ///< Funkcja deserializująca obiekt SignalMultisine z formatu JSON.
+};
+
+/// \class SignalRecorded
+/// \brief Klasa reprezentująca sygnał odtwarzany z pliku z zarejestrowanym przebiegiem.
+///
+/// Plik binarny jest odwzorowywany w pamięci bez kopiowania. Plik CSV jest jednorazowo konwertowany
+/// do pliku binarnego obok niego (ścieżka + ".bin"), który przy kolejnych wczytaniach jest używany ponownie,
+/// o ile odcisk i czas modyfikacji pliku CSV oraz wybrana kolumna się nie zmieniły. W formacie JSON zapisywana
+/// jest tylko ścieżka, odcisk, skrót, format i opcje odtwarzania. Odcisk (fingerprintFNV1a) obejmuje rozmiar
+/// i kilka próbkowanych bloków pliku, więc wczytanie nie odczytuje całego nagrania - strony odwzorowania są
+/// wczytywane dopiero przy odtwarzaniu; wykrywa podmianę pliku, ale nie każdą zmianę jego treści. Pełny skrót
+/// (hashFNV1a) pliku CSV jest liczony raz przy konwersji; dla pliku binarnego jest weryfikowany tylko na żądanie.
+class SignalRecorded : public Signal
+{
+	std::string path; ///< Ścieżka do pliku z przebiegiem.
+	std::string fingerprint; ///< Odcisk pliku źródłowego (fingerprintFNV1a, szesnastkowo). Pusty - bez weryfikacji.
+	std::string hash; ///< Pełny skrót pliku źródłowego (hashFNV1a, szesnastkowo). Pusty - bez weryfikacji (plik binarny - bez odczytu całego pliku).
+	RecordFormat format = RecordFormat::Binary; ///< Format pliku.
+	bool interp = false; ///< Czy stosować interpolację liniową między próbkami.
+	bool loop = false; ///< Czy po końcu nagrania odtwarzać je od początku (w przeciwnym razie podtrzymanie ostatniej próbki).
+	double step = 1; ///< Liczba próbek nagrania przypadająca na jedną iterację symulacji.
+	size_t column = 0; ///< Numer kolumny pliku CSV z próbkami (od 0).
+
+	std::shared_ptr<const MappedFile> file; ///< Odwzorowany w pamięci plik z próbkami.
+	const double* samples = nullptr; ///< Wskaźnik na pierwszą próbkę w odwzorowaniu.
+	size_t count = 0; ///< Liczba próbek.
+
+	/// Odległość (w próbkach) wczytywania z wyprzedzeniem przy dostępie sekwencyjnym.
+	static constexpr size_t PREFETCH_AHEAD = 64;
+
+	/// \brief Otwiera plik z przebiegiem (ewentualnie konwertując CSV) i weryfikuje odcisk oraz skrót.
+	void open();
+
+	/**
+	* @brief Zamienia pozycję w nagraniu na indeks próbki z uwzględnieniem zapętlenia lub podtrzymania.
+	* @param n Indeks próbki (może przekraczać długość nagrania).
+	* @return Indeks próbki w zakresie [0, count).
+	*/
+	size_t wrap(size_t n) const
+	{
+		if (n < count)
+			return n;
+		return loop ? n % count : count - 1;
+	}
+
+public:
+	/// \brief Konstruktor domyślny klasy SignalRecorded.
+	SignalRecorded() = default;
+
+	/// \brief Konstruktor klasy SignalRecorded.
+	/// \param p Ścieżka do pliku z przebiegiem.
+	/// \param f Format pliku. Domyślnie binarny.
+	/// \param in Czy stosować interpolację liniową. Domyślnie nie.
+	/// \param lp Czy zapętlać nagranie. Domyślnie nie.
+	/// \param st Liczba próbek nagrania na iterację symulacji. Domyślnie 1.
+	/// \param col Numer kolumny pliku CSV z próbkami. Domyślnie 0.
+	SignalRecorded(std::string p, RecordFormat f = RecordFormat::Binary, bool in = false, bool lp = false, double st = 1, size_t col = 0);
+
+	/// \brief Wirtualny destruktor klasy SignalRecorded.
+	~SignalRecorded() = default;
+
+	/**
+	* @brief Metoda pobierająca wartość sygnału dla określonego indeksu.
+	*
+	* Czas dostępu jest stały. Próbki leżące dalej w nagraniu są wczytywane z wyprzedzeniem,
+	* co przyspiesza typowy dostęp sekwencyjny.
+	*
+	* @param i Indeks sygnału.
+	* @return Wartość nagrania dla podanego indeksu.
+	*/
+	double get(size_t i) const override
+	{
+		if (count == 0)
+			return 0;
+
+		double x = i * step;
+		size_t n = size_t(x);
+		size_t idx = wrap(n);
+		prefetchRead(samples + wrap(idx + PREFETCH_AHEAD));
+
+		double frac = x - n;
+		if (!interp || frac == 0 || (!loop && n + 1 >= count))
+			return samples[idx];
+		return samples[idx] + frac * (samples[wrap(idx + 1)] - samples[idx]);
+	}
+
+	/**
+	* @brief Metoda wypełniająca blok kolejnych próbek sygnału.
+	*
+	* Bez interpolacji i przy kroku 1 próbki są kopiowane całymi fragmentami bezpośrednio z odwzorowania.
+	*
+	* @param i0 Indeks pierwszej próbki bloku.
+	* @param out Bufor wyjściowy.
+	*/
+	void fill(size_t i0, std::span<double> out) const override;
+
+	/**
+	 * @brief Metoda zwracająca typ sygnału.
+	 * @return Typ sygnału, który jest `SignalType::Recorded`.
+	 */
+	SignalType type() const override
+	{
+		return SignalType::Recorded;
+	}
+
+	friend void to_json(json& j, const SignalRecorded& o); ///< Funkcja serializująca obiekt SignalRecorded do formatu JSON.
+	friend void from_json(const json& j, SignalRecorded& o); ///< Funkcja deserializująca obiekt SignalRecorded z formatu JSON.
+};
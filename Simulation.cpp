@@ -4,14 +4,69 @@
 /// Klasa ta odpowiada za przeprowadzanie symulacji oraz zapisywanie parametrów symulacji do pliku w formacie JSON.
 
 #include "Simulation.h"
+#include "TraceCache.h"
 #include <string>
 #include <iostream> 
 #include <fstream>
+#include <sstream>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 
 /// Dołączenie biblioteki json.hpp i nadanie jej aliasu json
 #include "json.hpp"
 using json = nlohmann::json;
 
+namespace
+{
+	/**
+	 * @brief Zapisuje parametry symulacji (bez stanu dynamicznego) do obiektu JSON.
+	 * @param s Symulacja.
+	 * @return Obiekt JSON w formacie pliku konfiguracyjnego.
+	 */
+	json parameters(const Simulation& s)
+	{
+		json j;
+		j["ARX"] = s.arx;
+		j["PID"] = s.pid;
+		j["gen"] = s.gen;
+		j["len"] = s.len;
+		if (!s.dist.empty())
+			j["dist"] = s.dist;
+		if (!s.noise.empty())
+			j["noise"] = s.noise;
+		if (s.scalar != ScalarType::Double)
+			j["scalar"] = s.scalar;
+		return j;
+	}
+
+	/**
+	 * @brief Wczytuje parametry symulacji z obiektu JSON w formacie pliku konfiguracyjnego.
+	 * @param s Symulacja.
+	 * @param j Obiekt JSON.
+	 */
+	void setParameters(Simulation& s, const json& j)
+	{
+		s.arx = j.at("ARX");
+		s.pid = j.at("PID");
+		s.gen = j.at("gen");
+		s.len = j.at("len");
+
+		/// Kanały zakłócenia i szumu pomiarowego są opcjonalne
+		if (j.contains("dist"))
+			s.dist = j.at("dist");
+		if (j.contains("noise"))
+			s.noise = j.at("noise");
+
+		/// Typ liczb pętli jest opcjonalny (domyślnie double)
+		if (j.contains("scalar"))
+			s.scalar = j.at("scalar");
+	}
+}
+
 /**
  * @brief Konstruktor klasy Simulation.
  *
@@ -40,11 +95,7 @@ Simulation::Simulation(const std::string& file)
 		std::ifstream ifs(file); ///< Otwarcie pliku o podanej nazwie za pomocą strumienia wejściowego.
 		json j = json::parse(ifs); ///< Parsowanie zawartości pliku jako obiekt JSON.
 
-		arx = j["ARX"];
-		pid = j["PID"];
-		gen = j["gen"];
-		len = j["len"];
-
+		setParameters(*this, j);
 	}
 
 	/// \brief Obsługa wyjątków typu std::exception.
@@ -62,21 +113,45 @@ Simulation::Simulation(const std::string& file)
 Simulation::Simulation() : len(0) {}
 
 /**
- * @brief Metoda wykonująca symulację.
+ * @brief Wczytuje symulację z pliku JSON.
+ * @param file Nazwa pliku.
+ * @return Wczytana symulacja.
+ */
+Simulation Simulation::load(const std::string& file)
+{
+	std::ifstream ifs(file);
+	if (!ifs)
+		throw std::runtime_error("Cannot open simulation file " + file + "!");
+
+	Simulation s;
+	try
+	{
+		setParameters(s, json::parse(ifs));
+	}
+	catch (const std::exception& e)
+	{
+		throw std::runtime_error("Invalid simulation file " + file + ": " + e.what());
+	}
+	return s;
+}
+
+/**
+ * @brief Pętla symulacji dla podanego modelu i regulatora.
  *
- * Metoda run wykonuje symulację o zadanej liczbie iteracji.
- * Dla każdej iteracji, obliczane są wartości punktu zadanej, błędu regulacji, sygnału sterującego i wyjścia obiektu ARX.
- * Informacje dotyczące iteracji i obliczonych wartości są wypisywane na standardowe wyjście.
+ * Model i regulator to obiekty ARX i PID albo ich odpowiedniki typu T (ScalarARX, ScalarPID);
+ * sygnały generatorów są liczone w double i zaokrąglane do typu T przy wejściu do pętli (forEachStep).
  *
- * @param iter Liczba iteracji symulacji.
- * @param arxout Aktualna wartość wyjścia modelu ARX.
- * @param setp Wartość zadana.
- * @param err Błąd regulacji.
- * @param ster Sygnał sterujący.
+ * @param model Model obiektu.
+ * @param reg Regulator.
  * @param fout Nazwa pliku, do którego zostaną zapisane wyniki symulacji.
  */
-void Simulation::run(const std::string& fout)
+template <class M, class C>
+void Simulation::loop(M& model, C& reg, const std::string& fout)
 {
+	using T = decltype(reg.sim(0)); ///< Typ liczb pętli
+
+	const bool channels = !dist.empty() || !noise.empty(); ///< Czy w pętli występuje zakłócenie lub szum pomiarowy
+
 	bool log = false;
 	std::ofstream out;
 	if (!fout.empty())
@@ -85,28 +160,71 @@ void Simulation::run(const std::string& fout)
 		if (out)
 		{
 			log = true;
-			out << "Iteracja,Zadana,Blad,Sterowanie,Wyjscie" << std::endl;
+			out << "Iteracja,Zadana,Blad,Sterowanie,Wyjscie";
+			if (channels)
+				out << ",Zaklocenie,Szum";
+			out << std::endl;
 		}
 	}
 
-	double arxout = 0;
-	double setp = 0, err = 0, ster = 0;
-
-	for (size_t i = 0; i <= len; ++i)
+	forEachStep<T>(reg, [&](T in, size_t) { return model.sim(in); }, [&](const LoopSample<T>& s)
 	{
-		setp = gen.get(i);
-
-		err = setp - arxout;
-		ster = pid.sim(err);
-		//ster = setp;
-
-		arxout = arx.sim(ster);
-
-		std::cout << "It: " << i << "\tSetp: " << setp << "\tErr: " << err << "\tSter: " << ster << "\tARX: " << arxout << std::endl;
+		const T setp = T(s.r);
+		std::cout << "It: " << s.i << "\tSetp: " << setp << "\tErr: " << s.err << "\tSter: " << s.u << "\tARX: " << s.y << std::endl;
 
 		if (log)
-			out << i << "," << setp << "," << err << "," << ster << "," << arxout << std::endl;
+		{
+			out << s.i << "," << setp << "," << s.err << "," << s.u << "," << s.y;
+			if (channels)
+				out << "," << s.d << "," << s.v;
+			out << std::endl;
+		}
+		return true;
+	});
+}
+
+/**
+ * @brief Metoda wykonująca symulację.
+ *
+ * Metoda run wykonuje symulację o zadanej liczbie iteracji.
+ * Dla każdej iteracji, obliczane są wartości punktu zadanej, błędu regulacji, sygnału sterującego i wyjścia obiektu ARX.
+ * Wartość zadana, zakłócenie wejściowe i szum pomiarowy są generowane blokami po BLOCK próbek przed wewnętrzną pętlą,
+ * która jedynie odczytuje przygotowane bufory (bufory są alokowane raz, przed rozpoczęciem symulacji).
+ * Informacje dotyczące iteracji i obliczonych wartości są wypisywane na standardowe wyjście.
+ * Dla typu scalar innego niż double pętla jest liczona na kopiach ScalarARX i ScalarPID (stan obiektów arx i pid nie zmienia się).
+ * Jeśli ustawiono plant lub controller, pętla używa ich w miejsce arx lub pid (przez interfejs SISO, w double).
+ *
+ * @param fout Nazwa pliku, do którego zostaną zapisane wyniki symulacji.
+ */
+void Simulation::run(const std::string& fout)
+{
+	if (plant || controller)
+	{
+		SISO& m = plant ? *plant : static_cast<SISO&>(arx);
+		SISO& c = controller ? *controller : static_cast<SISO&>(pid);
+		loop(m, c, fout);
+		return;
+	}
 
+	switch (scalar)
+	{
+	case ScalarType::Float:
+	{
+		ScalarARX<float> a(arx);
+		ScalarPID<float> p(pid);
+		loop(a, p, fout);
+		break;
+	}
+	case ScalarType::LongDouble:
+	{
+		ScalarARX<long double> a(arx);
+		ScalarPID<long double> p(pid);
+		loop(a, p, fout);
+		break;
+	}
+	default:
+		loop(arx, pid, fout);
+		break;
 	}
 }
 
@@ -124,12 +242,7 @@ void Simulation::save(const std::string& file)
 {
 	try
 	{
-		json j; ///< Tworzenie obiektu json
-	
-		j["ARX"] = arx;
-		j["PID"] = pid;
-		j["gen"] = gen;
-		j["len"] = len;
+		json j = parameters(*this); ///< Tworzenie obiektu json
 
 		std::ofstream out(file); ///< Otwarcie pliku
 		out << std::setw(4) << j << std::endl;
@@ -140,3 +253,408 @@ void Simulation::save(const std::string& file)
 		std::cerr << e.what() << std::endl;
 	}
 }
+
+/**
+ * @brief Metoda wykonująca jedną iterację symulacji krokowej.
+ * @return Wyjście obiektu.
+ */
+double Simulation::step()
+{
+	LoopSample<double> x;
+	x.i = iter;
+	x.r = gen.get(iter);
+	x.d = dist.get(iter);
+	x.v = noise.get(iter);
+	x.y = out;
+	loopStep(x, pid, [this](double in, size_t) { return arx.step(in, gauss(rng)); });
+	out = x.y;
+	iter++;
+	return out;
+}
+
+/**
+ * @brief Metoda wykonująca jedną iterację symulacji krokowej z przebiegami sygnałów.
+ * @param tr Przebiegi sygnałów.
+ * @return Wyjście obiektu.
+ */
+double Simulation::step(const TraceCache& tr)
+{
+	LoopSample<double> x;
+	x.i = iter;
+	x.y = out;
+	tr.step(x, pid, [this](double in, size_t) { return arx.step(in, gauss(rng)); });
+	out = x.y;
+	iter++;
+	return out;
+}
+
+/**
+ * @brief Metoda wykonująca kolejne iteracje symulacji krokowej.
+ * @param steps Największa liczba iteracji.
+ * @return Liczba wykonanych iteracji.
+ */
+size_t Simulation::advance(size_t steps)
+{
+	const size_t n = std::min(steps, iter <= len ? len + 1 - iter : 0);
+	for (size_t i = 0; i < n; ++i)
+		step();
+	return n;
+}
+
+/**
+ * @brief Metoda ustawiająca ziarno generatora szumu symulacji krokowej.
+ * @param seed Ziarno.
+ */
+void Simulation::seedNoise(uint32_t seed)
+{
+	rng.seed(seed);
+	gauss.reset();
+}
+
+namespace
+{
+	/// Sygnatura binarnego zapisu stanu symulacji (wraz z wersją formatu).
+	constexpr char CHECKPOINT_MAGIC[8] = { 'A', 'R', 'X', 'S', 'I', 'M', 'C', '2' };
+
+	/**
+	 * @brief Zapisuje binarnie wartość typu trywialnego.
+	 * @param os Strumień.
+	 * @param v Wartość.
+	 */
+	template <class T>
+	void writeRaw(std::ostream& os, const T& v)
+	{
+		os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+	}
+
+	/**
+	 * @brief Odczytuje binarnie wartość typu trywialnego.
+	 * @param is Strumień.
+	 * @return Wartość.
+	 * @throws std::runtime_error Gdy strumień się skończył.
+	 */
+	template <class T>
+	T readRaw(std::istream& is)
+	{
+		T v{};
+		if (!is.read(reinterpret_cast<char*>(&v), sizeof(T)))
+			throw std::runtime_error("Truncated simulation checkpoint!");
+		return v;
+	}
+
+	/**
+	 * @brief Zapisuje wektor liczb poprzedzony jego długością.
+	 * @param os Strumień.
+	 * @param v Liczby.
+	 */
+	void writeDoubles(std::ostream& os, std::span<const double> v)
+	{
+		writeRaw<uint64_t>(os, v.size());
+		os.write(reinterpret_cast<const char*>(v.data()), std::streamsize(v.size() * sizeof(double)));
+	}
+
+	/**
+	 * @brief Odczytuje wektor liczb zapisany przez writeDoubles().
+	 * @param is Strumień.
+	 * @param n Oczekiwana długość wektora.
+	 * @return Liczby.
+	 * @throws std::runtime_error Gdy długość się nie zgadza lub strumień się skończył.
+	 */
+	std::vector<double> readDoubles(std::istream& is, size_t n)
+	{
+		std::vector<double> v(size_t(readRaw<uint64_t>(is)));
+		if (v.size() != n)
+			throw std::runtime_error("Simulation checkpoint state does not match the model!");
+		if (!is.read(reinterpret_cast<char*>(v.data()), std::streamsize(v.size() * sizeof(double))))
+			throw std::runtime_error("Truncated simulation checkpoint!");
+		return v;
+	}
+
+	/**
+	 * @brief Zapisuje napis poprzedzony jego długością.
+	 * @param os Strumień.
+	 * @param str Napis.
+	 */
+	void writeString(std::ostream& os, const std::string& str)
+	{
+		writeRaw<uint64_t>(os, str.size());
+		os.write(str.data(), std::streamsize(str.size()));
+	}
+
+	/**
+	 * @brief Odczytuje napis zapisany przez writeString().
+	 * @param is Strumień.
+	 * @return Napis.
+	 * @throws std::runtime_error Gdy strumień się skończył.
+	 */
+	std::string readString(std::istream& is)
+	{
+		std::string str(size_t(readRaw<uint64_t>(is)), '\0');
+		if (!is.read(str.data(), std::streamsize(str.size())))
+			throw std::runtime_error("Truncated simulation checkpoint!");
+		return str;
+	}
+}
+
+/**
+ * @brief Metoda zapisująca binarnie pełny stan symulacji.
+ *
+ * Format: sygnatura, parametry JSON, iter, out, sumerr, lasterr, stan ARX i stan splotu blokowego
+ * PartitionedConv (każdy jako długość i próbki) oraz tekstowy stan generatora i rozkładu szumu (jedyny przenośny zapis std::mt19937).
+ * Liczby są zapisywane w porządku bajtów komputera.
+ * @param os Strumień binarny.
+ */
+void Simulation::checkpoint(std::ostream& os) const
+{
+	os.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+	writeString(os, parameters(*this).dump());
+	writeRaw<uint64_t>(os, iter);
+	writeRaw(os, out);
+	writeRaw(os, pid.sumerr);
+	writeRaw(os, pid.lasterr);
+
+	writeDoubles(os, arx.state());
+	writeDoubles(os, arx.conv.state());
+
+	std::ostringstream r;
+	r << rng << ' ' << gauss;
+	writeString(os, r.str());
+
+	if (!os)
+		throw std::runtime_error("Cannot write simulation checkpoint!");
+}
+
+/**
+ * @brief Metoda zapisująca binarnie pełny stan symulacji do pliku.
+ * @param file Nazwa pliku.
+ */
+void Simulation::checkpoint(const std::string& file) const
+{
+	std::ofstream os(file, std::ios::binary);
+	checkpoint(os);
+}
+
+/**
+ * @brief Metoda odtwarzająca pełny stan symulacji.
+ *
+ * Stan jest najpierw wczytywany do obiektu tymczasowego - przy błędzie symulacja się nie zmienia.
+ * @param is Strumień binarny.
+ */
+void Simulation::restore(std::istream& is)
+{
+	char magic[sizeof(CHECKPOINT_MAGIC)];
+	if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), CHECKPOINT_MAGIC))
+		throw std::runtime_error("Not a simulation checkpoint!");
+
+	Simulation s;
+	try
+	{
+		setParameters(s, json::parse(readString(is)));
+	}
+	catch (const json::exception& e)
+	{
+		throw std::runtime_error(std::string("Invalid simulation checkpoint parameters: ") + e.what());
+	}
+	s.iter = size_t(readRaw<uint64_t>(is));
+	s.out = readRaw<double>(is);
+	s.pid.sumerr = readRaw<double>(is);
+	s.pid.lasterr = readRaw<double>(is);
+
+	s.arx.setState(readDoubles(is, s.arx.stateSize()));
+	try
+	{
+		s.arx.conv.setState(readDoubles(is, s.arx.conv.stateSize())); ///< Faza bloku splotu (odtworzenie historii jej nie zachowuje)
+	}
+	catch (const std::invalid_argument& e)
+	{
+		throw std::runtime_error(std::string("Invalid simulation checkpoint convolution state: ") + e.what());
+	}
+
+	std::istringstream r(readString(is));
+	if (!(r >> s.rng >> s.gauss))
+		throw std::runtime_error("Invalid simulation checkpoint noise state!");
+
+	s.plant = std::move(plant);
+	s.controller = std::move(controller);
+	*this = std::move(s);
+}
+
+/**
+ * @brief Metoda odtwarzająca pełny stan symulacji z pliku.
+ * @param file Nazwa pliku.
+ */
+void Simulation::restore(const std::string& file)
+{
+	std::ifstream is(file, std::ios::binary);
+	if (!is)
+		throw std::runtime_error("Cannot open simulation checkpoint " + file + "!");
+	restore(is);
+}
+
+/**
+ * @brief Metoda klonująca symulację razem z jej stanem dynamicznym.
+ * @return Kopia symulacji.
+ */
+Simulation Simulation::fork() const
+{
+	Simulation s;
+	s.arx = arx;
+	s.pid = pid;
+	s.gen = gen;
+	s.dist = dist;
+	s.noise = noise;
+	s.len = len;
+	s.scalar = scalar;
+	s.iter = iter;
+	s.out = out;
+	s.rng = rng;
+	s.gauss = gauss;
+	return s;
+}
+
+/**
+ * @brief Porównuje przebieg wyjścia pętli w typie type z przebiegiem w double.
+ *
+ * Sygnały i szum ARX są wyznaczane raz dla całego horyzontu i podawane obu przebiegom.
+ *
+ * @param type Porównywany typ.
+ * @return Raport dokładności.
+ */
+ScalarReport Simulation::compare(ScalarType type)
+{
+	const size_t N = len + 1;
+	std::vector<double> e(N);
+	for (double& v : e)
+		v = ARX::getNoise();
+
+	/// Przebieg pętli (krok jak w run()) z tymi samymi próbkami szumu modelu ARX
+	auto trajectory = [&](auto model, auto reg)
+	{
+		using T = decltype(reg.sim(0));
+		std::vector<double> y(N);
+		this->template forEachStep<T>(reg, [&](T in, size_t i) { return model.step(in, T(e[i])); },
+			[&](const LoopSample<T>& s) { y[s.i] = double(s.y); return true; });
+		return y;
+	};
+
+	const std::vector<double> ref = trajectory(arx, pid);
+	std::vector<double> y;
+	switch (type)
+	{
+	case ScalarType::Float:
+		y = trajectory(ScalarARX<float>(arx), ScalarPID<float>(pid));
+		break;
+	case ScalarType::LongDouble:
+		y = trajectory(ScalarARX<long double>(arx), ScalarPID<long double>(pid));
+		break;
+	default:
+		y = trajectory(ScalarARX<double>(arx), ScalarPID<double>(pid));
+		break;
+	}
+
+	ScalarReport r;
+	r.type = type;
+	r.steps = N;
+	double ymax = 0, sq = 0;
+	for (size_t i = 0; i < N; ++i)
+	{
+		const double dy = std::abs(y[i] - ref[i]);
+		r.maxAbs = std::max(r.maxAbs, dy);
+		sq += dy * dy;
+		ymax = std::max(ymax, std::abs(ref[i]));
+	}
+	r.rms = N ? std::sqrt(sq / N) : 0;
+	r.maxRel = ymax > 0 ? r.maxAbs / ymax : r.maxAbs;
+	r.firstBad = N;
+	for (size_t i = 0; i < N; ++i)
+		if (std::abs(y[i] - ref[i]) > 1e-3 * ymax)
+		{
+			r.firstBad = i;
+			break;
+		}
+	return r;
+}
+
+/**
+ * @brief Wyznacza stacjonarne wariancje sygnałów pętli.
+ *
+ * Stan po chwili t: [y(t), ..., y(t - ny + 1), u(t), ..., u(t - nu + 1), sumerr(t) (gdy I != 0), lasterr(t)],
+ * gdzie ny = max(na, 1), nu = max(k + nb - 1, 1). Kolumny F i wektor g są wyznaczane krokiem pętli
+ * zastosowanym do wektorów jednostkowych (krok jest liniowy względem stanu i szumu).
+ * @return Raport wariancji.
+ */
+VarianceReport Simulation::variance() const
+{
+	const size_t na = arx.A.size(), nb = arx.B.size();
+	const size_t ny = std::max<size_t>(na, 1), nu = std::max<size_t>(arx.k + nb, 2) - 1;
+	const bool integral = pid.I != 0;
+	const size_t iu = ny, is = ny + nu, il = is + (integral ? 1 : 0), N = il + 1;
+	if (N > MAX_VARIANCE_STATE)
+		throw std::invalid_argument("Loop state is too large for the Lyapunov solver!");
+
+	/// Krok pętli: e(t + 1) = -y(t), PID, y(t + 1) = sum B_j u(t + 1 - k - j) - sum A_j y(t - j) + ns_var w
+	auto advance = [&](const std::vector<double>& x, double w)
+	{
+		const double err = -x[0];
+		const double sum = (integral ? x[is] : 0) + err;
+		const double u = pid.P * err + pid.I * sum + pid.D * (err - x[il]);
+
+		double y = arx.ns_var * w;
+		for (size_t j = 0; j < nb; ++j)
+		{
+			const size_t lag = arx.k + j;
+			y += arx.B[j] * (lag ? x[iu + lag - 1] : u);
+		}
+		for (size_t j = 0; j < na; ++j)
+			y -= arx.A[j] * x[j];
+
+		std::vector<double> xn(N);
+		xn[0] = y;
+		std::copy(x.begin(), x.begin() + (ny - 1), xn.begin() + 1);
+		xn[iu] = u;
+		std::copy(x.begin() + iu, x.begin() + (iu + nu - 1), xn.begin() + (iu + 1));
+		if (integral)
+			xn[is] = sum;
+		xn[il] = err;
+		return xn;
+	};
+
+	Matrix F(N, N), Q(N, N);
+	std::vector<double> x(N);
+	for (size_t c = 0; c < N; ++c)
+	{
+		x[c] = 1;
+		const std::vector<double> col = advance(x, 0);
+		for (size_t r = 0; r < N; ++r)
+			F(r, c) = col[r];
+		x[c] = 0;
+	}
+	const std::vector<double> g = advance(x, 1);
+	for (size_t r = 0; r < N; ++r)
+		for (size_t c = 0; c < N; ++c)
+			Q(r, c) = g[r] * g[c];
+
+	VarianceReport rep;
+	rep.states = N;
+	Matrix P;
+	try
+	{
+		P = dlyap(F, Q, 64, &rep.iterations);
+	}
+	catch (const std::runtime_error&)
+	{
+		return rep;
+	}
+
+	const size_t idx[3] = { 0, iu, il };
+	rep.stable = true;
+	rep.cov = Matrix(3, 3);
+	for (size_t r = 0; r < 3; ++r)
+		for (size_t c = 0; c < 3; ++c)
+			rep.cov(r, c) = P(idx[r], idx[c]);
+	rep.varY = rep.cov(0, 0);
+	rep.varU = rep.cov(1, 1);
+	rep.varErr = rep.cov(2, 2);
+	rep.varSum = integral ? P(is, is) : std::numeric_limits<double>::infinity();
+	return rep;
+}
@@ -3,21 +3,105 @@
 #include "ARX.h"
 #include "PID.h"
 #include "Generator.h"
+#include "Scalar.h"
+#include "LinAlg.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <span>
 #include <string>
+#include <utility>
+#include <vector>
+
+class TraceCache;
+
+/// \struct VarianceReport
+/// \brief Stacjonarne momenty drugiego rzędu sygnałów pętli wywołane szumem modelu ARX.
+struct VarianceReport
+{
+	bool stable = false; ///< Czy pętla jest stabilna (równanie Lapunowa ma rozwiązanie).
+	size_t states = 0; ///< Wymiar stanu pętli.
+	size_t iterations = 0; ///< Liczba podwojeń algorytmu dlyap.
+	Matrix cov; ///< Kowariancja sygnałów (y, u, e) - wyjścia, sterowania i błędu regulacji.
+	double varY = 0; ///< Wariancja wyjścia obiektu.
+	double varU = 0; ///< Wariancja sterowania.
+	double varErr = 0; ///< Wariancja błędu regulacji.
+	double varSum = 0; ///< Wariancja sumy błędów regulatora (+inf, gdy I = 0 - suma błądzi losowo).
+
+	/// \brief Wypisuje raport.
+	friend std::ostream& operator<<(std::ostream& os, const VarianceReport& r)
+	{
+		if (!r.stable)
+			return os << "petla niestabilna - brak rozkladu stacjonarnego";
+		return os << "stan " << r.states << ", " << r.iterations << " podwojen: var y = " << r.varY << ", var u = " << r.varU
+			<< ", var e = " << r.varErr << ", var sumerr = " << r.varSum << ", cov(y, u) = " << r.cov(0, 1);
+	}
+};
+
+/// \struct LoopSample
+/// \brief Jedna chwila pętli regulacji przekazywana przez Simulation::forEachStep.
+/// \tparam T Typ liczb pętli.
+template <typename T>
+struct LoopSample
+{
+	size_t i = 0; ///< Indeks chwili.
+	double r = 0; ///< Wartość zadana (z generatora, w double).
+	double d = 0; ///< Zakłócenie wejściowe (z generatora, w double).
+	double v = 0; ///< Szum pomiarowy (z generatora, w double).
+	T err = 0; ///< Błąd regulacji r - (y + v), liczony z wyjściem poprzedniej chwili.
+	T u = 0; ///< Sterowanie (wyjście regulatora, bez zakłócenia).
+	T y = 0; ///< Wyjście obiektu.
+};
+
+/// \brief Krok pętli regulacji jak w Simulation::run: err = r - (y + v), u = reg.sim(err), y = model(u + d, i).
+/// \tparam T Typ liczb pętli.
+/// \param s Próbka z wypełnionymi i, r, d, v i wyjściem poprzedniej chwili y (po kroku - err, u i nowe y).
+/// \param reg Regulator z metodą sim(T).
+/// \param model Krok obiektu: (T wejście, size_t chwila) -> T wyjście.
+template <class T, class C, class M>
+void loopStep(LoopSample<T>& s, C& reg, M&& model)
+{
+	s.err = T(s.r) - (s.y + T(s.v));
+	s.u = reg.sim(s.err);
+	s.y = model(s.u + T(s.d), s.i);
+}
 
 /// \class Simulation
 /// \brief Klasa reprezentująca symulację systemu regulacji.
 ///
 /// Klasa Simulation składa się z dwóch obiektów: ARX i PID.
+/// Opcjonalnie do pętli można wprowadzić zakłócenie wejściowe obiektu (dodawane do sterowania)
+/// oraz szum pomiarowy (dodawany do wyjścia przekazywanego do regulatora).
+///
+/// Poza jednorazowym przebiegiem run() symulację można prowadzić krokowo (step(), advance()) -
+/// jej pełny stan (indeks iteracji, ostatnie wyjście, historie ARX, stan PID i generator szumu)
+/// można zapisać binarnie (checkpoint()), odtworzyć (restore()) albo sklonować w pamięci (fork()).
 class Simulation
 {
+	std::mt19937 rng; ///< Generator szumu ARX symulacji krokowej (domyślne ziarno jak w ARX::getNoise()).
+	std::normal_distribution<double> gauss; ///< Rozkład N(0, 1) szumu ARX symulacji krokowej.
+
 public:
 
 	ARX arx; ///< Obiekt klasy ARX reprezentujący model matematyczny systemu regulacji.
 	PID pid; ///< Obiekt klasy PID reprezentujący regulator PID systemu regulacji.
 	Generator gen; ///< Obiekt klasy Generator odpowiedzialny za generowanie danych wejściowych.
-	size_t len; ///< Długość symulacji.
+	size_t len = 0; ///< Długość symulacji.
+	Generator dist; ///< Generator zakłócenia wejściowego, dodawanego do sterowania przed obiektem. Domyślnie pusty.
+	Generator noise; ///< Generator szumu pomiarowego, dodawanego do wyjścia w torze sprzężenia zwrotnego. Domyślnie pusty.
+	std::shared_ptr<SISO> plant; ///< Opcjonalny obiekt zastępujący arx w run() (np. FixedARX). Nie jest zapisywany w JSON.
+	std::shared_ptr<SISO> controller; ///< Opcjonalny regulator zastępujący pid w run() (np. FixedPID). Nie jest zapisywany w JSON.
+	ScalarType scalar = ScalarType::Double; ///< Typ liczb pętli w run() (klucz "scalar" w JSON). Sygnały generatorów są zawsze liczone w double.
+	size_t iter = 0; ///< Indeks następnej iteracji symulacji krokowej.
+	double out = 0; ///< Ostatnie wyjście obiektu w symulacji krokowej.
+
+	/// Liczba iteracji, dla których sygnały z generatorów są wyznaczane jednym blokiem przed pętlą.
+	static constexpr size_t BLOCK = 1024;
 
 	/// \brief Konstruktor klasy Simulation.
 	/// \param arx Obiekt klasy ARX, model matematyczny systemu.
@@ -32,10 +116,25 @@ public:
 	
 	/// \brief Konstruktor domyślny klasy Simulation.
 	Simulation();
+
+	/// \brief Wczytuje symulację z pliku JSON (format save()).
+	///
+	/// W odróżnieniu od konstruktora z nazwą pliku (który zgłasza błąd tylko na std::cerr) błąd wczytania
+	/// jest zgłaszany wyjątkiem - funkcje zapisujące wynik z powrotem do pliku nie nadpiszą go wtedy parametrami domyślnymi.
+	/// \param file Nazwa pliku.
+	/// \return Wczytana symulacja.
+	/// \throws std::runtime_error Gdy pliku nie można otworzyć lub nie zawiera poprawnych parametrów symulacji.
+	static Simulation load(const std::string& file);
 	
 	/// \brief Destruktor klasy Simulation.
 	~Simulation() = default;
 
+	/// \brief Konstruktor przenoszący klasy Simulation.
+	Simulation(Simulation&&) = default;
+
+	/// \brief Operator przypisania przenoszącego dla klasy Simulation.
+	Simulation& operator=(Simulation&&) = default;
+
 	/// \brief Metoda run wykonuje symulację przez określoną liczbę iteracji dla podanego wejścia.
 	/// \param inputFilename Nazwa pliku z danymi wejściowymi.
 	void run(const std::string& = "");
@@ -44,4 +143,137 @@ public:
 	/// Wykorzystywana jest biblioteka json.hpp, która umożliwia zapisywanie danych w formacie JSON.
 	/// \param outputFilename Nazwa pliku wyjściowego.
 	void save(const std::string&);
+
+	/// \brief Wykonuje jedną iterację symulacji krokowej (krok jak w run(), w double, obiektami arx i pid).
+	///
+	/// Szum ARX pochodzi z generatora symulacji (seedNoise()), a nie ze wspólnego ARX::getNoise(),
+	/// dlatego stan zapisany przez checkpoint() lub sklonowany przez fork() kontynuuje dokładnie ten sam przebieg.
+	/// Obiekty plant i controller oraz typ scalar nie są używane.
+	/// \return Wyjście obiektu w iteracji iter (po kroku iter jest zwiększany).
+	double step();
+
+	/// \brief Wykonuje jedną iterację symulacji krokowej z sygnałami deterministycznymi z przebiegów tr.
+	///
+	/// Krok i szum ARX jak w step(), ale wartość zadana, zakłócenie i szum pomiarowy w chwili iter są
+	/// czytane z tr zamiast z generatorów - wiele sklonowanych (fork()) pętli czyta jeden wspólny przebieg.
+	/// \param tr Przebiegi sygnałów (iter musi być mniejsze niż tr.size()).
+	/// \return Wyjście obiektu w iteracji iter (po kroku iter jest zwiększany).
+	double step(const TraceCache& tr);
+
+	/// \brief Wykonuje kolejne iteracje symulacji krokowej, nie dalej niż do iteracji len.
+	/// \param steps Największa liczba iteracji. Domyślnie - do końca symulacji.
+	/// \return Liczba wykonanych iteracji.
+	size_t advance(size_t steps = std::numeric_limits<size_t>::max());
+
+	/// \brief Ustawia ziarno generatora szumu ARX symulacji krokowej.
+	/// \param seed Ziarno.
+	void seedNoise(uint32_t seed);
+
+	/// \brief Zapisuje binarnie pełny stan symulacji.
+	///
+	/// Zapisywane są parametry (jak w save(), w postaci JSON) oraz stan dynamiczny: iter, out, historie
+	/// wejść i wyjść ARX (ARX::state()), stan splotu blokowego reprezentacji Conv (wraz z fazą bloku),
+	/// sumerr i lasterr regulatora oraz stan generatora szumu.
+	/// Obiekty plant i controller nie są zapisywane.
+	/// \param os Strumień binarny.
+	/// \throws std::runtime_error Gdy zapis się nie powiódł.
+	void checkpoint(std::ostream& os) const;
+
+	/// \brief Zapisuje binarnie pełny stan symulacji do pliku.
+	/// \param file Nazwa pliku.
+	/// \throws std::runtime_error Gdy zapis się nie powiódł.
+	void checkpoint(const std::string& file) const;
+
+	/// \brief Odtwarza pełny stan symulacji zapisany przez checkpoint().
+	/// \param is Strumień binarny.
+	/// \throws std::runtime_error Gdy strumień nie zawiera poprawnego zapisu stanu.
+	void restore(std::istream& is);
+
+	/// \brief Odtwarza pełny stan symulacji z pliku zapisanego przez checkpoint().
+	/// \param file Nazwa pliku.
+	/// \throws std::runtime_error Gdy plik nie zawiera poprawnego zapisu stanu.
+	void restore(const std::string& file);
+
+	/// \brief Klonuje symulację razem z jej stanem dynamicznym (rozgałęzienie wspólnego prefiksu).
+	///
+	/// Obiekty arx i pid oraz generator szumu są kopiowane, a generatory sygnałów współdzielą z oryginałem
+	/// niezmienne obiekty sygnałów (bez ponownego wczytywania plików SignalRecorded). Klon z tym samym
+	/// generatorem szumu kontynuuje ten sam przebieg; seedNoise() daje gałąź z innym szumem.
+	/// Obiekty plant i controller nie są kopiowane.
+	/// \return Niezależna kopia symulacji.
+	Simulation fork() const;
+
+	/// \brief Porównuje przebieg wyjścia pętli w typie type z przebiegiem w double.
+	///
+	/// Oba przebiegi (forEachStep) mają te same sygnały i próbki szumu ARX i zaczynają od stanu obiektów arx i pid
+	/// (nie są one zmieniane). Przebieg double jest liczony na kopiach obiektów ARX i PID, przebieg type -
+	/// obiektami ScalarARX i ScalarPID (kopiującymi historie modelu i stan regulatora).
+	/// \param type Porównywany typ. Domyślnie float.
+	/// \return Raport dokładności.
+	ScalarReport compare(ScalarType type = ScalarType::Float);
+
+	/// \brief Wyznacza stacjonarne wariancje sygnałów pętli wywołane szumem modelu ARX (bez symulacji).
+	///
+	/// Pętla (krok jak w run(), przy zerowej wartości zadanej, zakłóceniu i szumie pomiarowym) jest
+	/// zapisywana w postaci stanowej x(t + 1) = F x(t) + g e(t + 1), gdzie e ~ N(0, 1) jest próbką
+	/// ARX::getNoise(), a stan obejmuje historię wyjść i sterowań oraz stan regulatora. Kowariancja
+	/// stanu jest rozwiązaniem równania Lapunowa P = F P F' + g g' (dlyap). Sygnały deterministyczne
+	/// (wartość zadana, zakłócenie) zmieniają tylko wartość średnią i nie wpływają na wynik.
+	/// \return Raport wariancji.
+	/// \throws std::invalid_argument Gdy wymiar stanu przekracza MAX_VARIANCE_STATE.
+	VarianceReport variance() const;
+
+	/// Największy wymiar stanu pętli, dla którego variance() rozwiązuje równanie Lapunowa.
+	static constexpr size_t MAX_VARIANCE_STATE = 512;
+
+	/// \brief Przebiega pętlę regulacji w chwilach 0, ..., len (krok jak w run()) dla podanego regulatora i obiektu.
+	///
+	/// Wartość zadana, zakłócenie i szum pomiarowy są generowane blokami po BLOCK chwil przed pętlą wewnętrzną.
+	/// W chwili i wykonywany jest loopStep (err = r - (y + v), u = reg.sim(err), y = model(u + d, i)), po czym wywoływane jest visit.
+	/// Obiekty symulacji (arx, pid) nie są używane - model i regulator podaje wywołujący.
+	/// \tparam T Typ liczb pętli.
+	/// \param reg Regulator z metodą sim(T).
+	/// \param model Krok obiektu: (T wejście, size_t chwila) -> T wyjście.
+	/// \param visit Funkcja (const LoopSample<T>&) -> bool wywoływana po każdym kroku; false przerywa przebieg.
+	/// \return Liczba wykonanych kroków.
+	template <class T, class C, class M, class V>
+	size_t forEachStep(C& reg, M&& model, V&& visit);
+
+private:
+	/// \brief Pętla symulacji run() dla podanego modelu i regulatora (ARX/PID lub ich odpowiedniki typu T).
+	/// \param model Model obiektu.
+	/// \param reg Regulator.
+	/// \param fout Nazwa pliku wynikowego.
+	template <class M, class C>
+	void loop(M& model, C& reg, const std::string& fout);
 };
+
+template <class T, class C, class M, class V>
+size_t Simulation::forEachStep(C& reg, M&& model, V&& visit)
+{
+	std::vector<double> setpBlk(BLOCK), distBlk(BLOCK), noiseBlk(BLOCK); ///< Bufory bloków sygnałów
+
+	LoopSample<T> s;
+	for (size_t b = 0; b <= len; b += BLOCK)
+	{
+		/// Generowanie bloku sygnałów przed pętlą wewnętrzną
+		std::span<double> sb(setpBlk.data(), std::min(BLOCK, len + 1 - b));
+		gen.fill(b, sb);
+		if (!dist.empty())
+			dist.fill(b, std::span(distBlk).first(sb.size()));
+		if (!noise.empty())
+			noise.fill(b, std::span(noiseBlk).first(sb.size()));
+
+		for (size_t n = 0; n < sb.size(); ++n)
+		{
+			s.i = b + n;
+			s.r = sb[n];
+			s.d = distBlk[n];
+			s.v = noiseBlk[n];
+			loopStep(s, reg, model);
+			if (!visit(std::as_const(s)))
+				return s.i + 1;
+		}
+	}
+	return len + 1;
+}
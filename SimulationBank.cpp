@@ -0,0 +1,258 @@
+/// \file SimulationBank.cpp
+/// \brief Zawiera implementację jednoczesnej symulacji wielu pętli regulacji.
+
+#include "SimulationBank.h"
+#include "Parallel.h"
+#include "TraceCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * \brief Dodaje pętlę.
+ * \param s Symulacja (jej obiekty są przenoszone do banku).
+ */
+void SimulationBank::add(Simulation&& s)
+{
+	arx.push_back(s.arx);
+	pid.push_back(s.pid);
+	gen.push_back(std::move(s.gen));
+	dist.push_back(std::move(s.dist));
+	noise.push_back(std::move(s.noise));
+	lens.push_back(s.len);
+	len = std::max(len, s.len);
+}
+
+/**
+ * \brief Dodaje pętlę wczytaną z pliku JSON.
+ * \param file Nazwa pliku w formacie Simulation::save.
+ */
+void SimulationBank::add(const std::string& file)
+{
+	add(Simulation(file));
+}
+
+/**
+ * \brief Zmienia nastawy regulatora pętli.
+ * \param i Indeks pętli.
+ * \param P Współczynnik proporcjonalny.
+ * \param I Współczynnik całkujący.
+ * \param D Współczynnik różniczkujący.
+ */
+void SimulationBank::setGains(size_t i, double P, double I, double D)
+{
+	pid.at(i).P = P;
+	pid[i].I = I;
+	pid[i].D = D;
+}
+
+/**
+ * \brief Symuluje wszystkie pętle.
+ * \param y Opcjonalny bufor wyjść.
+ * \param threads Liczba wątków.
+ */
+void SimulationBank::run(std::span<double> y, unsigned threads)
+{
+	const size_t N = size();
+	if (!y.empty() && y.size() != N * (len + 1))
+		throw std::invalid_argument("Output buffer size does not match the bank!");
+
+	iae.assign(N, 0.0);
+	ise.assign(N, 0.0);
+
+	const bool noisy = std::any_of(arx.begin(), arx.end(), [](const ARX& a) { return a.ns_var != 0; });
+	parallelFor((N + LANES - 1) / LANES, noisy ? 1 : threads, [&](size_t bi) { runBlock(bi, y, nullptr); });
+}
+
+/**
+ * \brief Symuluje wszystkie pętle na wspólnych przebiegach sygnałów.
+ * \param traces Wspólne przebiegi sygnałów.
+ * \param y Opcjonalny bufor wyjść.
+ * \param threads Liczba wątków.
+ */
+void SimulationBank::run(const TraceCache& traces, std::span<double> y, unsigned threads)
+{
+	const size_t N = size();
+	if (!y.empty() && y.size() != N * traces.size())
+		throw std::invalid_argument("Output buffer size does not match the bank!");
+
+	iae.assign(N, 0.0);
+	ise.assign(N, 0.0);
+
+	parallelFor((N + LANES - 1) / LANES, threads, [&](size_t bi) { runBlock(bi, y, &traces); });
+}
+
+/**
+ * \brief Symuluje jeden blok pętli.
+ *
+ * Krok bloku (dla każdej pętli l):
+ * e = r - (y + v), sumerr += e, u = P e + I sumerr + D (e - lasterr) + d,
+ * y = sum_j B'_j u(t - j) - sum_j A_j y(t - 1 - j) + ns_var * e_ARX,
+ * gdzie B'_{k + j} = B_j. Sygnały są generowane kaflami po Simulation::BLOCK chwil albo kopiowane
+ * ze wspólnych przebiegów traces do wszystkich pętli bloku.
+ * \param bi Indeks bloku.
+ * \param y Bufor wyjść.
+ * \param traces Wspólne przebiegi sygnałów (nullptr - brak).
+ */
+void SimulationBank::runBlock(size_t bi, std::span<double> y, const TraceCache* traces)
+{
+	constexpr size_t L = LANES;
+	const size_t m0 = bi * L, n = std::min(L, size() - m0);
+
+	/// Wymiary bloku - największe rzędy modeli w bloku
+	size_t nIn = 0, nOut = 0;
+	for (size_t l = 0; l < n; ++l)
+	{
+		const ARX& a = arx[m0 + l];
+		if (a.B.size())
+			nIn = std::max(nIn, a.k + a.B.size());
+		nOut = std::max(nOut, a.A.size());
+	}
+
+	/// Struktura tablic: współczynniki, nastawy i stan
+	AlignedVector<double> Bc(nIn * L, 0.0), Ac(nOut * L, 0.0);
+	AlignedVector<double> in(2 * nIn * L, 0.0), out(2 * nOut * L, 0.0);
+	alignas(CACHE_LINE) double P[L] = {}, I[L] = {}, D[L] = {}, sumerr[L] = {}, lasterr[L] = {}, arxout[L] = {}, ns[L] = {};
+	alignas(CACHE_LINE) double absErr[L] = {}, sqErr[L] = {};
+	alignas(CACHE_LINE) size_t stop[L] = {}; ///< Liczba chwil wliczanych do wskaźników pętli (len + 1 pętli albo traces->size())
+	size_t inPos = 0, outPos = 0;
+
+	for (size_t l = 0; l < n; ++l)
+	{
+		const ARX& a = arx[m0 + l];
+		for (size_t j = 0; j < a.B.size(); ++j)
+			Bc[(a.k + j) * L + l] = a.B[j];
+		for (size_t j = 0; j < a.A.size(); ++j)
+			Ac[j * L + l] = a.A[j];
+		ns[l] = a.ns_var;
+
+		/// Stan początkowy z obiektu ARX (historie od najnowszej próbki)
+		for (size_t j = 0; j < std::min(nIn, a.inBuf.size()); ++j)
+			in[j * L + l] = in[(j + nIn) * L + l] = a.inBuf[j];
+		for (size_t j = 0; j < std::min(nOut, a.outBuf.size()); ++j)
+			out[j * L + l] = out[(j + nOut) * L + l] = a.outBuf[j];
+
+		const PID& p = pid[m0 + l];
+		P[l] = p.P;
+		I[l] = p.I;
+		D[l] = p.D;
+		sumerr[l] = p.sumerr;
+		lasterr[l] = p.lasterr;
+	}
+
+	constexpr size_t TILE = Simulation::BLOCK;
+	const size_t steps = traces ? traces->size() : len + 1;
+	for (size_t l = 0; l < n; ++l)
+		stop[l] = traces ? steps : std::min(lens[m0 + l] + 1, steps); ///< wspólne przebiegi - jeden horyzont dla wszystkich pętli
+	std::vector<double> buf(TILE);
+	AlignedVector<double> sp(TILE * L, 0.0), dv(TILE * L, 0.0), nv(TILE * L, 0.0), ev(TILE * L, 0.0), yv(TILE * L, 0.0);
+	alignas(CACHE_LINE) double u[L], acc[L];
+
+	for (size_t b = 0; b < steps; b += TILE)
+	{
+		const size_t tn = std::min(TILE, steps - b);
+		std::span<double> sb(buf.data(), tn);
+
+		/// Generowanie kafla sygnałów każdej pętli i przepisanie do wierszy [chwila][pętla]
+		auto tile = [&](Generator& g, AlignedVector<double>& dst, size_t l)
+		{
+			if (g.empty())
+				return;
+			g.fill(b, sb);
+			for (size_t t = 0; t < tn; ++t)
+				dst[t * L + l] = sb[t];
+		};
+		/// Wspólny przebieg - ta sama próbka we wszystkich pętlach bloku
+		auto broadcast = [&](std::span<const double> src, AlignedVector<double>& dst)
+		{
+			if (!src.empty())
+				for (size_t t = 0; t < tn; ++t)
+					std::fill_n(dst.data() + t * L, L, src[b + t]);
+		};
+		if (traces)
+		{
+			broadcast(traces->setpoint(), sp);
+			broadcast(traces->disturbance(), dv);
+			broadcast(traces->measurement(), nv);
+			broadcast(traces->arxNoise(), ev);
+		}
+		else
+		{
+			for (size_t l = 0; l < n; ++l)
+			{
+				tile(gen[m0 + l], sp, l);
+				tile(dist[m0 + l], dv, l);
+				tile(noise[m0 + l], nv, l);
+				if (ns[l] != 0)
+					for (size_t t = 0; t < tn; ++t)
+						ev[t * L + l] = ARX::getNoise();
+			}
+		}
+
+		for (size_t t = 0; t < tn; ++t)
+		{
+			const double* r = sp.data() + t * L;
+			const double* d = dv.data() + t * L;
+			const double* v = nv.data() + t * L;
+			const double* e = ev.data() + t * L;
+			const size_t i = b + t;
+
+			/// Regulator PID (wskaźniki tylko do końca własnej symulacji pętli)
+			for (size_t l = 0; l < L; ++l)
+			{
+				const double err = r[l] - (arxout[l] + v[l]);
+				sumerr[l] += err;
+				const double diff = err - lasterr[l];
+				lasterr[l] = err;
+				u[l] = P[l] * err + I[l] * sumerr[l] + D[l] * diff + d[l];
+				const double live = i < stop[l] ? 1.0 : 0.0;
+				absErr[l] += live * std::abs(err);
+				sqErr[l] += live * err * err;
+			}
+
+			/// Model ARX
+			if (nIn)
+			{
+				inPos = (inPos ? inPos : nIn) - 1;
+				std::copy(u, u + L, in.data() + inPos * L);
+				std::copy(u, u + L, in.data() + (inPos + nIn) * L);
+			}
+			for (size_t l = 0; l < L; ++l)
+				acc[l] = ns[l] * e[l];
+			for (size_t j = 0; j < nIn; ++j)
+			{
+				const double* c = Bc.data() + j * L;
+				const double* h = in.data() + (inPos + j) * L;
+				for (size_t l = 0; l < L; ++l)
+					acc[l] += c[l] * h[l];
+			}
+			for (size_t j = 0; j < nOut; ++j)
+			{
+				const double* c = Ac.data() + j * L;
+				const double* h = out.data() + (outPos + j) * L;
+				for (size_t l = 0; l < L; ++l)
+					acc[l] -= c[l] * h[l];
+			}
+			if (nOut)
+			{
+				outPos = (outPos ? outPos : nOut) - 1;
+				std::copy(acc, acc + L, out.data() + outPos * L);
+				std::copy(acc, acc + L, out.data() + (outPos + nOut) * L);
+			}
+			std::copy(acc, acc + L, arxout);
+			std::copy(acc, acc + L, yv.data() + t * L);
+		}
+
+		if (!y.empty())
+			for (size_t l = 0; l < n; ++l)
+				for (size_t t = 0; t < tn; ++t)
+					y[(m0 + l) * steps + b + t] = yv[t * L + l];
+	}
+
+	for (size_t l = 0; l < n; ++l)
+	{
+		iae[m0 + l] = absErr[l];
+		ise[m0 + l] = sqErr[l];
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Simulation.h"
+#include "Aligned.h"
+
+#include <span>
+#include <string>
+#include <vector>
+
+class TraceCache;
+
+/// \file SimulationBank.h
+/// \brief Zawiera definicję klasy SimulationBank - jednoczesnej symulacji wielu pętli regulacji.
+
+/// \class SimulationBank
+/// \brief Bank N pętli regulacji (generator, PID, ARX) symulowanych jednocześnie.
+///
+/// Pętle są grupowane w bloki po LANES. Parametry i stan bloku są przechowywane jako struktura tablic:
+/// nastawy i stan PID (sumerr, lasterr) to tablice po LANES wartości, a współczynniki ARX i historie
+/// wejść/wyjść - wiersze po LANES wartości dla kolejnych opóźnień (krótsze modele są dopełniane zerami,
+/// opóźnienie k jest wliczone w indeks współczynnika licznika). Każda operacja kroku jest pętlą
+/// o stałej długości po pętlach regulacji, wektoryzowaną przez kompilator.
+///
+/// Każda pętla może mieć inny model, nastawy, sygnał zadany, kanały zakłóceń i długość; pętle wczytuje się
+/// z plików w formacie Simulation::save (save.json). Wszystkie pętle są symulowane przez len + 1 chwil,
+/// ale iae i ise pętli obejmują tylko chwile 0, ..., len tej pętli (jak w Simulation::run). Na wspólnych
+/// przebiegach (run(const TraceCache&, ...)) horyzont jest jeden - traces.size() chwil dla każdej pętli.
+class SimulationBank
+{
+public:
+	/// Liczba pętli w bloku.
+	static constexpr size_t LANES = 32;
+
+private:
+	std::vector<ARX> arx; ///< Modele pętli (współczynniki).
+	std::vector<PID> pid; ///< Regulatory pętli (nastawy i stan początkowy).
+	std::vector<Generator> gen; ///< Generatory wartości zadanej.
+	std::vector<Generator> dist; ///< Generatory zakłócenia wejściowego.
+	std::vector<Generator> noise; ///< Generatory szumu pomiarowego.
+	std::vector<size_t> lens; ///< Długości symulacji pętli (Simulation::len).
+
+	/// \brief Symuluje jeden blok pętli.
+	/// \param bi Indeks bloku.
+	/// \param y Bufor wyjść (pusty - bez zapisu).
+	/// \param traces Wspólne przebiegi sygnałów (nullptr - generatory i szum każdej pętli).
+	void runBlock(size_t bi, std::span<double> y, const TraceCache* traces);
+
+public:
+	size_t len = 0; ///< Długość symulacji (len + 1 iteracji, jak w Simulation::run). Domyślnie największa z dodanych pętli.
+	std::vector<double> iae; ///< Suma |e| dla każdej pętli w chwilach 0, ..., len tej pętli (wynik run(); na wspólnych przebiegach - wszystkie chwile).
+	std::vector<double> ise; ///< Suma e^2 dla każdej pętli w chwilach 0, ..., len tej pętli (wynik run(); na wspólnych przebiegach - wszystkie chwile).
+
+	/// \brief Dodaje pętlę (obiekty symulacji są przenoszone).
+	/// \param s Symulacja.
+	void add(Simulation&& s);
+
+	/// \brief Dodaje pętlę wczytaną z pliku JSON (format Simulation::save).
+	/// \param file Nazwa pliku.
+	void add(const std::string& file);
+
+	/// \brief Zwraca liczbę pętli.
+	size_t size() const { return arx.size(); }
+
+	/// \brief Zmienia nastawy regulatora pętli.
+	/// \param i Indeks pętli.
+	/// \param P Współczynnik proporcjonalny.
+	/// \param I Współczynnik całkujący.
+	/// \param D Współczynnik różniczkujący.
+	void setGains(size_t i, double P, double I, double D);
+
+	/// \brief Symuluje wszystkie pętle.
+	///
+	/// Pętle zaczynają od stanu obiektów w chwili dodania (jak Simulation::run). Szum modeli ARX jest
+	/// losowany przez ARX::getNoise() tylko dla pętli z ns_var != 0 - kolejno w blokach po 1024 chwile,
+	/// więc próbki szumu różnią się od osobnych wywołań Simulation::run (rozkład jest ten sam).
+	/// Bloki pętli są niezależne i mogą być liczone równolegle, o ile żadna pętla nie ma szumu ARX
+	/// (wspólny generator liczb losowych) - w przeciwnym razie symulacja jest jednowątkowa.
+	/// \param y Opcjonalny bufor wyjść obiektów: y[i * (len + 1) + t] (pusty - bez zapisu). Po końcu
+	/// krótszej pętli jej przebieg jest kontynuowany (te chwile nie wchodzą do iae i ise).
+	/// \param threads Liczba wątków. Domyślnie 1; 0 - liczba rdzeni.
+	/// \throws std::invalid_argument Gdy bufor y ma niewłaściwą długość.
+	void run(std::span<double> y = {}, unsigned threads = 1);
+
+	/// \brief Symuluje wszystkie pętle na wspólnych przebiegach sygnałów (wspólne liczby losowe).
+	///
+	/// Każda pętla dostaje te same przebiegi wartości zadanej, zakłócenia i szumu pomiarowego z traces
+	/// (zamiast własnych generatorów) oraz te same próbki szumu ARX, skalowane przez swoje ns_var.
+	/// Liczba chwil to traces.size() - także w iae i ise każdej pętli, niezależnie od jej len, więc wskaźniki
+	/// kandydatów przeglądu nastaw są porównywalne. Przebiegi są tylko
+	/// czytane, więc bloki pętli są liczone równolegle także przy szumie ARX.
+	/// \param traces Wspólne przebiegi sygnałów.
+	/// \param y Opcjonalny bufor wyjść obiektów: y[i * traces.size() + t] (pusty - bez zapisu).
+	/// \param threads Liczba wątków. Domyślnie 1; 0 - liczba rdzeni.
+	/// \throws std::invalid_argument Gdy bufor y ma niewłaściwą długość.
+	void run(const TraceCache& traces, std::span<double> y = {}, unsigned threads = 1);
+};
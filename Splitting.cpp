@@ -0,0 +1,117 @@
+/// \file Splitting.cpp
+/// \brief Zawiera implementację wielopoziomowego podziału dla prawdopodobieństwa przekroczenia ograniczenia wyjścia.
+
+#include "Splitting.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+/**
+ * @brief Estymuje prawdopodobieństwo przekroczenia ograniczenia wyjścia.
+ * @param s Symulacja.
+ * @param bound Ograniczenie.
+ * @param opt Parametry.
+ * @return Wynik estymacji.
+ */
+SplittingResult exceedanceProbability(Simulation& s, double bound, const SplittingOptions& opt)
+{
+	if (opt.particles < 2 || !(opt.proportion > 0 && opt.proportion < 1))
+		throw std::invalid_argument("Splitting needs at least 2 particles and a proportion in (0, 1)!");
+
+	const TraceCache tr(s, false);
+	const size_t T = tr.size(), N = opt.particles;
+	const size_t keep = std::max<size_t>(1, size_t(std::ceil(opt.proportion * double(N))));
+	std::mt19937_64 master(opt.seed);
+
+	std::vector<Simulation> cur;
+	cur.reserve(N);
+	for (size_t i = 0; i < N; ++i)
+	{
+		cur.push_back(s.fork());
+		cur.back().seedNoise(uint32_t(master()));
+	}
+
+	SplittingResult res;
+	double P = 1, relVar = 0, level = -std::numeric_limits<double>::infinity();
+	std::vector<double> score(N), sorted(N), start(N, -std::numeric_limits<double>::infinity()); ///< start - maksimum wyjścia do migawki
+	for (size_t stage = 0; stage < opt.maxStages; ++stage)
+	{
+		/// Przebiegi z migawek do końca horyzontu lub do przekroczenia ograniczenia (wynik - maksimum wyjścia całej trajektorii)
+		for (size_t i = 0; i < N; ++i)
+		{
+			Simulation x = cur[i].fork();
+			double m = start[i];
+			while (x.iter < T && m < bound)
+				m = std::max(m, x.step(tr));
+			score[i] = m;
+			res.steps += x.iter - cur[i].iter;
+		}
+
+		/// Kolejny poziom - kwantyl największych wyjść (co najmniej ponad poprzedni poziom)
+		sorted = score;
+		std::nth_element(sorted.begin(), sorted.begin() + (keep - 1), sorted.end(), std::greater<>());
+		double L = std::min(sorted[keep - 1], bound);
+		if (!(L > level))
+		{
+			L = std::numeric_limits<double>::infinity();
+			for (double v : score)
+				if (v > level)
+					L = std::min(L, v);
+			if (std::isinf(L))
+			{
+				P = 0;
+				break;
+			}
+		}
+
+		const size_t hits = size_t(std::count_if(score.begin(), score.end(), [L](double v) { return v >= L; }));
+		const double p = double(hits) / double(N);
+		P *= p;
+		relVar += (1 - p) / (p * double(N));
+		res.levels.push_back(L);
+		res.fractions.push_back(p);
+		if (L >= bound)
+		{
+			res.reached = true;
+			break;
+		}
+
+		/// Odtworzenie trajektorii do pierwszego przekroczenia poziomu (migawka z przeskokiem ponad poziom jest już stanem wejścia)
+		std::vector<std::pair<Simulation, double>> entry; ///< Stan wejścia i maksimum wyjścia trajektorii do niego
+		for (size_t i = 0; i < N; ++i)
+			if (score[i] >= L)
+			{
+				Simulation x = cur[i].fork();
+				if (start[i] < L)
+					while (x.step(tr) < L)
+						;
+				res.steps += x.iter - cur[i].iter;
+				const double m = std::max(start[i], x.out);
+				entry.emplace_back(std::move(x), m);
+			}
+		std::shuffle(entry.begin(), entry.end(), master);
+
+		/// Klonowanie stanów wejścia z nowymi ziarnami szumu
+		std::vector<Simulation> next;
+		next.reserve(N);
+		for (size_t i = 0; i < N; ++i)
+		{
+			const auto& [x, m] = entry[i % entry.size()];
+			next.push_back(x.fork());
+			next.back().seedNoise(uint32_t(master()));
+			start[i] = m;
+		}
+		cur = std::move(next);
+		level = L;
+	}
+
+	res.probability = P;
+	res.relError = std::sqrt(relVar);
+	res.plainSteps = P > 0 && res.relError > 0 ? (1 - P) / (P * res.relError * res.relError) * double(T) : std::numeric_limits<double>::infinity();
+	return res;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Simulation.h"
+#include "TraceCache.h"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/// \file Splitting.h
+/// \brief Zawiera estymację prawdopodobieństwa rzadkiego przekroczenia ograniczenia wyjścia metodą wielopoziomowego podziału.
+
+/// \struct SplittingOptions
+/// \brief Parametry wielopoziomowego podziału.
+struct SplittingOptions
+{
+	size_t particles = 1000; ///< Liczba trajektorii na każdym poziomie.
+	double proportion = 0.1; ///< Docelowy udział trajektorii przechodzących na kolejny poziom.
+	size_t maxStages = 60; ///< Największa liczba poziomów.
+	uint64_t seed = 1; ///< Ziarno generatora ziaren szumu trajektorii (Simulation::seedNoise()).
+};
+
+/// \struct SplittingResult
+/// \brief Wynik estymacji prawdopodobieństwa przekroczenia.
+struct SplittingResult
+{
+	double probability = 0; ///< Estymata P(max_t y(t) >= bound).
+	double relError = 0; ///< Przybliżony względny błąd standardowy: sqrt(sum (1 - p_j) / (p_j N)) (pomija korelację potomków wspólnych przodków, więc zwykle zaniża błąd).
+	std::vector<double> levels; ///< Kolejne poziomy pośrednie (ostatni - ograniczenie).
+	std::vector<double> fractions; ///< Udziały p_j trajektorii, które osiągnęły kolejne poziomy.
+	size_t steps = 0; ///< Łączna liczba zasymulowanych kroków (z odtwarzaniem trajektorii).
+	double plainSteps = 0; ///< Liczba kroków zwykłego Monte Carlo dającego ten sam błąd względny.
+	bool reached = false; ///< Czy poziomy osiągnęły bound (w przeciwnym razie probability dotyczy ostatniego poziomu).
+
+	/// \brief Wypisuje raport.
+	friend std::ostream& operator<<(std::ostream& os, const SplittingResult& r)
+	{
+		return os << "P = " << r.probability << " (blad wzgledny " << r.relError << "), " << r.levels.size() << " poziomow, "
+			<< r.steps << " krokow (Monte Carlo: " << r.plainSteps << ")";
+	}
+};
+
+/// \brief Estymuje prawdopodobieństwo, że wyjście obiektu przekroczy ograniczenie w chwilach 0, ..., s.len.
+///
+/// Adaptacyjny wielopoziomowy podział o stałym udziale: na każdym poziomie particles trajektorii
+/// (klonów Simulation::fork() z własnymi ziarnami szumu ARX) jest symulowanych krokami
+/// Simulation::step(const TraceCache&) do końca horyzontu; sygnały deterministyczne wszystkie klony
+/// czytają ze wspólnego TraceCache. Kolejny poziom to kwantyl rzędu 1 - proportion największych
+/// osiągniętych wyjść (lub bound). Trajektorie, które go osiągnęły, są odtwarzane z migawki
+/// początkowej (klon z generatorem szumu daje ten sam przebieg) do chwili pierwszego przekroczenia
+/// poziomu, a ich stany w tej chwili są klonowane - z nowymi ziarnami szumu (seedNoise()) - do
+/// kolejnych particles trajektorii. Wynikiem trajektorii jest maksimum wyjścia na całej ścieżce
+/// (razem z częścią przed migawką). Estymata to iloczyn udziałów p_j.
+/// Podział jest skuteczny, gdy wyjście zmienia się gładko (wolny obiekt); gdy przekroczenie jest
+/// wywoływane pojedynczą dużą próbką szumu, poziomy pośrednie niewiele pomagają, a wariancja rośnie.
+/// \param s Symulacja (stan krokowy iter, out, arx i pid jest stanem początkowym; sygnały i horyzont len; s nie jest zmieniana).
+/// \param bound Ograniczenie wyjścia.
+/// \param opt Parametry.
+/// \return Wynik estymacji (probability = 0, gdy żadna trajektoria nie przekroczyła poziomu).
+/// \throws std::invalid_argument Gdy parametry są niepoprawne.
+SplittingResult exceedanceProbability(Simulation& s, double bound, const SplittingOptions& opt = {});
@@ -0,0 +1,360 @@
+/// \file StepMetrics.cpp
+/// \brief Zawiera implementację analitycznego wyznaczania wskaźników odpowiedzi skokowej pętli PID + ARX.
+
+#include "StepMetrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace
+{
+	using Poly = ClosedLoop::Poly;
+	using Cplx = std::complex<double>;
+
+	constexpr double INF = std::numeric_limits<double>::infinity();
+
+	/// Wartość ustalona, poniżej której wskaźniki względne odnoszą się do wartości zadanej.
+	constexpr double TINY = 1e-12;
+
+	/// \brief Iloczyn wielomianów.
+	Poly mul(const Poly& a, const Poly& b)
+	{
+		if (a.empty() || b.empty())
+			return {};
+		Poly c(a.size() + b.size() - 1);
+		for (size_t i = 0; i < a.size(); ++i)
+			for (size_t j = 0; j < b.size(); ++j)
+				c[i + j] += a[i] * b[j];
+		return c;
+	}
+
+	/// \brief Suma wielomianów.
+	Poly add(Poly a, const Poly& b)
+	{
+		if (b.size() > a.size())
+			a.resize(b.size());
+		for (size_t i = 0; i < b.size(); ++i)
+			a[i] += b[i];
+		return a;
+	}
+
+	/// \brief Wartość z^n p(1/z) = sum p_i z^(n - i) (schemat Hornera).
+	Cplx reversed(const Poly& p, size_t n, Cplx z)
+	{
+		Cplx v = 0;
+		for (size_t i = 0; i <= n; ++i)
+			v = v * z + (i < p.size() ? p[i] : 0.0);
+		return v;
+	}
+
+	/// \brief Pochodna z^n p(1/z) względem z.
+	Cplx reversedDeriv(const Poly& p, size_t n, Cplx z)
+	{
+		Cplx v = 0;
+		for (size_t i = 0; i < n; ++i)
+			v = v * z + double(n - i) * (i < p.size() ? p[i] : 0.0);
+		return v;
+	}
+
+	/// \brief Pierwiastki wielomianu unormowanego z^n den(1/z) metodą Durand-Kernera.
+	///
+	/// Przybliżenia początkowe leżą na okręgu o promieniu z oszacowania Cauchy'ego.
+	/// \return true, jeśli iteracja jest zbieżna.
+	bool durandKerner(const Poly& den, std::vector<Cplx>& z)
+	{
+		constexpr size_t MAX_ITER = 500;
+		constexpr double TOL = 1e-14;
+
+		const size_t n = den.size() - 1;
+		double R = 0;
+		for (size_t i = 1; i <= n; ++i)
+			R = std::max(R, std::abs(den[i]));
+		R += 1;
+
+		z.resize(n);
+		for (size_t i = 0; i < n; ++i)
+			z[i] = std::polar(R, 2 * std::numbers::pi * double(i) / double(n) + 0.4);
+
+		for (size_t iter = 0; iter < MAX_ITER; ++iter)
+		{
+			double delta = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				Cplx q = 1;
+				for (size_t j = 0; j < n; ++j)
+					if (j != i)
+						q *= z[i] - z[j];
+				if (q == Cplx(0))
+					q = TOL;
+				const Cplx dz = reversed(den, n, z[i]) / q;
+				z[i] -= dz;
+				delta = std::max(delta, std::abs(dz) / std::max(1.0, std::abs(z[i])));
+			}
+			if (!std::isfinite(delta))
+				return false;
+			if (delta <= TOL)
+				return true;
+		}
+		return false;
+	}
+}
+
+/**
+ * @brief Wyznacza wskaźniki z próbek odpowiedzi skokowej.
+ * @param y Próbki odpowiedzi.
+ * @param yss Wartość ustalona.
+ * @param band Względna szerokość pasma ustalania.
+ * @return Wskaźniki.
+ */
+StepMetrics responseMetrics(std::span<const double> y, double yss, double band)
+{
+	StepMetrics m;
+	m.horizon = y.size();
+	m.steadyStateError = 1 - yss;
+	if (y.empty())
+	{
+		m.overshoot = m.riseTime = m.settlingTime = INF;
+		return m;
+	}
+
+	const bool relative = std::abs(yss) > TINY;
+	const double scale = relative ? std::abs(yss) : 1;
+	const double sgn = yss < 0 ? -1 : 1;
+
+	for (size_t t = 1; t < y.size(); ++t)
+		if (sgn * y[t] > sgn * y[m.peakTime])
+			m.peakTime = t;
+	m.peak = y[m.peakTime];
+	m.overshoot = relative ? std::max(0.0, sgn * (m.peak - yss) / scale) : 0;
+
+	/// Pierwsza chwila osiągnięcia poziomu level y_ss (z interpolacją liniową)
+	auto crossing = [&](double level)
+	{
+		const double v = level * scale;
+		for (size_t t = 0; t < y.size(); ++t)
+			if (sgn * y[t] >= v)
+				return t ? double(t - 1) + (v - sgn * y[t - 1]) / (sgn * (y[t] - y[t - 1])) : 0.0;
+		return INF;
+	};
+	m.riseTime = relative ? crossing(0.9) - crossing(0.1) : INF;
+	if (std::isnan(m.riseTime))
+		m.riseTime = INF;
+
+	size_t last = y.size();
+	for (size_t t = y.size(); t-- > 0;)
+		if (!(std::abs(y[t] - yss) <= band * scale))
+		{
+			last = t;
+			break;
+		}
+	m.settlingTime = last == y.size() ? 0 : last + 1 == y.size() ? INF : double(last + 1);
+	return m;
+}
+
+/**
+ * @brief Konstruktor klasy ClosedLoop.
+ * @param arx Model obiektu.
+ * @param pid Regulator.
+ */
+ClosedLoop::ClosedLoop(const ARX& arx, const PID& pid)
+{
+	/// Wielomiany obiektu: A(q) = 1 + sum A_j q^(j+1), q^k B(q)
+	Poly A(arx.A.size() + 1);
+	A[0] = 1;
+	for (size_t j = 0; j < arx.A.size(); ++j)
+		A[j + 1] = arx.A[j];
+	Poly qkB(arx.k + arx.B.size());
+	for (size_t j = 0; j < arx.B.size(); ++j)
+		qkB[arx.k + j] = arx.B[j];
+
+	/// Regulator C = Nc / Dc; bez członu całkującego wspólny czynnik (1 - q) jest skracany
+	Poly Nc, Dc;
+	if (pid.I != 0)
+	{
+		Nc = { pid.P + pid.I + pid.D, -(pid.P + 2 * pid.D), pid.D };
+		Dc = { 1, -1 };
+	}
+	else
+	{
+		Nc = { pid.P + pid.D, -pid.D };
+		Dc = { 1 };
+	}
+
+	num = mul(qkB, Nc);
+	Poly fb(num.size() + 1);
+	std::copy(num.begin(), num.end(), fb.begin() + 1);
+	den = add(mul(Dc, A), fb);
+	if (num.empty())
+		num = { 0 };
+	while (num.size() > 1 && num.back() == 0)
+		num.pop_back();
+	while (den.size() > 1 && den.back() == 0)
+		den.pop_back();
+
+	double num1 = 0, den1 = 0;
+	for (double v : num)
+		num1 += v;
+	for (double v : den)
+		den1 += v;
+	gain = den1 != 0 ? num1 / den1 : std::numeric_limits<double>::quiet_NaN();
+
+	const size_t n = den.size() - 1;
+	if (num.size() > n + 1 || !std::isfinite(gain))
+	{
+		ambiguous = true;
+		return;
+	}
+	if (!n)
+		return;
+
+	ambiguous = !durandKerner(den, poles);
+
+	/// Residua c_i = N(p_i) / (D'(p_i) (p_i - 1))
+	residues.resize(n);
+	for (size_t i = 0; i < n; ++i)
+		residues[i] = reversed(num, n, poles[i]) / (reversedDeriv(den, n, poles[i]) * (poles[i] - 1.0));
+
+	/// Bieguny (prawie) wielokrotne dają źle uwarunkowane residua
+	constexpr double SEPARATION = 1e-6;
+	for (size_t i = 0; i < n && !ambiguous; ++i)
+	{
+		ambiguous = !std::isfinite(std::abs(residues[i]));
+		for (size_t j = i + 1; j < n && !ambiguous; ++j)
+			ambiguous = std::abs(poles[i] - poles[j]) <= SEPARATION * std::max(1.0, std::abs(poles[i]));
+	}
+
+	/// Zgodność pierwszych n + 1 próbek z równaniem różnicowym (wykrywa utratę dokładności przez skracanie się residuów)
+	if (!ambiguous)
+	{
+		const std::vector<double> y = simulate(n + 1);
+		double ymax = 1, err = 0;
+		for (size_t t = 0; t <= n; ++t)
+		{
+			ymax = std::max(ymax, std::abs(y[t]));
+			err = std::max(err, std::abs(step(t) - y[t]));
+		}
+		ambiguous = !(err <= 1e-8 * ymax);
+	}
+}
+
+/**
+ * @brief Wartość odpowiedzi skokowej z rozkładu modalnego.
+ * @param t Chwila.
+ * @return y(t).
+ */
+double ClosedLoop::step(size_t t) const
+{
+	Cplx y = gain;
+	for (size_t i = 0; i < poles.size(); ++i)
+		y += residues[i] * std::pow(poles[i], double(t));
+	return y.real();
+}
+
+/**
+ * @brief Odpowiedź skokowa z równania różnicowego.
+ * @param len Liczba próbek.
+ * @return Próbki odpowiedzi.
+ */
+std::vector<double> ClosedLoop::simulate(size_t len) const
+{
+	std::vector<double> y(len);
+	double r = 0; ///< num(q) zastosowany do skoku - suma początkowych współczynników licznika
+	for (size_t t = 0; t < len; ++t)
+	{
+		if (t < num.size())
+			r += num[t];
+		double v = r;
+		for (size_t i = 1; i < den.size() && i <= t; ++i)
+			v -= den[i] * y[t - i];
+		y[t] = v;
+	}
+	return y;
+}
+
+/**
+ * @brief Wyznacza wskaźniki odpowiedzi skokowej.
+ * @param band Względna szerokość pasma ustalania.
+ * @param fallback Liczba próbek symulacji zastępczej.
+ * @return Wskaźniki.
+ */
+StepMetrics ClosedLoop::metrics(double band, size_t fallback) const
+{
+	/// Tolerancja rozstrzygania stabilności z modułu biegunów
+	constexpr double UNIT = 1e-7;
+
+	double rmax = 0, csum = 0;
+	for (size_t i = 0; i < poles.size(); ++i)
+	{
+		rmax = std::max(rmax, std::abs(poles[i]));
+		csum += std::abs(residues[i]);
+	}
+
+	if (!ambiguous && rmax > 1 + UNIT)
+	{
+		StepMetrics m;
+		m.modal = true;
+		m.overshoot = m.riseTime = m.settlingTime = m.peak = INF;
+		m.steadyStateError = INF;
+		return m;
+	}
+
+	if (ambiguous || rmax >= 1 - UNIT)
+	{
+		/// Horyzont jest podwajany, dopóki wyjście nie pozostaje w pasmie ustalania przez co najmniej połowę próbek
+		const size_t maxLen = std::min(fallback, MAX_HORIZON);
+		StepMetrics m;
+		bool finite = true;
+		for (size_t len = std::min<size_t>(256, maxLen);; len = std::min(2 * len, maxLen))
+		{
+			std::vector<double> y = simulate(len);
+			const auto bad = std::find_if(y.begin(), y.end(), [](double v) { return !std::isfinite(v); });
+			finite = bad == y.end();
+			y.erase(bad, y.end());
+			const double yss = std::isfinite(gain) ? gain : y.empty() ? 0 : y.back();
+			m = responseMetrics(y, yss, band);
+			if (len == maxLen || !finite || m.settlingTime <= double(len / 2))
+				break;
+		}
+		m.stable = finite && std::isfinite(m.settlingTime);
+		return m;
+	}
+
+	/// Horyzont, od którego obwiednia sum |c_i| rmax^t mieści się w pasmie ustalania
+	const double scale = std::abs(gain) > TINY ? std::abs(gain) : 1;
+	size_t T = 0;
+	if (csum > band * scale && rmax > 0)
+		T = size_t(std::min(std::ceil(std::log(band * scale / csum) / std::log(rmax)), double(MAX_HORIZON - 1)));
+
+	/// Próbki z modów: potęgi biegunów są aktualizowane mnożeniem
+	std::vector<double> y(T + 1);
+	std::vector<Cplx> pw(poles.size(), 1.0);
+	for (size_t t = 0; t <= T; ++t)
+	{
+		Cplx v = gain;
+		for (size_t i = 0; i < poles.size(); ++i)
+		{
+			v += residues[i] * pw[i];
+			pw[i] *= poles[i];
+		}
+		y[t] = v.real();
+	}
+
+	StepMetrics m = responseMetrics(y, gain, band);
+	m.stable = true;
+	m.modal = true;
+	return m;
+}
+
+/**
+ * @brief Wyznacza wskaźniki odpowiedzi skokowej pętli PID + ARX.
+ * @param arx Model obiektu.
+ * @param pid Regulator.
+ * @param band Względna szerokość pasma ustalania.
+ * @return Wskaźniki.
+ */
+StepMetrics stepMetrics(const ARX& arx, const PID& pid, double band)
+{
+	return ClosedLoop(arx, pid).metrics(band);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ARX.h"
+#include "PID.h"
+
+#include <complex>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+/// \file StepMetrics.h
+/// \brief Zawiera analityczne wyznaczanie wskaźników odpowiedzi skokowej pętli PID + ARX z biegunów i residuów.
+
+/// \struct StepMetrics
+/// \brief Wskaźniki odpowiedzi pętli na skok jednostkowy wartości zadanej (od zerowego stanu, bez szumu).
+///
+/// Wskaźniki względne odnoszą się do wartości ustalonej y_ss (gdy |y_ss| jest pomijalnie mały - do
+/// wartości zadanej). Czasy są podawane w próbkach; wskaźnik, który nie został osiągnięty w horyzoncie,
+/// ma wartość +inf.
+struct StepMetrics
+{
+	bool stable = false; ///< Czy pętla jest stabilna (wyjście ustala się w horyzoncie).
+	bool modal = false; ///< Czy wskaźniki wyznaczono z rozkładu modalnego (false - krótka symulacja).
+	double overshoot = 0; ///< Przeregulowanie (y_max - y_ss) / |y_ss| (0, gdy brak).
+	double riseTime = 0; ///< Czas narastania od 10% do 90% y_ss (z interpolacją liniową).
+	double settlingTime = 0; ///< Czas ustalania - pierwsza chwila, od której |y - y_ss| <= band |y_ss|.
+	double steadyStateError = 0; ///< Uchyb ustalony 1 - y_ss.
+	double peak = 0; ///< Wartość szczytowa wyjścia.
+	size_t peakTime = 0; ///< Chwila wartości szczytowej.
+	size_t horizon = 0; ///< Liczba wyznaczonych próbek odpowiedzi.
+};
+
+/// \brief Wyznacza wskaźniki z próbek odpowiedzi skokowej.
+/// \param y Próbki y(0), y(1), ... odpowiedzi.
+/// \param yss Wartość ustalona.
+/// \param band Względna szerokość pasma ustalania.
+/// \return Wskaźniki (pola stable i modal nie są ustawiane).
+StepMetrics responseMetrics(std::span<const double> y, double yss, double band = 0.02);
+
+/// \class ClosedLoop
+/// \brief Transmitancja pętli PID + ARX od wartości zadanej do wyjścia, jej bieguny i residua odpowiedzi skokowej.
+///
+/// Pętla odpowiada krokowi Simulation::run: e(t) = r(t) - y(t - 1), u = C e, y = G u, gdzie
+/// G(q) = q^k B(q) / A(q) (q - opóźnienie o jedną próbkę), a C(q) = P + I / (1 - q) + D (1 - q).
+/// Dla C = Nc / Dc transmitancja zamkniętej pętli ma postać T = num / den, gdzie
+/// num = q^k B Nc, den = Dc A + q^(k+1) B Nc. Bieguny (pierwiastki z^n den(1/z)) są wyznaczane metodą
+/// Durand-Kernera, a odpowiedź skokowa ma postać y(t) = T(1) + Re sum c_i p_i^t z residuami
+/// c_i = N(p_i) / (D'(p_i) (p_i - 1)).
+class ClosedLoop
+{
+public:
+	using Poly = std::vector<double>; ///< Współczynniki wielomianu przy q^0, q^1, ...
+
+	/// Najdłuższy horyzont odpowiedzi wyznaczanej modalnie lub symulacją.
+	static constexpr size_t MAX_HORIZON = 100000;
+
+	Poly num; ///< Licznik transmitancji zamkniętej pętli.
+	Poly den; ///< Mianownik transmitancji zamkniętej pętli (den[0] = 1).
+	std::vector<std::complex<double>> poles; ///< Bieguny zamkniętej pętli.
+	std::vector<std::complex<double>> residues; ///< Współczynniki c_i modów odpowiedzi skokowej.
+	double gain = 0; ///< Wzmocnienie statyczne T(1) = num(1) / den(1) (NaN, gdy den(1) = 0).
+	bool ambiguous = false; ///< Czy rozkład modalny jest niewiarygodny (bieguny wielokrotne, brak zbieżności, duże residua).
+
+	/// \brief Konstruktor - wyznacza transmitancję, bieguny i residua.
+	/// \param arx Model obiektu (współczynniki A, B, k; stan i szum są pomijane).
+	/// \param pid Regulator (nastawy P, I, D; stan jest pomijany).
+	ClosedLoop(const ARX& arx, const PID& pid);
+
+	/// \brief Wartość odpowiedzi skokowej w chwili t z rozkładu modalnego.
+	/// \param t Chwila.
+	/// \return y(t).
+	double step(size_t t) const;
+
+	/// \brief Odpowiedź skokowa z równania różnicowego den y = num r (krótka symulacja pętli).
+	/// \param len Liczba próbek.
+	/// \return Próbki y(0), ..., y(len - 1).
+	std::vector<double> simulate(size_t len) const;
+
+	/// \brief Wyznacza wskaźniki odpowiedzi skokowej.
+	///
+	/// Gdy rozkład modalny jest jednoznaczny, próbki odpowiedzi są liczone z modów do chwili, od której
+	/// obwiednia sum |c_i| |p_i|^t mieści się w pasmie ustalania (koszt O(n) na próbkę, bez symulacji
+	/// obiektu). Pętla z biegunem |p| >= 1 jest niestabilna. Gdy rozkład jest niejednoznaczny (lub największy
+	/// moduł bieguna jest nierozstrzygalnie bliski 1) wykonywana jest krótka symulacja (simulate),
+	/// której horyzont (od 256 próbek) jest podwajany, dopóki wyjście nie ustala się w pierwszej połowie.
+	/// \param band Względna szerokość pasma ustalania.
+	/// \param fallback Największa liczba próbek symulacji zastępczej.
+	/// \return Wskaźniki.
+	StepMetrics metrics(double band = 0.02, size_t fallback = 10000) const;
+};
+
+/// \brief Wyznacza wskaźniki odpowiedzi skokowej pętli PID + ARX (ClosedLoop(arx, pid).metrics(band)).
+/// \param arx Model obiektu.
+/// \param pid Regulator.
+/// \param band Względna szerokość pasma ustalania.
+/// \return Wskaźniki.
+StepMetrics stepMetrics(const ARX& arx, const PID& pid, double band = 0.02);
@@ -0,0 +1,151 @@
+/// \file TileScheduler.cpp
+/// \brief Zawiera implementację symulacji wielu pętli regulacji kaflami czasowymi.
+
+#include "TileScheduler.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <span>
+
+/**
+ * \brief Dodaje pętlę do harmonogramu.
+ * \param sim Pętla.
+ * \param log Strumień dziennika CSV lub nullptr.
+ */
+void TileScheduler::add(Simulation& sim, std::ostream* log)
+{
+	Entry& e = entries.emplace_back();
+	e.sim = &sim;
+	e.log = log;
+	if (log)
+	{
+		*log << "Iteracja,Zadana,Blad,Sterowanie,Wyjscie";
+		if (!sim.dist.empty() || !sim.noise.empty())
+			*log << ",Zaklocenie,Szum";
+		*log << std::endl;
+	}
+}
+
+/**
+ * \brief Przesuwa pętlę o co najwyżej n kroków.
+ *
+ * Sygnały kafla są generowane jednym wywołaniem fill() od bieżącej chwili pętli; bufory są lokalne
+ * dla wątku i alokowane tylko przy wzroście kafla.
+ * \param e Pętla.
+ * \param n Liczba kroków.
+ */
+void TileScheduler::advance(Entry& e, size_t n)
+{
+	Simulation& s = *e.sim;
+	if (e.t > s.len)
+		return;
+	n = std::min(n, s.len + 1 - e.t);
+
+	thread_local std::vector<double> setpBlk, distBlk, noiseBlk;
+	if (setpBlk.size() < n)
+	{
+		setpBlk.resize(n);
+		distBlk.resize(n);
+		noiseBlk.resize(n);
+	}
+	std::span<double> sb(setpBlk.data(), n), db(distBlk.data(), n), nb(noiseBlk.data(), n);
+	s.gen.fill(e.t, sb);
+	if (s.dist.empty())
+		std::fill(db.begin(), db.end(), 0.0);
+	else
+		s.dist.fill(e.t, db);
+	if (s.noise.empty())
+		std::fill(nb.begin(), nb.end(), 0.0);
+	else
+		s.noise.fill(e.t, nb);
+
+	const bool channels = !s.dist.empty() || !s.noise.empty();
+	LoopSample<double> x;
+	x.y = e.arxout;
+	for (size_t i = 0; i < n; ++i)
+	{
+		x.i = e.t + i;
+		x.r = sb[i];
+		x.d = db[i];
+		x.v = nb[i];
+		loopStep(x, s.pid, [&s](double in, size_t) { return s.arx.sim(in); });
+
+		if (e.log)
+		{
+			e.buf << x.i << "," << x.r << "," << x.err << "," << x.u << "," << x.y;
+			if (channels)
+				e.buf << "," << x.d << "," << x.v;
+			e.buf << "\n";
+		}
+	}
+	e.arxout = x.y;
+	e.t += n;
+}
+
+/**
+ * \brief Symuluje wszystkie pętle do końca ich horyzontów.
+ * \return Statystyki wykonania.
+ */
+TileScheduler::Stats TileScheduler::run()
+{
+	using clock = std::chrono::steady_clock;
+
+	Stats st;
+	const bool noisy = std::any_of(entries.begin(), entries.end(), [](const Entry& e) { return e.sim->arx.ns_var != 0; });
+	const unsigned T = noisy ? 1 : threads;
+
+	size_t cand = 0; ///< Indeks sprawdzanego kandydata (przy doborze automatycznym)
+	double best = 0;
+	double time = 0;
+	size_t steps = 0;
+
+	for (;;)
+	{
+		const bool tuning = !tile;
+		const size_t L = tuning ? TILES[cand] : tile;
+
+		size_t work = 0;
+		for (const Entry& e : entries)
+			if (e.t <= e.sim->len)
+				work += std::min(L, e.sim->len + 1 - e.t);
+		if (!work)
+			break;
+
+		const auto t0 = clock::now();
+		parallelFor(entries.size(), T, [&](size_t i) { advance(entries[i], L); });
+		const double dt = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+		st.rounds++;
+
+		/// Zapis dzienników kafla w kolejności pętli
+		for (Entry& e : entries)
+			if (e.log)
+			{
+				*e.log << e.buf.str();
+				e.log->flush();
+				e.buf.str("");
+			}
+
+		if (tuning)
+		{
+			const double perStep = dt / work;
+			if (!cand || perStep < best)
+			{
+				best = perStep;
+				st.tile = L;
+			}
+			if (++cand == std::size(TILES) || work < entries.size() * L)
+				tile = st.tile; ///< koniec kandydatów lub horyzontu - pomiar krótszego kafla byłby niemiarodajny
+		}
+		else
+		{
+			time += dt;
+			steps += work;
+		}
+	}
+
+	if (!st.tile)
+		st.tile = tile;
+	st.nsPerStep = steps ? time / steps : best;
+	return st;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Simulation.h"
+
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+/// \file TileScheduler.h
+/// \brief Zawiera definicję klasy TileScheduler - symulacji wielu pętli regulacji kaflami czasowymi.
+
+/// \class TileScheduler
+/// \brief Harmonogram symulacji wielu niezależnych pętli regulacji (obiektów Simulation) kaflami czasowymi.
+///
+/// Zamiast wykonywać jeden krok każdej pętli w każdej chwili (stan wszystkich pętli przechodzi wtedy
+/// przez pamięć podręczną w każdym kroku), harmonogram przesuwa każdą pętlę o cały kafel tile kroków,
+/// zanim przejdzie do następnej - stan pętli (linie opóźniające ARX, PID, bufory sygnałów) pozostaje
+/// w tym czasie w pamięci L1/L2. Po każdej rundzie (wszystkie pętle przesunięte o kafel) wiersze
+/// dziennika zebrane w buforach pętli są zapisywane do ich strumieni, w kolejności dodania pętli.
+///
+/// Krok pętli jest taki sam jak w Simulation::run, a sygnały są generowane od chwili bieżącej, więc
+/// przebieg nie zależy od długości kafla (poza kolejnością losowania szumu ARX, wspólnego dla modeli).
+class TileScheduler
+{
+	/// \struct Entry
+	/// \brief Pętla regulacji wraz z jej stanem w harmonogramie.
+	struct Entry
+	{
+		Simulation* sim = nullptr; ///< Symulowana pętla (obiekt nie jest własnością harmonogramu).
+		std::ostream* log = nullptr; ///< Strumień dziennika CSV lub nullptr.
+		std::ostringstream buf; ///< Wiersze dziennika bieżącego kafla.
+		double arxout = 0; ///< Ostatnie wyjście obiektu.
+		size_t t = 0; ///< Następna chwila symulacji.
+	};
+
+	std::vector<Entry> entries; ///< Pętle harmonogramu.
+
+	/// \brief Przesuwa pętlę o co najwyżej n kroków.
+	/// \param e Pętla.
+	/// \param n Liczba kroków.
+	static void advance(Entry& e, size_t n);
+
+public:
+	/// Kandydaci długości kafla sprawdzani przy automatycznym doborze.
+	static constexpr size_t TILES[] = { 64, 256, 1024, 4096, 16384 };
+
+	size_t tile = 0; ///< Długość kafla (liczba kroków). 0 - dobór automatyczny w pierwszych rundach.
+	unsigned threads = 1; ///< Liczba wątków (pętle w rundzie są niezależne). 0 - liczba rdzeni.
+
+	/// \struct Stats
+	/// \brief Statystyki wykonania.
+	struct Stats
+	{
+		size_t tile = 0; ///< Użyta (dobrana) długość kafla.
+		size_t rounds = 0; ///< Liczba rund.
+		double nsPerStep = 0; ///< Średni czas kroku jednej pętli w rundach z wybranym kaflem [ns].
+	};
+
+	/// \brief Dodaje pętlę do harmonogramu.
+	///
+	/// Pętla jest symulowana od zerowego wyjścia obiektu (jak Simulation::run) przez sim.len + 1 kroków.
+	/// Jeśli podano strumień, zapisywany jest do niego nagłówek i wiersze w formacie pliku Simulation::run.
+	/// \param sim Pętla (musi istnieć do końca symulacji).
+	/// \param log Strumień dziennika CSV lub nullptr.
+	void add(Simulation& sim, std::ostream* log = nullptr);
+
+	/// \brief Zwraca liczbę pętli.
+	size_t size() const { return entries.size(); }
+
+	/// \brief Zwraca ostatnie wyjście obiektu pętli.
+	/// \param i Indeks pętli.
+	double output(size_t i) const { return entries.at(i).arxout; }
+
+	/// \brief Symuluje wszystkie pętle do końca ich horyzontów.
+	///
+	/// Przy tile = 0 kolejne rundy używają kolejnych długości z TILES, mierząc czas kroku pętli,
+	/// a pozostałe rundy - najszybszej z nich (wynik zostaje w polu tile). Wątki są używane tylko wtedy,
+	/// gdy żaden model nie ma szumu (ARX::getNoise() korzysta ze wspólnego generatora).
+	/// \return Statystyki wykonania.
+	Stats run();
+};
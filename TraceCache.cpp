@@ -0,0 +1,34 @@
+/// \file TraceCache.cpp
+/// \brief Zawiera implementację wspólnych przebiegów sygnałów pętli.
+
+#include "TraceCache.h"
+
+#include <algorithm>
+
+/**
+ * \brief Konstruktor klasy TraceCache.
+ * \param s Symulacja.
+ * \param arxNoise Czy wygenerować próbki szumu ARX.
+ */
+TraceCache::TraceCache(Simulation& s, bool arxNoise) : n(s.len + 1), setp(n)
+{
+	if (!s.dist.empty())
+		dist.resize(n);
+	if (!s.noise.empty())
+		noise.resize(n);
+	if (arxNoise)
+		e.resize(n);
+
+	constexpr size_t BLOCK = Simulation::BLOCK;
+	for (size_t b = 0; b < n; b += BLOCK)
+	{
+		const size_t bn = std::min(BLOCK, n - b);
+		s.gen.fill(b, std::span(setp).subspan(b, bn));
+		if (!dist.empty())
+			s.dist.fill(b, std::span(dist).subspan(b, bn));
+		if (!noise.empty())
+			s.noise.fill(b, std::span(noise).subspan(b, bn));
+	}
+	for (double& v : e)
+		v = ARX::getNoise();
+}
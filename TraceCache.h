@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Simulation.h"
+#include "Aligned.h"
+
+#include <span>
+
+/// \file TraceCache.h
+/// \brief Zawiera definicję klasy TraceCache - wspólnych, wygenerowanych z góry przebiegów sygnałów pętli.
+
+/// \class TraceCache
+/// \brief Przebiegi wartości zadanej, zakłócenia, szumu pomiarowego i szumu ARX wygenerowane raz dla wielu pętli.
+///
+/// Przy przeszukiwaniu nastaw wszystkie kandydackie pętle dostają te same sygnały (wspólne liczby
+/// losowe): przebiegi są generowane jednokrotnie, blokami po Simulation::BLOCK chwil, do buforów
+/// wyrównanych do CACHE_LINE bajtów, a potem tylko czytane - także jednocześnie przez wiele wątków.
+/// Wspólny szum zmniejsza wariancję różnic wskaźników jakości między kandydatami.
+class TraceCache
+{
+	size_t n = 0; ///< Liczba chwil (len + 1).
+	AlignedVector<double> setp; ///< Wartość zadana.
+	AlignedVector<double> dist; ///< Zakłócenie wejściowe (puste - brak).
+	AlignedVector<double> noise; ///< Szum pomiarowy (pusty - brak).
+	AlignedVector<double> e; ///< Próbki szumu ARX o wariancji 1 (pusty - brak).
+
+public:
+	/// \brief Konstruktor - generuje przebiegi sygnałów symulacji.
+	/// \param s Symulacja (generatory gen, dist, noise i długość len).
+	/// \param arxNoise Czy wygenerować próbki szumu ARX (ARX::getNoise()). Domyślnie true.
+	TraceCache(Simulation& s, bool arxNoise = true);
+
+	/// \brief Zwraca liczbę chwil przebiegów.
+	size_t size() const { return n; }
+
+	std::span<const double> setpoint() const { return setp; } ///< Wartość zadana.
+	std::span<const double> disturbance() const { return dist; } ///< Zakłócenie wejściowe (puste - brak).
+	std::span<const double> measurement() const { return noise; } ///< Szum pomiarowy (pusty - brak).
+	std::span<const double> arxNoise() const { return e; } ///< Szum ARX przed skalowaniem przez ns_var (pusty - brak).
+
+	/// \brief Krok pętli (loopStep) z sygnałami przebiegów w chwili s.i (puste kanały - zera).
+	/// \tparam T Typ liczb pętli.
+	/// \param s Próbka z indeksem chwili i (mniejszym niż size()) i wyjściem poprzedniej chwili y.
+	/// \param reg Regulator z metodą sim(T).
+	/// \param model Krok obiektu: (T wejście, size_t chwila) -> T wyjście.
+	template <class T, class C, class M>
+	void step(LoopSample<T>& s, C& reg, M&& model) const
+	{
+		s.r = setp[s.i];
+		s.d = dist.empty() ? 0 : dist[s.i];
+		s.v = noise.empty() ? 0 : noise[s.i];
+		loopStep(s, reg, model);
+	}
+};
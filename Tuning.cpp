@@ -0,0 +1,209 @@
+/// \file Tuning.cpp
+/// \brief Zawiera implementację strojenia regulatora PID metodą quasi-Newtona.
+
+#include "Tuning.h"
+#include "Dual.h"
+#include "Scalar.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	using Vec3 = std::array<double, 3>;
+	using Mat3 = std::array<Vec3, 3>;
+
+	/// \brief Iloczyn skalarny wektorów 3-elementowych.
+	double dot3(const Vec3& a, const Vec3& b)
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+	/// \brief Największy moduł elementu wektora.
+	double normInf(const Vec3& a)
+	{
+		return std::max({ std::abs(a[0]), std::abs(a[1]), std::abs(a[2]) });
+	}
+
+	/// \brief Iloczyn macierzy i wektora.
+	Vec3 mul(const Mat3& H, const Vec3& x)
+	{
+		Vec3 y{};
+		for (size_t i = 0; i < 3; ++i)
+			y[i] = dot3(H[i], x);
+		return y;
+	}
+
+	/// \brief Ustawia nastawy regulatora symulacji.
+	void setGains(Simulation& s, const Vec3& x)
+	{
+		s.pid.P = x[0];
+		s.pid.I = x[1];
+		s.pid.D = x[2];
+	}
+}
+
+/**
+ * @brief Wyznacza wskaźnik jakości pętli i jego gradient względem nastaw.
+ *
+ * Pętla jest liczona przez Simulation::forEachStep w liczbach dualnych (pochodne po P, I i D). Przebieg,
+ * w którym wskaźnik przestaje być skończony (pętla niestabilna), jest przerywany z wynikiem J = +inf.
+ * @param s Symulacja.
+ * @param cost Wskaźnik jakości.
+ * @param e Próbki szumu ARX lub pusty zakres.
+ * @return Wskaźnik i gradient.
+ */
+CostGrad pidCost(Simulation& s, Cost cost, std::span<const double> e)
+{
+	using D3 = Dual<3>;
+
+	if (!e.empty() && e.size() != s.len + 1)
+		throw std::invalid_argument("Noise sequence length does not match the simulation!");
+
+	ScalarARX<D3> arx(s.arx);
+	ScalarPID<D3> pid(s.pid);
+	pid.P = D3::variable(s.pid.P, 0);
+	pid.I = D3::variable(s.pid.I, 1);
+	pid.D = D3::variable(s.pid.D, 2);
+
+	D3 J = 0;
+	auto step = [&](D3 in, size_t i) { return arx.step(in, D3(e.empty() ? ARX::getNoise() : e[i])); };
+	s.forEachStep<D3>(pid, step, [&](const LoopSample<D3>& p)
+	{
+		J += cost == Cost::IAE ? abs(p.err) : p.err * p.err;
+		return std::isfinite(J.v);
+	});
+
+	if (!std::isfinite(J.v))
+		return { std::numeric_limits<double>::infinity(), {} };
+	return { J.v, J.d };
+}
+
+/**
+ * @brief Stroi nastawy regulatora metodą BFGS.
+ *
+ * Odwrotność hesjanu jest przybliżana macierzą H (początkowo jednostkową, po pierwszym kroku
+ * skalowaną przez (y's)/(y'y)); pierwszy krok ma długość 10% największej nastawy (co najmniej 0.1).
+ * @param s Symulacja.
+ * @param cost Wskaźnik jakości.
+ * @param maxIter Największa liczba iteracji.
+ * @param gtol Próg zbieżności gradientu.
+ * @return Wynik strojenia.
+ */
+TuneResult tunePID(Simulation& s, Cost cost, size_t maxIter, double gtol)
+{
+	constexpr double ARMIJO = 1e-4; ///< Stała warunku dostatecznego spadku
+	constexpr size_t MAX_BACKTRACK = 40;
+
+	std::vector<double> e(s.len + 1);
+	for (double& v : e)
+		v = ARX::getNoise();
+
+	TuneResult r;
+	auto eval = [&](const Vec3& x)
+	{
+		setGains(s, x);
+		r.evaluations++;
+		r.steps += s.len + 1;
+		return pidCost(s, cost, e);
+	};
+
+	Vec3 x = { s.pid.P, s.pid.I, s.pid.D };
+	CostGrad f = eval(x);
+	r.J0 = f.J;
+	if (!std::isfinite(f.J))
+		throw std::invalid_argument("Initial PID gains give an unstable loop!");
+
+	Mat3 H = { Vec3{ 1, 0, 0 }, Vec3{ 0, 1, 0 }, Vec3{ 0, 0, 1 } };
+	for (; r.iterations < maxIter && normInf(f.grad) > gtol * (1 + f.J); r.iterations++)
+	{
+		Vec3 p = mul(H, f.grad);
+		for (double& v : p)
+			v = -v;
+		if (!r.iterations)
+		{
+			const double scale = 0.1 * std::max(1.0, normInf(x)) / normInf(p);
+			for (double& v : p)
+				v *= scale;
+		}
+		double slope = dot3(f.grad, p);
+		if (slope >= 0)
+		{
+			/// Kierunek nie jest kierunkiem spadku - powrót do najszybszego spadku
+			H = { Vec3{ 1, 0, 0 }, Vec3{ 0, 1, 0 }, Vec3{ 0, 0, 1 } };
+			for (size_t i = 0; i < 3; ++i)
+				p[i] = -f.grad[i];
+			slope = dot3(f.grad, p);
+		}
+
+		/// Cofanie z warunkiem Armijo
+		double alpha = 1;
+		Vec3 xn;
+		CostGrad fn;
+		size_t bt = 0;
+		for (; bt < MAX_BACKTRACK; ++bt, alpha *= 0.5)
+		{
+			for (size_t i = 0; i < 3; ++i)
+				xn[i] = x[i] + alpha * p[i];
+			fn = eval(xn);
+			if (std::isfinite(fn.J) && fn.J <= f.J + ARMIJO * alpha * slope)
+				break;
+		}
+		if (bt == MAX_BACKTRACK)
+			break;
+
+		/// Aktualizacja BFGS odwrotności hesjanu
+		Vec3 sv, yv;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			sv[i] = xn[i] - x[i];
+			yv[i] = fn.grad[i] - f.grad[i];
+		}
+		const double ys = dot3(yv, sv);
+		if (ys > 1e-12 * std::sqrt(dot3(yv, yv) * dot3(sv, sv)))
+		{
+			if (!r.iterations)
+				for (size_t i = 0; i < 3; ++i)
+					H[i][i] = ys / dot3(yv, yv);
+			const double rho = 1 / ys;
+			const Vec3 Hy = mul(H, yv);
+			const double yHy = dot3(yv, Hy);
+			for (size_t i = 0; i < 3; ++i)
+				for (size_t j = 0; j < 3; ++j)
+					H[i][j] += (1 + rho * yHy) * rho * sv[i] * sv[j] - rho * (Hy[i] * sv[j] + sv[i] * Hy[j]);
+		}
+
+		const bool stalled = f.J - fn.J <= 1e-15 * std::abs(f.J);
+		x = xn;
+		f = fn;
+		if (stalled)
+		{
+			r.iterations++;
+			break;
+		}
+	}
+
+	setGains(s, x);
+	r.J = f.J;
+	r.grad = f.grad;
+	return r;
+}
+
+/**
+ * @brief Stroi regulator symulacji zapisanej w pliku i zapisuje wynik do tego pliku.
+ *
+ * Plik jest zapisywany tylko wtedy, gdy udało się go wczytać (Simulation::load zgłasza wyjątek).
+ * @param file Nazwa pliku.
+ * @param cost Wskaźnik jakości.
+ * @return Wynik strojenia.
+ */
+TuneResult tunePID(const std::string& file, Cost cost)
+{
+	Simulation s = Simulation::load(file);
+	TuneResult r = tunePID(s, cost);
+	s.save(file);
+	return r;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Simulation.h"
+
+#include <array>
+#include <span>
+#include <string>
+
+#include "json.hpp"
+using json = nlohmann::json;
+
+/// \file Tuning.h
+/// \brief Zawiera funkcje strojenia regulatora PID metodą quasi-Newtona z gradientem liczonym liczbami dualnymi.
+
+/// \enum Cost
+/// \brief Wskaźnik jakości regulacji.
+enum class Cost
+{
+	IAE, ///< Suma |e(t)|.
+	ISE ///< Suma e(t)^2.
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(Cost, {
+	{ Cost::IAE, "IAE" },
+	{ Cost::ISE, "ISE" },
+})
+
+/// \struct CostGrad
+/// \brief Wartość wskaźnika jakości i jego gradient względem nastaw (P, I, D).
+struct CostGrad
+{
+	double J = 0; ///< Wartość wskaźnika.
+	std::array<double, 3> grad{}; ///< Pochodne dJ/dP, dJ/dI, dJ/dD.
+};
+
+/// \brief Wyznacza wskaźnik jakości pętli i jego dokładny gradient względem nastaw w jednym przebiegu.
+///
+/// Pętla (krok jak w Simulation::run, od stanu s.arx i s.pid i zerowego wyjścia) jest liczona
+/// obiektami ScalarARX<Dual<3>> i ScalarPID<Dual<3>>; obiekty symulacji nie są zmieniane.
+/// \param s Symulacja.
+/// \param cost Wskaźnik jakości.
+/// \param e Próbki szumu ARX (s.len + 1 wartości). Puste - losowane przez ARX::getNoise().
+/// \return Wskaźnik i gradient.
+/// \throws std::invalid_argument Gdy długość e jest niepoprawna.
+CostGrad pidCost(Simulation& s, Cost cost = Cost::ISE, std::span<const double> e = {});
+
+/// \struct TuneResult
+/// \brief Wynik strojenia regulatora.
+struct TuneResult
+{
+	double J0 = 0; ///< Wskaźnik dla nastaw początkowych.
+	double J = 0; ///< Wskaźnik dla nastaw końcowych.
+	std::array<double, 3> grad{}; ///< Gradient w punkcie końcowym.
+	size_t iterations = 0; ///< Liczba iteracji BFGS.
+	size_t evaluations = 0; ///< Liczba przebiegów pętli (każdy daje wskaźnik i gradient).
+	size_t steps = 0; ///< Łączna liczba zasymulowanych kroków.
+};
+
+/// \brief Stroi nastawy P, I, D regulatora s.pid metodą BFGS.
+///
+/// Każdy przebieg pętli daje wskaźnik i gradient (pidCost), a krok jest dobierany przez
+/// cofanie z warunkiem Armijo (nastawy, dla których pętla jest niestabilna, dają wskaźnik
+/// nieskończony i są odrzucane). Szum ARX jest losowany raz i wspólny dla wszystkich przebiegów.
+/// Wynik jest zapisywany w s.pid (stan regulatora nie zmienia się).
+/// \param s Symulacja.
+/// \param cost Wskaźnik jakości.
+/// \param maxIter Największa liczba iteracji.
+/// \param gtol Próg zbieżności: max |dJ/dK| <= gtol * (1 + J).
+/// \return Wynik strojenia.
+TuneResult tunePID(Simulation& s, Cost cost = Cost::ISE, size_t maxIter = 100, double gtol = 1e-6);
+
+/// \brief Wczytuje symulację z pliku JSON, stroi regulator i zapisuje nastawy z powrotem do pliku.
+/// \param file Nazwa pliku (format Simulation::save).
+/// \param cost Wskaźnik jakości.
+/// \return Wynik strojenia.
+/// \throws std::runtime_error Gdy pliku nie można wczytać (plik nie jest wtedy zmieniany).
+TuneResult tunePID(const std::string& file, Cost cost = Cost::ISE);
@@ -9,8 +9,30 @@
 #include "PID.h"
 #include "Generator.h"
 #include "Simulation.h"
+#include "Identification.h"
+#include "Kernels.h"
+#include "PartitionedConv.h"
+#include "Parareal.h"
+#include "ARXBatch.h"
+#include "SimulationBank.h"
+#include "TileScheduler.h"
+#include "FixedPoint.h"
+#include "Tuning.h"
+#include "Relay.h"
+#include "StepMetrics.h"
+#include "TraceCache.h"
+#include "MonteCarlo.h"
+#include "Splitting.h"
 
+#include <cstdint>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iomanip>
+#include <iterator>
+#include <sstream>
 
 #include <vector>
 
@@ -37,14 +59,14 @@ void raportBleduSekwencji(const std::vector<double>& spodz, const std::vector<do
  * Funkcja porównująca dwie sekwencje liczb zmiennoprzecinkowych
  * @param spodz - wektor zawierający spodziewane wartości sekwencji
  * @param fakt - wektor zawierający faktyczne wartości sekwencji
+ * @param tol - tolerancja dla porównań zmiennoprzecinkowych (domyślnie 1e-3)
  * @return true, jeśli sekwencje są takie same; false, odwrotne zdarzenie
  */
-bool porownanieSekwencji(const std::vector<double>& spodz, const std::vector<double>& fakt)
+bool porownanieSekwencji(const std::vector<double>& spodz, const std::vector<double>& fakt, double tol = 1e-3)
 {
-	constexpr double TOL = 1e-3;	// tolerancja dla porównań zmiennoprzecinkowych
 	bool result = fakt.size() == spodz.size();
 	for (int i = 0; result && i < fakt.size(); i++)
-		result = fabs(fakt[i] - spodz[i]) < TOL;
+		result = fabs(fakt[i] - spodz[i]) < tol;
 	return result;
 }
 /**
@@ -195,6 +217,1563 @@ void test_ARX_skokJednostkowy_3()
 	}
 }
 
+// Test - sygnał wielosinusoidalny
+void test_Multisine()
+{
+	//Sygnatura testu:
+	std::cerr << "Multisine (N = 60 | 1, 7, 29 ) -> test zgodnosci z suma kosinusoid i poprawnosci obiektu domyslnego: ";
+	try
+	{
+		// Przygotowanie danych:
+		constexpr size_t N = 60;
+		const std::vector<size_t> prazki = { 1, 7, 29 };
+		const std::vector<double> ampl = { 1, 0.5, 0.25 };
+		json j = SignalHdl::make<SignalMultisine>(N, prazki, ampl, MultisinePhase::Schroeder);
+		SignalHdl instancjaTestowa = j; // sygnał odtworzony z formatu JSON
+		std::vector<double> spodzSygWy(2 * N);
+		std::vector<double> faktSygWy(2 * N);
+
+		// Bezpośrednia suma kosinusoid z fazami Schroedera:
+		for (size_t i = 0; i < 2 * N; i++)
+			for (size_t f = 0; f < prazki.size(); f++)
+				spodzSygWy[i] += ampl[f] * std::cos(2 * std::numbers::pi * prazki[f] * i / N - std::numbers::pi * f * (f + 1) / prazki.size());
+
+		for (size_t i = 0; i < 2 * N; i++)
+			faktSygWy[i] = instancjaTestowa->get(i);
+
+		// Obiekt domyślny jest sygnałem zerowym, a błędny JSON nie zmienia obiektu:
+		SignalMultisine domyslny;
+		bool poprawnyStan = domyslny.get(0) == 0 && domyslny.get(12345) == 0;
+		try
+		{
+			from_json(json{ { "N", 100 }, { "lines", { 1, 2 } }, { "amps", { 1 } } }, domyslny);
+			poprawnyStan = false;
+		}
+		catch (const std::invalid_argument&)
+		{
+			poprawnyStan = poprawnyStan && domyslny.get(99) == 0;
+		}
+
+		// Walidacja poprawności i raport:
+		if (porownanieSekwencji(spodzSygWy, faktSygWy) && poprawnyStan)
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodzSygWy, faktSygWy);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - sygnały świergotowe
+void test_Chirp()
+{
+	//Sygnatura testu:
+	std::cerr << "Chirp (0.001 -> 0.45 | L = 5000 ) -> test zgodnosci wypelniania blokowego z get(): ";
+	try
+	{
+		// Przygotowanie danych (liniowy i wykładniczy, sygnały odtworzone z formatu JSON):
+		constexpr size_t LICZ_ITER = 12000; // więcej niż jeden okres przemiatania
+		json jl = SignalHdl::make<SignalChirpLin>(0.001, 0.45, 5000);
+		json je = SignalHdl::make<SignalChirpExp>(0.001, 0.45, 5000);
+		SignalHdl liniowy = jl;
+		SignalHdl wykladniczy = je;
+		std::vector<double> spodzSygWy(2 * LICZ_ITER);
+		std::vector<double> faktSygWy(2 * LICZ_ITER);
+
+		for (size_t i = 0; i < LICZ_ITER; i++)
+		{
+			spodzSygWy[i] = liniowy->get(i + 7);
+			spodzSygWy[LICZ_ITER + i] = wykladniczy->get(i + 7);
+		}
+		liniowy->fill(7, std::span(faktSygWy).first(LICZ_ITER));
+		wykladniczy->fill(7, std::span(faktSygWy).last(LICZ_ITER));
+
+		// Niepoprawne parametry (zerowa długość, niedodatnia częstotliwość, także z formatu JSON):
+		int odrzucone = 0;
+		const std::vector<std::function<void()>> niepoprawne = {
+			[] { SignalChirpLin(0.1, 0.2, 0); },
+			[] { SignalChirpExp(0.1, 0.2, 0); },
+			[] { SignalChirpExp(0, 0.2, 100); },
+			[] { SignalChirpExp(0.1, -0.2, 100); },
+			[] { json j = SignalHdl::make<SignalChirpLin>(0.1, 0.2, 10); j["p"]["L"] = 0; SignalHdl h = j; },
+			[] { json j = SignalHdl::make<SignalChirpExp>(0.1, 0.2, 10); j["p"]["F0"] = 0.0; SignalHdl h = j; },
+		};
+		for (const auto& f : niepoprawne)
+		{
+			try
+			{
+				f();
+			}
+			catch (const std::invalid_argument&)
+			{
+				odrzucone++;
+			}
+		}
+
+		// Walidacja poprawności i raport:
+		if (porownanieSekwencji(spodzSygWy, faktSygWy) && odrzucone == int(niepoprawne.size()))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL! (odrzucone " << odrzucone << " z " << niepoprawne.size() << ")\n";
+			raportBleduSekwencji(spodzSygWy, faktSygWy);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - sygnał odtwarzany z pliku binarnego i CSV
+void test_SignalRecorded()
+{
+	//Sygnatura testu:
+	std::cerr << "Recorded (bin 1..5 | csv 2 kolumny ) -> test probek, podtrzymania/zapetlenia, interpolacji, kolumny CSV, pliku pomocniczego, odcisku i skrotu: ";
+	const std::string bin = "test_recorded.bin", csv = "test_recorded.csv", side = csv + ".bin";
+	try
+	{
+		// Przygotowanie danych - plik binarny z próbkami 1, ..., 5 i plik CSV z nagłówkiem i kolumną indeksu:
+		const std::vector<double> probki = { 1, 2, 3, 4, 5 };
+		{
+			std::ofstream ofs(bin, std::ios::binary);
+			ofs.write(reinterpret_cast<const char*>(probki.data()), probki.size() * sizeof(double));
+			std::ofstream ocs(csv);
+			ocs << "Iteracja,Wyjscie\n0,10\n1,20\n2,30\n";
+		}
+
+		// Podtrzymanie i zapętlenie po końcu nagrania, interpolacja i podtrzymanie między próbkami (krok 0.5):
+		const SignalRecorded podtrzymanie(bin), petla(bin, RecordFormat::Binary, false, true);
+		const SignalRecorded interp(bin, RecordFormat::Binary, true, false, 0.5), schodki(bin, RecordFormat::Binary, false, false, 0.5);
+		const bool odtwarzanie = podtrzymanie.get(0) == 1 && podtrzymanie.get(4) == 5 && podtrzymanie.get(7) == 5
+			&& petla.get(7) == 3 && petla.get(10) == 1 && interp.get(1) == 1.5 && interp.get(2) == 2 && schodki.get(1) == 1 && schodki.get(3) == 2;
+
+		// CSV - kolumna 1, utworzenie pliku pomocniczego i jego ponowne użycie (podmieniona próbka):
+		const SignalRecorded zCSV(csv, RecordFormat::CSV, false, false, 1, 1);
+		bool kolumna = zCSV.get(0) == 10 && zCSV.get(2) == 30 && zCSV.get(5) == 30 && std::ifstream(side).good();
+		{
+			std::fstream fs(side, std::ios::binary | std::ios::in | std::ios::out);
+			fs.seekp(-3 * std::streamoff(sizeof(double)), std::ios::end);
+			const double znacznik = 99;
+			fs.write(reinterpret_cast<const char*>(&znacznik), sizeof(double));
+		}
+		const bool ponowne = SignalRecorded(csv, RecordFormat::CSV, false, false, 1, 1).get(0) == 99;
+
+		// Inna kolumna (indeks iteracji) - plik pomocniczy tworzony od nowa, kolumna zachowana w JSON:
+		json jc = SignalHdl::make<SignalRecorded>(csv, RecordFormat::CSV, false, false, 1, 0);
+		SignalHdl zJSON = jc;
+		kolumna = kolumna && jc["p"]["column"] == 0 && zJSON->get(0) == 0 && zJSON->get(2) == 2;
+
+		// Duży plik CSV - zmiana jednej cyfry w środku (ten sam rozmiar, poza próbkowanymi blokami odcisku):
+		const std::string duzy = "test_recorded_duzy.csv", duzySide = duzy + ".bin";
+		{
+			std::ofstream ocs(duzy);
+			for (size_t i = 0; i < 20000; i++)
+				ocs << i << "," << 100000 + i << "\n";
+		}
+		const json jd = SignalHdl::make<SignalRecorded>(duzy, RecordFormat::CSV, false, false, 1, 1);
+		{
+			std::fstream fs(duzy, std::ios::in | std::ios::out);
+			std::string tresc((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+			fs.seekp(std::streamoff(tresc.find("\n10000,1") + 7));
+			fs.put('9');
+		}
+		std::filesystem::last_write_time(duzy, std::filesystem::last_write_time(duzy) + std::chrono::seconds(2));
+		const bool zmiana = SignalRecorded(duzy, RecordFormat::CSV, false, false, 1, 1).get(10000) == 910000
+			&& jd["p"]["fingerprint"] == json(SignalHdl::make<SignalRecorded>(duzy, RecordFormat::CSV, false, false, 1, 1))["p"]["fingerprint"]
+			&& !std::ifstream(duzySide + ".tmp").good();
+		bool staryHash = false;
+		try
+		{
+			SignalHdl h = jd;
+		}
+		catch (const std::runtime_error&)
+		{
+			staryHash = true;
+		}
+		std::remove(duzy.c_str());
+		std::remove(duzySide.c_str());
+
+		// Niezgodny odcisk lub skrót - zapisany w JSON oraz po zmianie zawartości pliku:
+		int odrzucone = 0;
+		json jb = SignalHdl::make<SignalRecorded>(bin);
+		json jz = jb;
+		jz["p"]["hash"] = "0000000000000000";
+		{
+			std::ofstream ofs(csv);
+			ofs << "Iteracja,Wyjscie\n0,11\n";
+		}
+		json js = jc;
+		{
+			std::ofstream ofs(bin, std::ios::binary);
+			ofs.write(reinterpret_cast<const char*>(probki.data()), 2 * sizeof(double));
+		}
+		for (const json* j : { &jz, &jb, &js })
+		{
+			try
+			{
+				SignalHdl h = *j;
+			}
+			catch (const std::runtime_error&)
+			{
+				odrzucone++;
+			}
+		}
+
+		// Walidacja poprawności i raport:
+		if (odtwarzanie && kolumna && ponowne && zmiana && staryHash && odrzucone == 3)
+			std::cerr << "OK!\n";
+		else
+			std::cerr << "FAIL! (odtwarzanie " << odtwarzanie << ", kolumna " << kolumna << ", ponowne " << ponowne << ", zmiana " << zmiana << ", staryHash " << staryHash << ", odrzucone " << odrzucone << ")\n";
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+	std::remove(bin.c_str());
+	std::remove(csv.c_str());
+	std::remove(side.c_str());
+}
+
+// Test - identyfikacja modelu ARX
+void test_Identyfikacja_ARX()
+{
+	//Sygnatura testu:
+	std::cerr << "ARX (A = -1.2, 0.5 | B = 1, 0.5 | 1 | 0 ) -> test identyfikacji z danych bez szumu: ";
+	try
+	{
+		// Przygotowanie danych:
+		ARX obiekt({ -1.2, 0.5 }, { 1, 0.5 }, 1, 0);
+		constexpr size_t LICZ_ITER = 2000;
+		std::vector<double> sygWe(LICZ_ITER);
+		std::vector<double> sygWy(LICZ_ITER);
+		std::vector<double> spodzParam = { -1.2, 0.5, 1, 0.5, 0 }; // spodziewane parametry A, B i odchylenie residuów
+		std::vector<double> faktParam;
+
+		// Pobudzenie sumą sygnału prostokątnego i sinusoidalnego:
+		SignalSquare prost(37, 0.4);
+		SignalSine sin(11);
+		for (size_t i = 0; i < LICZ_ITER; i++)
+		{
+			sygWe[i] = prost.get(i) + 0.5 * sin.get(i);
+			sygWy[i] = obiekt.sim(sygWe[i]);
+		}
+
+		// Identyfikacja modelu:
+		json j = identifyARX(sygWe, sygWy, 2, 2, 1);
+		for (double a : j["A"])
+			faktParam.push_back(a);
+		for (double b : j["B"])
+			faktParam.push_back(b);
+		faktParam.push_back(j["ns_var"]);
+
+		// Walidacja poprawności i raport:
+		if (porownanieSekwencji(spodzParam, faktParam))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodzParam, faktParam);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - identyfikacja modelu ARMAX
+void test_Identyfikacja_ARMAX()
+{
+	//Sygnatura testu:
+	std::cerr << "ARMAX (A = -0.7 | B = 1, 0.5 | C = 0.4 | 1 | szum 0.2 ) -> test identyfikacji obiektu i filtru szumu: ";
+	try
+	{
+		// Przygotowanie danych - filtr szumu C jest identyfikowalny tylko przy niezerowym szumie, więc
+		// dane pochodzą z modelu o dokładnie tej strukturze (bez zakłóceń spoza modelu) i długiego rekordu:
+		ARMAX obiekt({ -0.7 }, { 1, 0.5 }, { 0.4 }, 1, 0.2);
+		constexpr size_t LICZ_ITER = 20000;
+		std::vector<double> sygWe(LICZ_ITER);
+		std::vector<double> sygWy(LICZ_ITER);
+		std::vector<double> spodzParam = { -0.7, 1, 0.5, 0.4, 0.2 }; // spodziewane parametry A, B, C i amplituda szumu
+		std::vector<double> faktParam;
+
+		// Pobudzenie sumą sygnału prostokątnego i sinusoidalnego:
+		SignalSquare prost(37, 0.4);
+		SignalSine sin(11);
+		for (size_t i = 0; i < LICZ_ITER; i++)
+		{
+			sygWe[i] = prost.get(i) + 0.5 * sin.get(i);
+			sygWy[i] = obiekt.sim(sygWe[i]);
+		}
+
+		// Identyfikacja modelu:
+		json j = identifyARMAX(sygWe, sygWy, 1, 2, 1, 1);
+		for (const char* w : { "A", "B", "C" })
+			for (double c : j[w])
+				faktParam.push_back(c);
+		faktParam.push_back(j["ns_var"]);
+
+		// Walidacja poprawności i raport (tolerancja błędu estymacji z 20000 próbek):
+		if (porownanieSekwencji(spodzParam, faktParam, 0.03))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodzParam, faktParam);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - identyfikacja modelu BJ z filtrem szumu
+void test_Identyfikacja_BJ()
+{
+	//Sygnatura testu:
+	std::cerr << "BJ (B = 1, 0.5 | F = -0.8 | C = 0.3 | D = -0.6 | 1 | szum 0.2 ) -> test identyfikacji obiektu i filtru szumu: ";
+	try
+	{
+		// Przygotowanie danych (jak dla ARMAX - szum o strukturze modelu, długi rekord):
+		BJ obiekt({ 1, 0.5 }, { -0.8 }, { 0.3 }, { -0.6 }, 1, 0.2);
+		constexpr size_t LICZ_ITER = 20000;
+		std::vector<double> sygWe(LICZ_ITER);
+		std::vector<double> sygWy(LICZ_ITER);
+		std::vector<double> spodzParam = { 1, 0.5, -0.8, 0.3, -0.6, 0.2 }; // spodziewane parametry B, F, C, D i amplituda szumu
+		std::vector<double> faktParam;
+
+		// Pobudzenie sumą sygnału prostokątnego i sinusoidalnego:
+		SignalSquare prost(37, 0.4);
+		SignalSine sin(11);
+		for (size_t i = 0; i < LICZ_ITER; i++)
+		{
+			sygWe[i] = prost.get(i) + 0.5 * sin.get(i);
+			sygWy[i] = obiekt.sim(sygWe[i]);
+		}
+
+		// Identyfikacja modelu:
+		json j = identifyBJ(sygWe, sygWy, 2, 1, 1, 1, 1);
+		for (const char* w : { "B", "F", "C", "D" })
+			for (double c : j[w])
+				faktParam.push_back(c);
+		faktParam.push_back(j["ns_var"]);
+
+		// Walidacja poprawności i raport (tolerancja błędu estymacji z 20000 próbek):
+		if (porownanieSekwencji(spodzParam, faktParam, 0.03))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodzParam, faktParam);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - identyfikacja modelu OE
+void test_Identyfikacja_OE()
+{
+	//Sygnatura testu:
+	std::cerr << "OE (B = 1, 0.5 | F = -0.8 | 1 | 0 ) -> test identyfikacji z danych bez szumu: ";
+	try
+	{
+		// Przygotowanie danych:
+		BJ obiekt({ 1, 0.5 }, { -0.8 }, {}, {}, 1, 0);
+		constexpr size_t LICZ_ITER = 2000;
+		std::vector<double> sygWe(LICZ_ITER);
+		std::vector<double> sygWy(LICZ_ITER);
+		std::vector<double> spodzParam = { 1, 0.5, -0.8 }; // spodziewane parametry B, F
+		std::vector<double> faktParam;
+
+		// Pobudzenie sumą sygnału prostokątnego i sinusoidalnego:
+		SignalSquare prost(37, 0.4);
+		SignalSine sin(11);
+		for (size_t i = 0; i < LICZ_ITER; i++)
+		{
+			sygWe[i] = prost.get(i) + 0.5 * sin.get(i);
+			sygWy[i] = obiekt.sim(sygWe[i]);
+		}
+
+		// Identyfikacja modelu:
+		json j = identifyBJ(sygWe, sygWy, 2, 1, 0, 0, 1);
+		for (double b : j["B"])
+			faktParam.push_back(b);
+		for (double f : j["F"])
+			faktParam.push_back(f);
+
+		// Walidacja poprawności i raport:
+		if (porownanieSekwencji(spodzParam, faktParam))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodzParam, faktParam);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - identyfikacja metodą błędu predykcji
+void test_Identyfikacja_PEM()
+{
+	//Sygnatura testu:
+	std::cerr << "PEM (B = 1, 0.5 | A = -1.2, 0.5 | 1 | szum 0.3 ) -> test gradientu sprzezonego z punktami kontrolnymi i identyfikacji: ";
+	try
+	{
+		// Przygotowanie danych - model OE z szumem pomiarowym:
+		BJ obiekt({ 1, 0.5 }, { -1.2, 0.5 }, {}, {}, 1, 0);
+		constexpr size_t LICZ_ITER = 20000;
+		std::vector<double> sygWe(LICZ_ITER), sygWy(LICZ_ITER);
+		SignalSquare prost(37, 0.4);
+		SignalSine sin(11);
+		for (size_t i = 0; i < LICZ_ITER; i++)
+		{
+			sygWe[i] = prost.get(i) + 0.5 * sin.get(i);
+			sygWy[i] = obiekt.sim(sygWe[i]) + 0.3 * ARX::getNoise();
+		}
+
+		// Gradient sprzężony (punkty kontrolne co ceil(sqrt(N)) i co 1 chwilę) a różnice centralne:
+		std::vector<double> th = { -1.1, 0.45, 0.9, 0.6 }, spodz, fakt(4), faktPelny(4);
+		auto strata = [&](const std::vector<double>& x, std::span<double> g, size_t c)
+		{
+			return pemLoss(sygWe, sygWy, std::span(x).first(2), std::span(x).subspan(2), 1, g, c);
+		};
+		strata(th, fakt, 0);
+		strata(th, faktPelny, 1);
+		for (size_t i = 0; i < th.size(); i++)
+		{
+			constexpr double h = 1e-6;
+			std::vector<double> tp = th, tm = th;
+			tp[i] += h;
+			tm[i] -= h;
+			spodz.push_back((strata(tp, {}, 0) - strata(tm, {}, 0)) / (2 * h));
+		}
+
+		// Identyfikacja i zapis w formacie ARX:
+		PEMStats st;
+		json j = identifyPEM(sygWe, sygWy, 2, 2, 1, {}, &st);
+		const std::vector<double> spodzParam = { -1.2, 0.5, 1, 0.5 };
+		std::vector<double> faktParam;
+		for (double a : j["A"])
+			faktParam.push_back(a);
+		for (double b : j["B"])
+			faktParam.push_back(b);
+		bool blisko = faktParam.size() == 4 && j["k"] == 1;
+		for (size_t i = 0; blisko && i < 4; i++)
+			blisko = std::abs(faktParam[i] - spodzParam[i]) < 0.02;
+
+		// Walidacja poprawności i raport:
+		if (porownanieSekwencji(spodz, fakt) && porownanieSekwencji(fakt, faktPelny) && blisko && st.V <= st.V0 && st.memory < LICZ_ITER / 10)
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodz, fakt);
+			raportBleduSekwencji(spodzParam, faktParam);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - reprezentacja rzadka
+void test_ARX_rzadki()
+{
+	//Sygnatura testu:
+	std::cerr << "ARX (-0.4, 0, 0, 0.1 | 0, ..., 0, 0.6 | 5000 | 0 ) -> test zgodnosci reprezentacji rzadkiej z gesta: ";
+	try
+	{
+		// Przygotowanie danych - ten sam model zapisany z opóźnieniem k oraz zerami w B:
+		constexpr size_t K = 5000;
+		json j = ARX({ -0.4, 0, 0, 0.1 }, { 0.6, 0, 0.2 }, K, 0);
+		json jz = j;
+		jz["k"] = 0;
+		jz["B"] = std::vector<double>(K);
+		jz["B"].insert(jz["B"].end(), { 0.6, 0, 0.2 });
+
+		ARX gesty({ -0.4, 0, 0, 0.1 }, { 0.6, 0, 0.2 }, 0, 0); // model gęsty (bez opóźnienia) jako odniesienie
+		ARX rzadki = jz.get<ARX>();
+		constexpr size_t LICZ_ITER = K + 200;
+		std::vector<double> spodzSygWy(LICZ_ITER);
+		std::vector<double> faktSygWy(LICZ_ITER);
+
+		// Odpowiedź na skok w chwili 1 - model rzadki musi dać odpowiedź gęstego przesuniętą o K:
+		for (size_t i = 0; i < LICZ_ITER; i++)
+		{
+			spodzSygWy[i] = (i < K) ? 0 : gesty.sim(!!(i - K));
+			faktSygWy[i] = rzadki.sim(!!i);
+		}
+
+		// Walidacja poprawności i raport:
+		if (rzadki.isSparse() && porownanieSekwencji(spodzSygWy, faktSygWy))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(std::vector<double>(spodzSygWy.end() - 30, spodzSygWy.end()), std::vector<double>(faktSygWy.end() - 30, faktSygWy.end()));
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - splot blokowy długiego licznika
+void test_ARX_splot()
+{
+	//Sygnatura testu:
+	std::cerr << "ARX (-0.5 | 3000 wsp. | 3 | 0 ) -> test zgodnosci splotu blokowego z bezposrednim i przeplotu blokow 64 i 256: ";
+	try
+	{
+		// Przygotowanie danych - długi licznik (tłumiona oscylacja) i pobudzenie o zmiennym znaku:
+		constexpr size_t NB = 3000, K = 3, LICZ_ITER = 8000;
+		std::vector<double> b(NB), u(LICZ_ITER);
+		for (size_t j = 0; j < NB; j++)
+			b[j] = std::exp(-0.002 * j) * std::sin(0.05 * j) / 30;
+		for (size_t i = 0; i < LICZ_ITER; i++)
+			u[i] = std::sin(0.013 * i) + ((i / 37) % 2 ? 0.5 : -0.5);
+
+		json j = ARX({ -0.5 }, {}, K, 0);
+		j["B"] = b;
+		ARX splot = j.get<ARX>();
+
+		std::vector<double> spodzSygWy(LICZ_ITER);
+		std::vector<double> faktSygWy(LICZ_ITER);
+		for (size_t i = 0; i < LICZ_ITER; i++)
+		{
+			// Odniesienie: y(i) = sum B_j u(i-K-j) + 0.5 y(i-1)
+			double y = i ? 0.5 * spodzSygWy[i - 1] : 0;
+			for (size_t jj = 0; jj < NB && jj + K <= i; jj++)
+				y += b[jj] * u[i - K - jj];
+			spodzSygWy[i] = y;
+			faktSygWy[i] = splot.sim(u[i]);
+		}
+
+		// Sploty o różnych blokach przeplatane (wspólna tablica pierwiastków FFT) a liczone osobno - wyniki identyczne bitowo:
+		PartitionedConv osobno64(b, 64), osobno256(b, 256), przeplot64(b, 64), przeplot256(b, 256);
+		std::vector<double> y64(LICZ_ITER), y256(LICZ_ITER);
+		for (size_t i = 0; i < LICZ_ITER; i++)
+			y64[i] = osobno64.process(u[i]);
+		for (size_t i = 0; i < LICZ_ITER; i++)
+			y256[i] = osobno256.process(u[i]);
+		bool przeplot = true;
+		for (size_t i = 0; i < LICZ_ITER; i++)
+			przeplot = przeplot && przeplot64.process(u[i]) == y64[i] && przeplot256.process(u[i]) == y256[i];
+
+		// Walidacja poprawności i raport:
+		if (splot.representation() == ARX::Representation::Conv && porownanieSekwencji(spodzSygWy, faktSygWy) && przeplot)
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(std::vector<double>(spodzSygWy.end() - 30, spodzSygWy.end()), std::vector<double>(faktSygWy.end() - 30, faktSygWy.end()));
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - równoległa symulacja w układzie otwartym
+void test_ARX_rownolegle()
+{
+	//Sygnatura testu:
+	std::cerr << "ARX (-1.5, 0.7 | 0.3, 0.2, -0.1 | 2 | 0 ) -> test zgodnosci symulacji rownoleglej (4 watki) z szeregowa: ";
+	try
+	{
+		// Przygotowanie danych - długi przebieg wejścia, model szeregowy jako odniesienie:
+		constexpr size_t LICZ_ITER = 200000, DALEJ = 50;
+		ARX szeregowy({ -1.5, 0.7 }, { 0.3, 0.2, -0.1 }, 2, 0);
+		ARX rownolegly = szeregowy;
+		std::vector<double> u(LICZ_ITER), faktSygWy(LICZ_ITER);
+		for (size_t i = 0; i < LICZ_ITER; i++)
+			u[i] = std::sin(0.001 * i) + ((i / 1000) % 2 ? 1 : 0);
+
+		std::vector<double> spodzSygWy(LICZ_ITER);
+		for (size_t i = 0; i < LICZ_ITER; i++)
+			spodzSygWy[i] = szeregowy.sim(u[i]);
+		rownolegly.simulate(u, faktSygWy, 4);
+
+		// Stan po symulacji równoległej musi pozwalać kontynuować symulację krok po kroku:
+		for (size_t i = 0; i < DALEJ; i++)
+		{
+			spodzSygWy.push_back(szeregowy.sim(1));
+			faktSygWy.push_back(rownolegly.sim(1));
+		}
+
+		double maxBlad = 0, maxWy = 0;
+		for (size_t i = 0; i < spodzSygWy.size(); i++)
+		{
+			maxBlad = std::max(maxBlad, std::abs(spodzSygWy[i] - faktSygWy[i]));
+			maxWy = std::max(maxWy, std::abs(spodzSygWy[i]));
+		}
+
+		// Walidacja poprawności i raport (tolerancja udokumentowana w ARX::simulate):
+		if (maxBlad <= 1e-9 * maxWy && porownanieSekwencji(spodzSygWy, faktSygWy))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(std::vector<double>(spodzSygWy.end() - 30, spodzSygWy.end()), std::vector<double>(faktSygWy.end() - 30, faktSygWy.end()));
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - symulacja równoległa w czasie (parareal)
+void test_Parareal()
+{
+	//Sygnatura testu:
+	std::cerr << "Parareal (ARX (-0.6, 0.1 | 0.3, 0.15 | 1 | 0 ), PID, zaklocenie) -> test zgodnosci z symulacja szeregowa: ";
+	try
+	{
+		// Przygotowanie danych - pętla z zakłóceniem wejściowym, 4 okna po 8 segmentów:
+		constexpr size_t LICZ_ITER = 50000;
+		Generator gen;
+		gen.add(1, SignalHdl::make<SignalDelay>(2, SignalHdl::make<SignalConst>()));
+		gen.add(1, SignalHdl::make<SignalSine>(3000));
+		Simulation sim(ARX({ -0.6, 0.1 }, { 0.3, 0.15 }, 1, 0), PID(0.8, 0.15, 0.1), std::move(gen), LICZ_ITER - 1);
+		sim.dist.add(0.1, SignalHdl::make<SignalSquare>(777, 0.5));
+
+		// Odniesienie - ten sam krok co w Simulation::run:
+		ARX arx = sim.arx;
+		PID pid = sim.pid;
+		std::vector<double> spodzSygWy(LICZ_ITER), setp(LICZ_ITER), dist(LICZ_ITER);
+		sim.gen.fill(0, setp);
+		sim.dist.fill(0, dist);
+		double arxout = 0;
+		for (size_t i = 0; i < LICZ_ITER; i++)
+			spodzSygWy[i] = arxout = arx.sim(pid.sim(setp[i] - arxout) + dist[i]);
+
+		Parareal par(sim);
+		par.threads = 4;
+		par.segments = 8;
+		par.segLen = 1600;
+		std::vector<double> faktSygWy;
+		Parareal::Stats st = par.run("", &faktSygWy);
+
+		// Walidacja poprawności i raport - pętla liniowa wymaga dwóch przebiegów dokładnych:
+		if (st.windows == 4 && st.maxIterations <= 2 && porownanieSekwencji(spodzSygWy, faktSygWy))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(std::vector<double>(spodzSygWy.end() - 30, spodzSygWy.end()), std::vector<double>(faktSygWy.end() - 30, faktSygWy.end()));
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - wiele przebiegów przez ten sam model
+void test_ARXBatch()
+{
+	//Sygnatura testu:
+	std::cerr << "ARXBatch (-1.5, 0.7 | 0.3, 0.2, -0.1 | 2 | 0 ) x 37 przebiegow -> test zgodnosci z niezaleznymi obiektami ARX: ";
+	try
+	{
+		// Przygotowanie danych - liczba przebiegów niebędąca wielokrotnością LANES:
+		constexpr size_t M = 37, LICZ_ITER = 500;
+		ARX model({ -1.5, 0.7 }, { 0.3, 0.2, -0.1 }, 2, 0);
+		std::vector<double> u(M * LICZ_ITER), spodzSygWy(M * LICZ_ITER), faktSygWy(M * LICZ_ITER);
+		for (size_t m = 0; m < M; m++)
+			for (size_t i = 0; i < LICZ_ITER; i++)
+				u[m * LICZ_ITER + i] = std::sin(0.01 * (m + 1) * i) + (i >= m);
+
+		for (size_t m = 0; m < M; m++)
+		{
+			ARX arx = model;
+			for (size_t i = 0; i < LICZ_ITER; i++)
+				spodzSygWy[m * LICZ_ITER + i] = arx.sim(u[m * LICZ_ITER + i]);
+		}
+		ARXBatch batch(model, M);
+		batch.run(u, faktSygWy, LICZ_ITER);
+
+		// Walidacja poprawności i raport:
+		if (porownanieSekwencji(spodzSygWy, faktSygWy))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(std::vector<double>(spodzSygWy.end() - 30, spodzSygWy.end()), std::vector<double>(faktSygWy.end() - 30, faktSygWy.end()));
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - bank pętli regulacji
+void test_SimulationBank()
+{
+	//Sygnatura testu:
+	std::cerr << "SimulationBank (40 petli ARX + PID o roznych rzedach, opoznieniach, nastawach i dlugosciach, jedna z pliku) -> test zgodnosci z symulacja szeregowa i IAE/ISE: ";
+	try
+	{
+		// Przygotowanie danych - liczba pętli niebędąca wielokrotnością LANES, dwa kafle sygnałów:
+		constexpr size_t M = 40, LICZ_ITER = 2000;
+		auto petla = [](size_t m, Simulation& sim)
+		{
+			const double a = -0.6 + 0.01 * (m % 10), b = -0.05 * (m % 5);
+			const unsigned k = unsigned(1 + m % 3);
+			Generator gen;
+			gen.add(1, SignalHdl::make<SignalDelay>(m, SignalHdl::make<SignalConst>()));
+			gen.add(0.5, SignalHdl::make<SignalSine>(100 + 10 * m));
+			if (m % 4 == 1)
+				sim.arx = m % 3 == 2 ? ARX({ a, 0.1, 0.05 }, { 0.3, 0.15, b }, k, 0) : ARX({ a, 0.1, 0.05 }, { 0.3, 0.15 }, k, 0);
+			else
+				sim.arx = m % 3 == 2 ? ARX({ a, 0.1 }, { 0.3, 0.15, b }, k, 0) : ARX({ a, 0.1 }, { 0.3, 0.15 }, k, 0);
+			sim.pid = PID(0.3 + 0.01 * (m % 7), 0.05, 0.02 * (m % 3));
+			sim.gen = std::move(gen);
+			sim.len = m % 5 == 3 ? LICZ_ITER / 2 + m : LICZ_ITER - 1; // część pętli z krótszym horyzontem
+			if (m % 2)
+				sim.dist.add(0.1, SignalHdl::make<SignalSquare>(77 + m, 0.5));
+		};
+
+		SimulationBank bank;
+		for (size_t m = 0; m < M; m++)
+		{
+			Simulation sim;
+			petla(m, sim);
+			if (m == 7)
+			{
+				sim.save("test_bank.json");
+				bank.add(std::string("test_bank.json"));
+				std::remove("test_bank.json");
+			}
+			else
+				bank.add(std::move(sim));
+		}
+
+		// Odniesienie - ten sam krok co w Simulation::run (wskaźniki do końca własnego horyzontu pętli):
+		std::vector<double> spodzSygWy(M * LICZ_ITER), faktSygWy(M * LICZ_ITER), setp(LICZ_ITER), dist(LICZ_ITER);
+		std::vector<double> spodzIAE(M), spodzISE(M);
+		for (size_t m = 0; m < M; m++)
+		{
+			Simulation sim;
+			petla(m, sim);
+			sim.gen.fill(0, setp);
+			std::fill(dist.begin(), dist.end(), 0.0);
+			if (!sim.dist.empty())
+				sim.dist.fill(0, dist);
+			double arxout = 0;
+			for (size_t i = 0; i < LICZ_ITER; i++)
+			{
+				const double err = setp[i] - arxout;
+				if (i <= sim.len)
+				{
+					spodzIAE[m] += std::abs(err);
+					spodzISE[m] += err * err;
+				}
+				spodzSygWy[m * LICZ_ITER + i] = arxout = sim.arx.sim(sim.pid.sim(err) + dist[i]);
+			}
+		}
+		bank.run(faktSygWy, 2);
+
+		// Walidacja poprawności i raport:
+		if (bank.size() == M && porownanieSekwencji(spodzSygWy, faktSygWy) && porownanieSekwencji(spodzIAE, bank.iae) && porownanieSekwencji(spodzISE, bank.ise))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(std::vector<double>(spodzSygWy.end() - 30, spodzSygWy.end()), std::vector<double>(faktSygWy.end() - 30, faktSygWy.end()));
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - harmonogram kafli czasowych
+void test_TileScheduler()
+{
+	//Sygnatura testu:
+	std::cerr << "TileScheduler (12 petli o roznych horyzontach, dobor kafla) -> test zgodnosci dziennikow z symulacja szeregowa: ";
+	try
+	{
+		// Przygotowanie danych - horyzonty niebędące wielokrotnością żadnego kafla:
+		constexpr size_t M = 12;
+		std::vector<Simulation> sims(M);
+		std::vector<std::ostringstream> logi(M);
+		TileScheduler harm;
+		for (size_t m = 0; m < M; m++)
+		{
+			Generator gen;
+			gen.add(1, SignalHdl::make<SignalDelay>(m, SignalHdl::make<SignalConst>()));
+			gen.add(0.5, SignalHdl::make<SignalSine>(200 + 10 * m));
+			sims[m].arx = ARX({ -0.6 + 0.02 * m, 0.1 }, { 0.3, 0.15 }, unsigned(1 + m % 3), 0);
+			sims[m].pid = PID(0.3 + 0.01 * m, 0.05, 0.02);
+			sims[m].gen = std::move(gen);
+			sims[m].len = 3000 + 257 * m;
+			if (m % 2)
+				sims[m].dist.add(0.1, SignalHdl::make<SignalSquare>(77 + m, 0.5));
+			harm.add(sims[m], m % 3 ? &logi[m] : nullptr);
+		}
+
+		// Odniesienie - ten sam krok i format co w Simulation::run:
+		bool zgodne = true;
+		std::vector<double> spodzSygWy, faktSygWy;
+		std::vector<std::string> spodzLogi(M);
+		for (size_t m = 0; m < M; m++)
+		{
+			ARX arx = sims[m].arx;
+			PID pid = sims[m].pid;
+			std::vector<double> setp(sims[m].len + 1), dist(sims[m].len + 1);
+			sims[m].gen.fill(0, setp);
+			if (!sims[m].dist.empty())
+				sims[m].dist.fill(0, dist);
+			std::ostringstream out;
+			out << "Iteracja,Zadana,Blad,Sterowanie,Wyjscie";
+			if (!sims[m].dist.empty())
+				out << ",Zaklocenie,Szum";
+			out << std::endl;
+			double arxout = 0;
+			for (size_t i = 0; i < setp.size(); i++)
+			{
+				const double err = setp[i] - arxout;
+				const double ster = pid.sim(err);
+				arxout = arx.sim(ster + dist[i]);
+				out << i << "," << setp[i] << "," << err << "," << ster << "," << arxout;
+				if (!sims[m].dist.empty())
+					out << "," << dist[i] << "," << 0.0;
+				out << "\n";
+			}
+			spodzLogi[m] = out.str();
+			spodzSygWy.push_back(arxout);
+		}
+
+		TileScheduler::Stats st = harm.run();
+		for (size_t m = 0; m < M; m++)
+		{
+			faktSygWy.push_back(harm.output(m));
+			if (m % 3)
+				zgodne = zgodne && logi[m].str() == spodzLogi[m];
+		}
+
+		// Walidacja poprawności i raport:
+		if (zgodne && std::find(std::begin(TileScheduler::TILES), std::end(TileScheduler::TILES), st.tile) != std::end(TileScheduler::TILES) && porownanieSekwencji(spodzSygWy, faktSygWy))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodzSygWy, faktSygWy);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - symulacja w typie float i long double
+void test_Scalar()
+{
+	//Sygnatura testu:
+	std::cerr << "Simulation (scalar = float, long double) -> test zapisu typu w JSON i raportu dokladnosci wzgledem double: ";
+	try
+	{
+		// Przygotowanie danych - stabilna pętla z zakłóceniem, typ float zapisany w pliku:
+		Generator gen;
+		gen.add(1, SignalHdl::make<SignalDelay>(2, SignalHdl::make<SignalConst>()));
+		gen.add(1, SignalHdl::make<SignalSine>(300));
+		Simulation sim(ARX({ -0.6, 0.1 }, { 0.3, 0.15 }, 1, 0), PID(0.8, 0.15, 0.1), std::move(gen), 5000);
+		sim.dist.add(0.1, SignalHdl::make<SignalSquare>(777, 0.5));
+		sim.scalar = ScalarType::Float;
+		sim.save("test_scalar.json");
+		Simulation wczytana("test_scalar.json");
+		std::remove("test_scalar.json");
+
+		const ScalarReport f = wczytana.compare(ScalarType::Float);
+		const ScalarReport ld = wczytana.compare(ScalarType::LongDouble);
+		wczytana.advance(100); ///< Niezerowy stan początkowy modelu i regulatora
+		const ScalarReport d = wczytana.compare(ScalarType::Double);
+
+		// Walidacja poprawności i raport - błąd float rzędu precyzji float, long double i double zgodne (od stanu po advance):
+		if (wczytana.scalar == ScalarType::Float && f.steps == 5001 && f.maxRel > 0 && f.maxRel < 1e-4 && ld.maxRel < 1e-9 && d.maxRel < 1e-12)
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			std::cerr << "  " << f << "\n  " << ld << "\n  " << d << "\n\n";
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - regulator i model stałoprzecinkowy
+void test_FixedPoint()
+{
+	//Sygnatura testu:
+	std::cerr << "FixedPID + FixedARX (Q16.16 | Q8.24) -> test zaokraglen, nasycenia i odchylenia od petli double: ";
+	try
+	{
+		// Zaokrąglenia i przepełnienia w formacie Q8.4 (LSB = 1/16):
+		QFormat q{ 8, 4 };
+		const bool polowka = q.quantize(1.0 / 32) == 1;
+		q.round = Rounding::Even;
+		const bool parzysta = q.quantize(1.0 / 32) == 0 && q.quantize(3.0 / 32) == 2 && q.shift(-24, 4) == -2;
+		q.round = Rounding::Truncate;
+		const bool obciecie = q.quantize(-1.0 / 32) == -1 && q.shift(31, 4) == 1;
+		size_t nasycenia = 0;
+		const bool nasycenie = q.quantize(100, &nasycenia) == 127 && nasycenia == 1;
+		q.overflow = Overflow::Wrap;
+		const bool zawiniecie = q.quantize(8) == -128 && q.fit(130) == -126;
+
+		// Pętla stałoprzecinkowa obok pętli double:
+		Generator gen;
+		gen.add(1, SignalHdl::make<SignalDelay>(2, SignalHdl::make<SignalConst>()));
+		gen.add(1, SignalHdl::make<SignalSine>(300));
+		Simulation sim(ARX({ -0.6, 0.1 }, { 0.3, 0.15 }, 1, 0), PID(0.8, 0.15, 0.1), std::move(gen), 5000);
+		sim.dist.add(0.1, SignalHdl::make<SignalSquare>(777, 0.5));
+		const QFormat sig{ 32, 16 }, coef{ 32, 24 };
+		const FixedReport r = validateFixed(sim, FixedARX(sim.arx, sig, coef), FixedPID(sim.pid, sig, coef));
+
+		// Walidacja poprawności i raport - odchylenie rzędu kilku LSB formatu sygnałów:
+		if (polowka && parzysta && obciecie && nasycenie && zawiniecie && r.steps == 5001 && r.saturations == 0 && r.maxAbsY > 0 && r.maxAbsY < 1e-3)
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			std::cerr << "  " << polowka << parzysta << obciecie << nasycenie << zawiniecie << " " << r << "\n\n";
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - gradient wskaźnika jakości i strojenie PID
+void test_Tuning()
+{
+	//Sygnatura testu:
+	std::cerr << "pidCost + tunePID (ISE, PID 0.3, 0.05, 0) -> test gradientu z liczb dualnych i zbieznosci BFGS, ochrona pliku przy bledzie wczytania: ";
+	try
+	{
+		// Przygotowanie danych - stabilna pętla ze skokiem i sinusem wartości zadanej:
+		Generator gen;
+		gen.add(1, SignalHdl::make<SignalDelay>(2, SignalHdl::make<SignalConst>()));
+		gen.add(1, SignalHdl::make<SignalSine>(300));
+		Simulation sim(ARX({ -0.6, 0.1 }, { 0.3, 0.15 }, 1, 0), PID(0.3, 0.05, 0.0), std::move(gen), 2000);
+
+		// Gradient z jednego przebiegu a różnice centralne (dwa przebiegi na nastawę):
+		const CostGrad g = pidCost(sim, Cost::ISE);
+		std::vector<double> spodz, fakt(g.grad.begin(), g.grad.end());
+		for (double* k : { &sim.pid.P, &sim.pid.I, &sim.pid.D })
+		{
+			constexpr double h = 1e-6;
+			const double k0 = *k;
+			*k = k0 + h;
+			const double jp = pidCost(sim, Cost::ISE).J;
+			*k = k0 - h;
+			const double jm = pidCost(sim, Cost::ISE).J;
+			*k = k0;
+			spodz.push_back((jp - jm) / (2 * h));
+		}
+
+		const TuneResult r = tunePID(sim, Cost::ISE);
+
+		// Plik brakujący lub uszkodzony - wyjątek, plik nie jest nadpisywany:
+		const char* uszkodzony = "test_tuning_zly.json";
+		{
+			std::ofstream ofs(uszkodzony);
+			ofs << "{ \"ARX\": ";
+		}
+		bool wyjatki = true;
+		for (const char* plik : { "test_tuning_brak.json", uszkodzony })
+		{
+			try
+			{
+				tunePID(std::string(plik));
+				wyjatki = false;
+			}
+			catch (const std::runtime_error&)
+			{
+			}
+		}
+		std::ifstream brak("test_tuning_brak.json");
+		std::ifstream zly(uszkodzony);
+		std::string tresc((std::istreambuf_iterator<char>(zly)), std::istreambuf_iterator<char>());
+		zly.close();
+		std::remove(uszkodzony);
+		const bool bezZapisu = !brak && tresc == "{ \"ARX\": ";
+
+		// Walidacja poprawności i raport - gradient zgodny, wskaźnik zmniejszony, punkt stacjonarny, plik chroniony:
+		if (porownanieSekwencji(spodz, fakt) && r.J < 0.05 * r.J0 && r.evaluations < 100 && std::abs(r.grad[0]) + std::abs(r.grad[1]) + std::abs(r.grad[2]) < 1e-4 && wyjatki && bezZapisu)
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodz, fakt);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - autostrojenie metodą przekaźnikową
+void test_Relay()
+{
+	//Sygnatura testu:
+	std::cerr << "Relay (ARX -1.6, 0.64 | 0.1, 0.05 | 3, d = 1) -> test wyznaczenia Ku, Tu i zapisu nastaw ZN w pliku: ";
+	try
+	{
+		// Przygotowanie danych - obiekt o Ku = 1.199, Tu = 15.1 (z charakterystyki częstotliwościowej):
+		Generator gen;
+		gen.add(1, SignalHdl::make<SignalConst>());
+		Simulation sim(ARX({ -1.6, 0.64 }, { 0.1, 0.05 }, 3, 0), PID(), std::move(gen), 5000);
+		sim.save("test_relay.json");
+		const RelayResult r = relayTune(std::string("test_relay.json"), Relay(1, 0.01));
+		Simulation wczytana("test_relay.json");
+		std::remove("test_relay.json");
+
+		// Pętla z wyznaczonymi nastawami - uchyb ustalony:
+		ARX arx({ -1.6, 0.64 }, { 0.1, 0.05 }, 3, 0);
+		PID pid = wczytana.pid;
+		std::vector<double> spodzSygWy(30, 1.0), faktSygWy;
+		double y = 0;
+		for (size_t i = 0; i < 2000; i++)
+		{
+			y = arx.sim(pid.sim(1 - y));
+			if (i >= 1970)
+				faktSygWy.push_back(y);
+		}
+
+		// Walidacja poprawności i raport - metoda funkcji opisującej daje Ku i Tu z dokładnością kilkudziesięciu procent:
+		if (r.converged && r.steps < 300 && std::abs(r.Ku / 1.199 - 1) < 0.35 && std::abs(r.Tu / 15.1 - 1) < 0.3 && wczytana.pid.P == r.pid.P && wczytana.pid.D == r.pid.D && porownanieSekwencji(spodzSygWy, faktSygWy))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodzSygWy, faktSygWy);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - analityczne wskaźniki odpowiedzi skokowej
+void test_StepMetrics()
+{
+	//Sygnatura testu:
+	std::cerr << "StepMetrics (5 petli PID + ARX, w tym biegun podwojny i petla niestabilna) -> test zgodnosci z odpowiedzia petli: ";
+	try
+	{
+		// Przygotowanie danych - wskaźniki z odpowiedzi pętli (krok jak w Simulation::run, bez szumu):
+		auto zPetli = [](ARX arx, PID pid)
+		{
+			std::vector<double> y;
+			double v = 0;
+			for (size_t i = 0; i < 3000; i++)
+				y.push_back(v = arx.sim(pid.sim(1 - v)));
+			return responseMetrics(y, ClosedLoop(arx, pid).gain);
+		};
+
+		bool zgodne = true;
+		auto porownaj = [&](const ARX& arx, const PID& pid, bool modalne)
+		{
+			const StepMetrics a = stepMetrics(arx, pid), s = zPetli(arx, pid);
+			zgodne = zgodne && a.stable && a.modal == modalne && std::abs(a.overshoot - s.overshoot) < 1e-9
+				&& std::abs(a.riseTime - s.riseTime) < 1e-9 && a.settlingTime == s.settlingTime
+				&& std::abs(a.steadyStateError - s.steadyStateError) < 1e-9;
+		};
+		porownaj(ARX({ -0.6 }, { 0.4 }, 1, 0), PID(0.5, 0.2, 0.1), true);
+		porownaj(ARX({ -1.6, 0.64 }, { 0.1, 0.05 }, 3, 0), PID(0.5, 0.05, 0.5), true);
+		porownaj(ARX({ -0.6 }, { 0.4 }, 1, 0), PID(0.5), true);
+		// Biegun podwójny z = 0.25 - rozkład modalny niejednoznaczny, krótka symulacja:
+		porownaj(ARX({}, { 0.5 }, 0, 0), PID(-0.125, 1.125), false);
+
+		// Regulator P - uchyb ustalony 1 - 0.2 / 0.6; pętla niestabilna:
+		const StepMetrics p = stepMetrics(ARX({ -0.6 }, { 0.4 }, 1, 0), PID(0.5));
+		const StepMetrics n = stepMetrics(ARX({ -0.6 }, { 0.4 }, 1, 0), PID(10, 5));
+
+		// Walidacja poprawności i raport:
+		if (zgodne && std::abs(p.steadyStateError - 2.0 / 3) < 1e-12 && !n.stable && std::isinf(n.settlingTime))
+			std::cerr << "OK!\n";
+		else
+			std::cerr << "FAIL!\n";
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - stacjonarne wariancje z równania Lapunowa
+void test_Variance()
+{
+	//Sygnatura testu:
+	std::cerr << "Simulation::variance (ARX -0.6 | 0.4 | 1 | 0.5, PID 0.5, 0.2, 0.1) -> test zgodnosci z Monte Carlo: ";
+	try
+	{
+		// Przygotowanie danych - skalarne równanie Lapunowa: P = 0.25 P + 1 => P = 4 / 3:
+		Matrix F(1, 1), Q(1, 1);
+		F(0, 0) = 0.5;
+		Q(0, 0) = 1;
+		const double p = dlyap(F, Q)(0, 0);
+
+		Simulation sim(ARX({ -0.6 }, { 0.4 }, 1, 0.5), PID(0.5, 0.2, 0.1), Generator(), 0);
+		const VarianceReport r = sim.variance();
+		sim.pid = PID(0.5);
+		const VarianceReport rP = sim.variance();
+		sim.pid = PID(10, 5);
+		const VarianceReport rN = sim.variance();
+
+		// Monte Carlo - pętla jak w Simulation::run przy zerowej wartości zadanej:
+		ARX arx({ -0.6 }, { 0.4 }, 1, 0.5);
+		PID pid(0.5, 0.2, 0.1);
+		constexpr size_t N = 400000, WARMUP = 1000;
+		double y = 0, sy = 0, syy = 0, su = 0, suu = 0, sS = 0, sSS = 0;
+		for (size_t i = 0; i < N + WARMUP; i++)
+		{
+			const double u = pid.sim(-y);
+			y = arx.sim(u);
+			if (i < WARMUP)
+				continue;
+			sy += y;
+			syy += y * y;
+			su += u;
+			suu += u * u;
+			sS += pid.sumerr;
+			sSS += pid.sumerr * pid.sumerr;
+		}
+		auto var = [](double s, double ss) { return ss / N - (s / N) * (s / N); };
+
+		// Walidacja poprawności i raport - błąd względny Monte Carlo rzędu 1%:
+		const bool mc = std::abs(var(sy, syy) / r.varY - 1) < 0.05 && std::abs(var(su, suu) / r.varU - 1) < 0.05
+			&& std::abs(var(sS, sSS) / r.varSum - 1) < 0.1;
+		if (std::abs(p - 4.0 / 3) < 1e-12 && r.stable && mc && std::abs(r.varErr / r.varY - 1) < 1e-9 && rP.stable && std::isinf(rP.varSum) && !rN.stable)
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			std::cerr << r << "\nMonte Carlo: var y = " << var(sy, syy) << ", var u = " << var(su, suu) << ", var sumerr = " << var(sS, sSS) << "\n";
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - wspólne przebiegi sygnałów dla przeszukiwania nastaw
+void test_TraceCache()
+{
+	//Sygnatura testu:
+	std::cerr << "TraceCache + SimulationBank (40 nastaw, ARX -0.6 | 0.4 | 1 | 0.3, zaklocenie i szum pomiarowy) -> test zgodnosci wyjsc, IAE i ISE z symulacja szeregowa na wspolnych przebiegach: ";
+	try
+	{
+		// Przygotowanie danych - przebiegi wspólne dla wszystkich kandydatów, trzy kafle sygnałów:
+		constexpr size_t M = 40, LICZ_ITER = 2500;
+		Simulation wzor;
+		wzor.gen.add(1, SignalHdl::make<SignalConst>());
+		wzor.gen.add(0.5, SignalHdl::make<SignalSine>(300));
+		wzor.dist.add(0.1, SignalHdl::make<SignalSquare>(211, 0.5));
+		wzor.noise.add(0.05, SignalHdl::make<SignalSine>(7));
+		wzor.len = LICZ_ITER - 1;
+		const TraceCache cache(wzor);
+
+		SimulationBank bank;
+		auto nastawy = [](size_t m) { return PID(0.2 + 0.01 * m, 0.05 + 0.002 * m, 0.01 * (m % 4)); };
+		for (size_t m = 0; m < M; m++)
+		{
+			Simulation sim;
+			sim.arx = ARX({ -0.6 }, { 0.4 }, 1, 0.3);
+			sim.pid = nastawy(m);
+			bank.add(std::move(sim));
+		}
+		std::vector<double> spodzSygWy(M * LICZ_ITER), faktSygWy(M * LICZ_ITER);
+		bank.run(cache, faktSygWy, 2);
+
+		// Odniesienie - krok jak w Simulation::run na tych samych próbkach, wskaźniki ze wszystkich chwil przebiegów
+		// (kandydaci mają len = 0):
+		const auto r = cache.setpoint(), d = cache.disturbance(), v = cache.measurement(), e = cache.arxNoise();
+		bool wskazniki = bank.iae.size() == M && bank.ise.size() == M;
+		for (size_t m = 0; m < M; m++)
+		{
+			ARX arx({ -0.6 }, { 0.4 }, 1, 0.3);
+			PID pid = nastawy(m);
+			double arxout = 0, iae = 0, ise = 0;
+			for (size_t i = 0; i < LICZ_ITER; i++)
+			{
+				const double err = r[i] - (arxout + v[i]);
+				iae += std::abs(err);
+				ise += err * err;
+				spodzSygWy[m * LICZ_ITER + i] = arxout = arx.step(pid.sim(err) + d[i], e[i]);
+			}
+			wskazniki = wskazniki && std::abs(bank.iae[m] - iae) < 1e-9 * iae && std::abs(bank.ise[m] - ise) < 1e-9 * ise;
+		}
+
+		// Walidacja poprawności i raport:
+		const bool wyrownane = reinterpret_cast<uintptr_t>(r.data()) % CACHE_LINE == 0 && reinterpret_cast<uintptr_t>(e.data()) % CACHE_LINE == 0;
+		if (cache.size() == LICZ_ITER && wyrownane && wskazniki && porownanieSekwencji(spodzSygWy, faktSygWy))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodzSygWy, faktSygWy);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - Monte Carlo z redukcją wariancji
+void test_MonteCarlo()
+{
+	//Sygnatura testu:
+	std::cerr << "monteCarlo (ARX -0.6 | 0.4 | 1 | 0.3, PID 0.5, 0.2, 0.1, 512 realizacji) -> test zgodnosci estymat i zysku trybow redukcji wariancji: ";
+	try
+	{
+		// Przygotowanie danych - wartość zadana ze składową sinusoidalną (trwały błąd nadążania):
+		Simulation sim;
+		sim.arx = ARX({ -0.6 }, { 0.4 }, 1, 0.3);
+		sim.pid = PID(0.5, 0.2, 0.1);
+		sim.gen.add(1, SignalHdl::make<SignalConst>());
+		sim.gen.add(2, SignalHdl::make<SignalSine>(50));
+		sim.len = 299;
+
+		const MCResult plain = monteCarlo(sim, Cost::IAE, 512);
+		const MCResult anti = monteCarlo(sim, Cost::IAE, 512, MCMode::Antithetic);
+		const MCResult sobol = monteCarlo(sim, Cost::IAE, 512, MCMode::Sobol);
+		const MCResult cv = monteCarlo(sim, Cost::IAE, 512, MCMode::ControlVariate);
+		// Dla ISE pętli liniowej zmienne kontrolne wyjaśniają całą wariancję:
+		const MCResult plainISE = monteCarlo(sim, Cost::ISE, 512);
+		const MCResult cvISE = monteCarlo(sim, Cost::ISE, 64, MCMode::ControlVariate);
+
+		// Walidacja poprawności i raport:
+		auto zgodne = [](const MCResult& a, const MCResult& b) { return std::abs(a.mean - b.mean) < 4 * std::hypot(a.stdError, b.stdError); };
+		const bool estymaty = zgodne(plain, anti) && zgodne(plain, sobol) && zgodne(plain, cv) && zgodne(plainISE, cvISE);
+		const bool zyski = anti.gain > 1.5 && sobol.gain > 2 && cv.gain > 2 && cvISE.gain > 1e6
+			&& 3 * sobol.required(0.5) < plain.required(0.5) && sobol.realizations == 512 && anti.realizations == 512;
+		if (estymaty && zyski && std::abs(normalQuantile(0.975) - 1.959963984540054) < 1e-12)
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			for (const MCResult* r : { &plain, &anti, &sobol, &cv, &plainISE, &cvISE })
+				std::cerr << *r << "\n";
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - sekwencyjne Monte Carlo z regułą zatrzymania
+void test_MonteCarloUntil()
+{
+	//Sygnatura testu:
+	std::cerr << "monteCarloUntil (IAE +-0.5% i max |y| +-0.02 (99%), 1 i 2 watki) -> test reguly zatrzymania, poziomu ufnosci wyniku, odrzucenia reguly bez celu i laczenia akumulatorow Welforda: ";
+	try
+	{
+		// Przygotowanie danych - łączenie akumulatorów a wyniki dla całej próbki:
+		Welford a, b, calosc;
+		for (int i = 0; i < 100; i++)
+		{
+			const double x = std::sin(0.7 * i) * 10 + i % 7;
+			(i < 37 ? a : b).push(x);
+			calosc.push(x);
+		}
+		a.merge(b);
+		const bool welford = a.n == 100 && std::abs(a.mean - calosc.mean) < 1e-12 && std::abs(a.variance() / calosc.variance() - 1) < 1e-12;
+
+		Simulation sim;
+		sim.arx = ARX({ -0.6 }, { 0.4 }, 1, 0.3);
+		sim.pid = PID(0.5, 0.2, 0.1);
+		sim.gen.add(1, SignalHdl::make<SignalConst>());
+		sim.gen.add(2, SignalHdl::make<SignalSine>(50));
+		sim.len = 299;
+
+		StopRule regula;
+		regula.relHalfWidth = 0.005;
+		const MCResult r1 = monteCarloUntil(sim, costMetric(Cost::IAE), regula);
+		const MCResult r2 = monteCarloUntil(sim, costMetric(Cost::IAE), regula, 2, 7);
+
+		// Dowolny wskaźnik przebiegu - największe wyjście z dokładnością bezwzględną:
+		StopRule regulaAbs;
+		regulaAbs.relHalfWidth = 0;
+		regulaAbs.absHalfWidth = 0.02;
+		regulaAbs.confidence = 0.99;
+		const MCResult rMax = monteCarloUntil(sim, [](const Trajectory& t) { return *std::max_element(t.output.begin(), t.output.end()); }, regulaAbs);
+
+		// Reguła nieosiągalna w limicie realizacji:
+		StopRule limit;
+		limit.relHalfWidth = 1e-9;
+		limit.maxRealizations = 50;
+		const MCResult rLim = monteCarloUntil(sim, costMetric(Cost::IAE), limit);
+
+		// Reguła bez docelowej szerokości przedziału (nigdy niespełniona) musi być odrzucona:
+		StopRule bezCelu;
+		bezCelu.relHalfWidth = 0;
+		bool odrzucona = false;
+		try
+		{
+			monteCarloUntil(sim, costMetric(Cost::IAE), bezCelu);
+		}
+		catch (const std::invalid_argument&)
+		{
+			odrzucona = true;
+		}
+
+		// Walidacja poprawności i raport (przy 2 wątkach wynik obejmuje też realizacje dokończone po spełnieniu reguły,
+		// więc połowa szerokości może nieznacznie przekroczyć cel):
+		const bool zatrzymanie = r1.converged && r1.halfWidth <= 0.005 * r1.mean && r1.realizations >= regula.minRealizations && r1.realizations < 1000
+			&& r2.converged && r2.halfWidth <= 0.0055 * r2.mean && std::abs(r1.mean - r2.mean) < 4 * std::hypot(r1.stdError, r2.stdError)
+			&& rMax.converged && rMax.halfWidth <= 0.02 && !rLim.converged && rLim.realizations == 50;
+		std::ostringstream raport;
+		raport << rMax;
+		const bool poziom = r1.confidence == 0.95 && rMax.confidence == 0.99 && raport.str().find("(99%)") != std::string::npos
+			&& std::abs(double(r1.required(r1.halfWidth)) - double(r1.realizations)) <= 1
+			&& std::abs(double(rMax.required(rMax.halfWidth)) - double(rMax.realizations)) <= 1;
+		if (welford && zatrzymanie && odrzucona && poziom)
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			for (const MCResult* r : { &r1, &r2, &rMax, &rLim })
+				std::cerr << *r << "\n";
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - wielopoziomowy podział dla rzadkiego przekroczenia ograniczenia wyjścia
+void test_Splitting()
+{
+	//Sygnatura testu:
+	std::cerr << "exceedanceProbability (bound 3 i 5 sigma) -> test klonu fork() z krokiem z TraceCache, zgodnosci ze zwyklym Monte Carlo i liczby krokow: ";
+	try
+	{
+		// Przygotowanie danych - wolny obiekt (gładkie wyjście), wartość zadana 0:
+		Simulation sim;
+		sim.arx = ARX({ -1.6, 0.64 }, { 0.04 }, 1, 0.05);
+		sim.pid = PID(0.5, 0.05, 0);
+		sim.len = 199;
+		const double sigma = std::sqrt(sim.variance().varY);
+		const TraceCache tr(sim, false);
+
+		// Klon kontynuuje dokładnie ten sam przebieg, krok z przebiegów jak krok z generatorów:
+		Simulation a = sim.fork(), g = sim.fork();
+		a.seedNoise(42);
+		g.seedNoise(42);
+		bool migawka = true;
+		for (int i = 0; i < 50; i++)
+			migawka = migawka && a.step(tr) == g.step();
+		Simulation b = a.fork();
+		for (int i = 0; i < 50; i++)
+			migawka = migawka && a.step(tr) == b.step(tr);
+
+		// Umiarkowanie rzadkie zdarzenie - porównanie ze zwykłym Monte Carlo:
+		const SplittingResult r3 = exceedanceProbability(sim, 3 * sigma);
+		const size_t R = 20000;
+		size_t hits = 0;
+		for (size_t i = 0; i < R; i++)
+		{
+			Simulation x = sim.fork();
+			x.seedNoise(uint32_t(1000 + i));
+			while (x.iter < tr.size())
+				if (x.step(tr) >= 3 * sigma)
+				{
+					hits++;
+					break;
+				}
+		}
+		const double p = double(hits) / R, se = std::hypot(r3.relError * r3.probability, std::sqrt(p * (1 - p) / R));
+
+		// Rzadkie zdarzenie - ograniczenia z rozkładu normalnego wyjścia (Q(5) <= P <= (len + 1) Q(5)):
+		const SplittingResult r5 = exceedanceProbability(sim, 5 * sigma);
+		const double q5 = 0.5 * std::erfc(5 / std::sqrt(2.0));
+
+		// Walidacja poprawności i raport:
+		const bool zgodnosc = r3.reached && std::abs(r3.probability - p) < 4 * se;
+		const bool rzadkie = r5.reached && r5.probability >= q5 && r5.probability <= tr.size() * q5 && r5.levels.back() == 5 * sigma
+			&& double(r5.steps) * 10 < r5.plainSteps;
+		if (migawka && zgodnosc && rzadkie)
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			std::cerr << r3 << " (Monte Carlo: " << p << ")\n" << r5 << " (Q(5) = " << q5 << ")\n";
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - zapis i odtworzenie pełnego stanu symulacji oraz rozgałęzienie
+void test_Checkpoint()
+{
+	//Sygnatura testu:
+	std::cerr << "Simulation::checkpoint/restore/fork (ARX -0.6 | 0.4 oraz splot B = 2500 | 1 | 0.3, zaklocenie i szum pomiarowy) -> test kontynuacji przebiegu po 150 z 400 iteracji: ";
+	try
+	{
+		// Przygotowanie danych - symulacja przerwana po 150 iteracjach (poza granicą bloku splotu):
+		json splot = ARX({ -0.6 }, {}, 1, 0.3);
+		std::vector<double> b(2500);
+		for (size_t i = 0; i < b.size(); i++)
+			b[i] = 0.002 * std::pow(0.998, double(i));
+		splot["B"] = b;
+		auto make = [&](bool conv)
+		{
+			Simulation s;
+			s.arx = conv ? splot.get<ARX>() : ARX({ -0.6 }, { 0.4 }, 1, 0.3);
+			s.pid = PID(0.5, 0.2, 0.1);
+			s.gen.add(1, SignalHdl::make<SignalSine>(50));
+			s.dist.add(0.2, SignalHdl::make<SignalSquare>(30));
+			s.noise.add(0.05, SignalHdl::make<SignalSine>(7));
+			s.len = 399;
+			return s;
+		};
+		bool zgodnosc = true, rozne = true, koniec = true;
+		for (bool conv : { false, true })
+		{
+			Simulation ref = make(conv), sim = make(conv);
+			std::vector<double> yRef;
+			while (ref.iter <= ref.len)
+				yRef.push_back(ref.step());
+
+			const size_t prefix = sim.advance(150);
+			const std::string file = "test_checkpoint.bin";
+			sim.checkpoint(file);
+			Simulation branch = sim.fork();
+			Simulation other = sim.fork();
+			other.seedNoise(7);
+
+			// Kontynuacja oryginału, klonu i stanu odtworzonego z pliku (identyczna bitowo):
+			Simulation restored;
+			restored.restore(file);
+			std::remove(file.c_str());
+			zgodnosc = zgodnosc && prefix == 150 && restored.iter == 150 && branch.iter == 150;
+			bool roznaGalaz = false;
+			for (size_t i = 150; i < yRef.size(); i++)
+			{
+				const double y = sim.step();
+				zgodnosc = zgodnosc && y == yRef[i] && branch.step() == y && restored.step() == y;
+				roznaGalaz = roznaGalaz || other.step() != y;
+			}
+			rozne = rozne && roznaGalaz;
+			koniec = koniec && sim.advance() == 0 && restored.advance() == 0 && restored.iter == restored.len + 1;
+		}
+
+		// Niepoprawny zapis:
+		bool wyjatek = false;
+		std::istringstream zly("ARXSIMC0");
+		try
+		{
+			Simulation().restore(zly);
+		}
+		catch (const std::runtime_error&)
+		{
+			wyjatek = true;
+		}
+
+		// Walidacja poprawności i raport:
+		if (zgodnosc && rozne && koniec && wyjatek)
+			std::cerr << "OK!\n";
+		else
+			std::cerr << "FAIL! (zgodnosc " << zgodnosc << ", rozne " << rozne << ", koniec " << koniec << ", wyjatek " << wyjatek << ")\n";
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
+// Test - jądra iloczynu skalarnego
+void test_Kernels()
+{
+	//Sygnatura testu:
+	std::cerr << "dot (n = 0..67, wszystkie zestawy instrukcji) -> test dokladnosci i powtarzalnosci bitowej trybu deterministycznego: ";
+	try
+	{
+		// Przygotowanie danych - długości obejmujące końcówki krótsze niż KERNEL_PAD:
+		std::vector<double> a(67), b(67);
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			a[i] = std::sin(0.37 * i) * (1 + i % 5);
+			b[i] = std::cos(1.13 * i) / (1 + i % 3);
+		}
+
+		const KernelIsa najlepszy = detectKernelIsa();
+		const KernelIsa poprzedni = kernelIsa();
+		const SumOrder poprzedniaKol = sumOrder();
+		std::vector<double> spodz, fakt;
+		bool powtarzalny = true;
+		for (size_t n = 0; n <= a.size(); n++)
+		{
+			spodz.push_back(std::inner_product(a.begin(), a.begin() + n, b.begin(), 0.0));
+
+			setSumOrder(SumOrder::Deterministic);
+			setKernelIsa(KernelIsa::Scalar);
+			const double wzorzec = dot(a.data(), b.data(), n);
+			for (int isa = 0; isa <= int(najlepszy); isa++)
+			{
+				setKernelIsa(KernelIsa(isa));
+				powtarzalny = powtarzalny && dot(a.data(), b.data(), n) == wzorzec;
+			}
+
+			setSumOrder(SumOrder::Fast);
+			setKernelIsa(najlepszy);
+			fakt.push_back(dot(a.data(), b.data(), n));
+		}
+		setSumOrder(poprzedniaKol);
+		setKernelIsa(poprzedni);
+
+		// Walidacja poprawności i raport:
+		if (powtarzalny && porownanieSekwencji(spodz, fakt))
+			std::cerr << "OK!\n";
+		else
+		{
+			std::cerr << "FAIL!\n";
+			raportBleduSekwencji(spodz, fakt);
+		}
+	}
+	catch (...)
+	{
+		std::cerr << "INTERUPTED! (niespodziwany wyjatek)\n";
+	}
+}
+
 int main()
 {
 	// Testy dla modelu ARX
@@ -202,6 +1781,39 @@ int main()
 	test_ARX_skokJednostkowy_1(); // Wywołanie testu dla ARX z skokiem jednostkowym nr 1
 	test_ARX_skokJednostkowy_2(); // Wywołanie testu dla ARX z skokiem jednostkowym nr 2
 	test_ARX_skokJednostkowy_3(); // Wywołanie testu dla ARX z skokiem jednostkowym nr 3
+	test_ARX_rzadki(); // Wywołanie testu reprezentacji rzadkiej ARX
+	test_ARX_splot(); // Wywołanie testu splotu blokowego ARX
+	test_ARX_rownolegle(); // Wywołanie testu równoległej symulacji ARX
+	test_ARXBatch(); // Wywołanie testu symulacji wielu przebiegów
+	test_Kernels(); // Wywołanie testu jąder iloczynu skalarnego
+
+	// Testy symulacji pętli
+	test_Parareal(); // Wywołanie testu symulacji równoległej w czasie
+	test_SimulationBank(); // Wywołanie testu banku pętli regulacji
+	test_TileScheduler(); // Wywołanie testu harmonogramu kafli czasowych
+	test_Scalar(); // Wywołanie testu symulacji w typie float
+	test_FixedPoint(); // Wywołanie testu pętli stałoprzecinkowej
+	test_Tuning(); // Wywołanie testu strojenia regulatora PID
+	test_Relay(); // Wywołanie testu autostrojenia metodą przekaźnikową
+	test_StepMetrics(); // Wywołanie testu analitycznych wskaźników odpowiedzi skokowej
+	test_Variance(); // Wywołanie testu stacjonarnych wariancji z równania Lapunowa
+	test_TraceCache(); // Wywołanie testu wspólnych przebiegów sygnałów
+	test_MonteCarlo(); // Wywołanie testu Monte Carlo z redukcją wariancji
+	test_MonteCarloUntil(); // Wywołanie testu sekwencyjnego Monte Carlo
+	test_Splitting(); // Wywołanie testu wielopoziomowego podziału
+	test_Checkpoint(); // Wywołanie testu zapisu i odtworzenia stanu symulacji
+
+	// Testy identyfikacji
+	test_Identyfikacja_ARX(); // Wywołanie testu identyfikacji modelu ARX
+	test_Identyfikacja_ARMAX(); // Wywołanie testu identyfikacji modelu ARMAX
+	test_Identyfikacja_BJ(); // Wywołanie testu identyfikacji modelu BJ
+	test_Identyfikacja_OE(); // Wywołanie testu identyfikacji modelu OE
+	test_Identyfikacja_PEM(); // Wywołanie testu identyfikacji metodą błędu predykcji
+
+	// Testy dla sygnałów
+	test_Multisine(); // Wywołanie testu sygnału wielosinusoidalnego
+	test_Chirp(); // Wywołanie testu sygnałów świergotowych
+	test_SignalRecorded(); // Wywołanie testu sygnału odtwarzanego z pliku
 
 	system("PAUSE"); // Oczekiwanie na wciśnięcie dowolnego klawisza przez użytkownika
 }
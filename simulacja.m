@@ -11,6 +11,7 @@ B = [0.5];
 nk = 1; % opóźnienie
 
 % Projektowanie regulatora PID z użyciem metody Zieglera-Nicholsa
+% (Ku i Tu można wyznaczyć jednym eksperymentem przekaźnikowym - relayTune w Relay.h)
 % Ku = 1.5; % współczynnik krytyczny
 % Tu = 6; % okres oscylacji przy krytycznym wzmocnieniu
 % Kp = 0.6*Ku;